@@ -10,16 +10,26 @@ This script calls the py_bitstream tool to extract partial bitstreams (pbs). The
 only allows to extract pbs from one clock region. This script allows to extract a pbs spanning 
 multiple clock regions. 
 
-The script should be called with 3 arguments:
+The script should be called with 3 or more arguments:
     param argv[1]: bitstream source file 
     param argv[2]: defines the area where the pbs will be extracted. The format of the variable is 
                    XxYy:XxYy i.e. X3Y5:X8Y12. If the reconfigurable partition is composed with
                    several pblocks, this argument should be defined as a list.  
     param argv[3]: partial bitstream destination file name.
+    param argv[4]: (optional) if it is "contiguous" each frame of the pbs contains all the rows of
+                   the pblock even if it crosses several clock regions. A pbs extracted from one
+                   clock region row always has this layout. The run-time engine needs it to know
+                   how the pbs is stored (PBS_contiguous_frames field of element_info_t).
+    param argv[4:]: (optional) if "BRAM" is given the initial contents of the BRAMs of the pblocks
+                   are appended to the pbs as a separate section. For each pblock the section
+                   contains the 128 BRAM content frames of each BRAM column, with contiguous frames
+                   whatever the layout of the configuration frames. The run-time engine writes
+                   them after the reconfiguration (PBS_BRAM_contents field of element_info_t).
     
     return: returns an extracted pbs located in the destination file defined in argv[3] 
     
     Example: python generate_partial_bitstream ./static.bit X3Y5:X8Y12 ./module.pbs
+             python generate_partial_bitstream ./static.bit X3Y5:X8Y12 ./module.pbs contiguous BRAM
     
 NOTE: the pblocks definition should be rectangular. That is, they should be aligned with the height
 of RAM and DSP tiles.  
@@ -33,6 +43,8 @@ NOTE2: right now it only works for series7 devices
 bitstream_obj = bitstream.Bitstream(sys.argv[1]) 
 pblock_definition_list = sys.argv[2] 
 destination_file = sys.argv[3]
+contiguous_frames = "contiguous" in sys.argv[4:]
+BRAM_contents = "BRAM" in sys.argv[4:]
 
 
 #TODO in the future when ultrascale devices are supported these parameters should be family device 
@@ -42,6 +54,45 @@ words_per_row_in_clock_region = 2
 frame_words_num = 101
 clock_word_num = 1 
 words_per_half_clock_region_without_clock = (frame_words_num - clock_word_num) / words_per_row_in_clock_region
+BRAM_content_frames = 128
+
+
+def extract_contiguous_frames(read_frame, x0, y0, xf, yf, column_frames):
+    '''
+    Returns the frames of the pblock with contiguous frames: each frame contains the used words of
+    every clock region row (without the clock words). read_frame(coords) is the function that
+    returns the words of a frame (configuration frames or BRAM content frames) and
+    column_frames(i, j) the number of frames of the column j.
+    '''
+    frames = bytearray()
+    first_clock_region_row = y0 / rows_per_clock_region
+    last_clock_region_row = yf / rows_per_clock_region
+    for j in range(x0, xf + 1):
+        for k in range(0, column_frames(first_clock_region_row, j)):
+            for i in range(first_clock_region_row, last_clock_region_row + 1):
+                # Words used in this clock region row counted without the clock word
+                first_word = 0
+                last_word = frame_words_num - clock_word_num
+                if (i == first_clock_region_row):
+                    first_word = (y0 - (first_clock_region_row * rows_per_clock_region)) * words_per_row_in_clock_region
+                if (i == last_clock_region_row):
+                    last_word -= ((((last_clock_region_row + 1) * rows_per_clock_region) - 1) - yf) * words_per_row_in_clock_region
+                if (first_word < words_per_half_clock_region_without_clock):
+                    frames.extend(read_frame((i, j, slice(first_word, min(last_word, words_per_half_clock_region_without_clock)), k)))
+                if (last_word > words_per_half_clock_region_without_clock):
+                    frames.extend(read_frame((i, j, slice(max(first_word, words_per_half_clock_region_without_clock) + clock_word_num, last_word + clock_word_num), k)))
+    return frames
+
+
+def configuration_column_frames(i, j):
+    return bitstream_obj.fpga.table[i][j][0]
+
+
+def BRAM_column_frames(i, j):
+    if bitstream_obj.fpga.table[i][j][1] == 'BRAM':
+        return BRAM_content_frames
+    return 0
+
 
 extracted_bitstream = bytearray()
 extracted_BRAM_contents = bytearray()
@@ -56,6 +107,14 @@ for pblock_definition in pblock_definition_list.split():
     first_clock_region_row = y0 / rows_per_clock_region
     last_clock_region_row = yf / rows_per_clock_region 
 
+    if BRAM_contents:
+        extracted_BRAM_contents.extend(extract_contiguous_frames(bitstream_obj.obtain_BRAM_contents, x0, y0, xf, yf, BRAM_column_frames))
+
+    if contiguous_frames and first_clock_region_row != last_clock_region_row:
+        # Each frame contains the used words of every clock region row (without the clock words)
+        extracted_bitstream.extend(extract_contiguous_frames(bitstream_obj.__getitem__, x0, y0, xf, yf, configuration_column_frames))
+        continue
+
     for i in range(first_clock_region_row, last_clock_region_row + 1):
         first_words_not_used = 0
         last_words_not_used = 0
@@ -64,7 +123,7 @@ for pblock_definition in pblock_definition_list.split():
             first_words_not_used = intial_rows_not_used * words_per_row_in_clock_region
 
         if (i == last_clock_region_row):
-            last_rows_not_used = (((first_clock_region_row + 1) * rows_per_clock_region) - 1) - yf
+            last_rows_not_used = (((last_clock_region_row + 1) * rows_per_clock_region) - 1) - yf
             last_words_not_used = last_rows_not_used * words_per_row_in_clock_region
             
         if (first_words_not_used < words_per_half_clock_region_without_clock and last_words_not_used < words_per_half_clock_region_without_clock):
@@ -75,36 +134,25 @@ for pblock_definition in pblock_definition_list.split():
                     bitstream_block = bitstream_obj[i, j, first_words_not_used:words_per_half_clock_region_without_clock, k]
                     # print(i, j, k, k+1, first_words_not_used, words_per_half_clock_region_without_clock)
                     extracted_bitstream.extend(bitstream_block)
-                    # extracted_BRAM_contents.extend(bitstream_obj.obtain_BRAM_contents((i, j, slice(first_words_not_used, words_per_half_clock_region_without_clock), k)))
                     # print(i, j, k, k+1, (words_per_half_clock_region_without_clock + 1), (frame_words_num-last_words_not_used))
                     bitstream_block = bitstream_obj[i, j, (words_per_half_clock_region_without_clock + 1):(frame_words_num-last_words_not_used), k]
                     extracted_bitstream.extend(bitstream_block)     
-                    # extracted_BRAM_contents.extend(bitstream_obj.obtain_BRAM_contents((i, j, slice(words_per_half_clock_region_without_clock + 1, frame_words_num-last_words_not_used), k)))
-                
-                if bitstream_obj.fpga.table[i][j][1] == 'BRAM':
-                    extracted_BRAM_contents.extend(bitstream_obj.obtain_BRAM_contents((i, j, slice(first_words_not_used, (frame_words_num-last_words_not_used)))))
         elif (first_words_not_used >= words_per_half_clock_region_without_clock and last_words_not_used < words_per_half_clock_region_without_clock):
             # Region on the top half of the clock region
             first_word = first_words_not_used + clock_word_num
             bitstream_block = bitstream_obj[i, x0:(xf + 1), first_word:(frame_words_num-last_words_not_used)]
             extracted_bitstream.extend(bitstream_block)
-            extracted_BRAM_contents.extend(bitstream_obj.obtain_BRAM_contents((i, slice(x0, (xf + 1)), slice(first_word, (frame_words_num-last_words_not_used)))))
         elif (first_words_not_used < words_per_half_clock_region_without_clock and last_words_not_used >= words_per_half_clock_region_without_clock):
             # Region on the bottom half of tyhe clock region
             last_word = frame_words_num - last_words_not_used - clock_word_num
             bitstream_block = bitstream_obj[i, x0:(xf + 1), first_words_not_used:last_word]
             extracted_bitstream.extend(bitstream_block)
-            extracted_BRAM_contents.extend(bitstream_obj.obtain_BRAM_contents((i, slice(x0, (xf + 1)), slice(first_words_not_used, last_word))))
         else: 
             print "error"
 
 
-# for i in xrange(0, len(extracted_BRAM_contents)):
-#     if extracted_BRAM_contents[i] != 0:
-#         extracted_bitstream.extend(extracted_BRAM_contents)
-#         break 
-        
-# extracted_bitstream.extend(extracted_BRAM_contents)
+# The BRAM contents of all the pblocks follow the configuration frames
+extracted_bitstream.extend(extracted_BRAM_contents)
 
 
 # with open(sys.argv[1] + ".prueba", 'wb') as file:
@@ -1,9 +1,11 @@
 #include "IMPRESS_reconfiguration.h"
 
+reconfiguration_engine_t engine;
 virtual_architecture_t va;
 
 int main() {
-	init_virtual_architecture();
+	init_reconfiguration_engine(&engine, INITIAL_ADDR_RAM);
+	init_virtual_architecture(&va, &engine, MAX_WIDTH_VIRTUAL_ARCHITECTURE, MAX_HEIGHT_VIRTUAL_ARCHITECTURE);
 	change_partition_position(&va, 0, 0, 40, 9);
 
 	change_partition_element(&va, 0, 0, ADD_RM);
@@ -2,12 +2,14 @@
 #include <stdint.h>
 
 
+reconfiguration_engine_t engine;
 virtual_architecture_t va;
 
 int main() {
 	uint32_t constant_value;
 
-	init_virtual_architecture();
+	init_reconfiguration_engine(&engine, INITIAL_ADDR_RAM);
+	init_virtual_architecture(&va, &engine, MAX_WIDTH_VIRTUAL_ARCHITECTURE, MAX_HEIGHT_VIRTUAL_ARCHITECTURE);
 	change_partition_position(&va, 0, 1, 40, 25);
 	change_partition_position(&va, 0, 0, 40, 9);
 
@@ -28,7 +30,7 @@ int main() {
 	constant_value = 0x83;
 	change_partition_constant(&va, 0, 0, 1, &constant_value);
 	change_partition_FU(&va, 0, 0, 0, and);
-	reconfigure_fine_grain();
+	reconfigure_fine_grain(&engine);
 
 
 	while(1);
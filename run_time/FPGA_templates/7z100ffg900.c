@@ -1960,3 +1960,336 @@ const u32 fpga_bram[MAX_ROWS][MAX_COLUMNS] = {
    content(BRAM_NOCONTENT, 0)
   }
 };
+
+// Prefix hashes of the column types of each row (see COLUMN_HASH_BASE)
+const u32 fpga_column_hash[MAX_ROWS][MAX_COLUMNS + 1] = {
+  {
+    0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+    0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+    0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+    0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AB,
+    0x986FE5BA, 0x082C33E4, 0x2E637FF6, 0xB4617E92, 0x12174B1C, 0x9D5DDB0E, 0xBE90A909, 0x8AE86E4F,
+    0x1397F16D, 0xD4F5E4C3, 0xC78A1031, 0xD6F45718, 0x1150967A, 0x80A5BFA4, 0x97F4B2B8, 0xF65DD499,
+    0x9B8FBA1E, 0x7BC5E657, 0xE39A4A94, 0xE54CC765, 0x2418D19A, 0x37964B4A, 0x08B8E1B4, 0x42B89F05,
+    0xA4AEFBBB, 0xCD4A6209, 0xABC02B50, 0xD2C64292, 0x76A79F1C, 0x2639FF10, 0x8661DD52, 0x6C24FCDC,
+    0xA1588BCF, 0x51CC34ED, 0xD283A643, 0x6D0707B1, 0xC2041C96, 0x0A9821B0, 0x87FCDE77, 0xA78C2734,
+    0x3741AA86, 0xFC7DA55F, 0x7E28E6BD, 0x3BE95952, 0xA8B9E8DC, 0x62DEA7CD, 0x4A2E40A3, 0xB8AF5791,
+    0xB157A7F8, 0xA1AB46DA, 0x5DC13D84, 0x8CEDE418, 0x5E61F77A, 0xA428C4A4, 0xB9E46BB7, 0xDE039175,
+    0x168405EB, 0x4114DAF9, 0x6803A5FE, 0x0886FDB8, 0x3B82AB99, 0x99E2CD1F, 0x3DC7A57C, 0xEDDAEAEE,
+    0x60A3F468, 0xF7B2530B, 0xCCC60099, 0x989E161F, 0x0ED9327F, 0x25644C5D, 0x677F0973, 0xF55C5DA2,
+    0x7659886C, 0x1AF0B79E, 0xE4CA89D8, 0x1145EC39, 0x7F1B243F, 0x5EEC3D1D, 0xB824D533, 0x9D52D062,
+    0xBCF81E2C, 0x4FDC5C5E, 0x8AD9599A, 0x1169F343, 0x845028B1, 0x1F95E197, 0x90A99AD6, 0xE88360F0,
+    0x9AFD02B2, 0x669163BE, 0xD3036A78, 0x7F7E6359, 0x6D445BDF, 0xCAE1473C, 0x528F4BAE, 0xEEB5F02A,
+    0x804BB614, 0x8AF150E6, 0x14E0B141, 0x04799E67, 0xA593E4E5, 0xEE60151A, 0x73E30CCB, 0xBFD0D958,
+    0xB92F69B9, 0xC3DA47BE, 0x4E8C5E77, 0x5A49A734, 0x0CA52A85, 0xD3DF253A, 0x9F406163, 0x044E1350,
+    0x9F48CA91, 0x058546F6, 0xCC43418F, 0x85B879AC, 0x53A995DD, 0x1782A8F2, 0x65E26AFB, 0xB9B97648,
+    0xD7CE1869, 0x30C9872E, 0x0D2089A7, 0xE5B3E524, 0x33001E35, 0x5F045DAA, 0xBBA18993, 0x1E58E240,
+    0x62D8B341, 0x4951E866, 0x98D696BF, 0x1703C99C, 0x538C238D, 0x13412362, 0xC86A1D2B, 0xF7563738,
+    0xBF75FB19, 0xAC0D4A9E, 0xDDEBC8D7, 0x13140714, 0xC1E505E5, 0x0619DA1A, 0xE1BC85C3, 0xA03F5530,
+    0x29274FF1, 0xF2AE8DD6, 0x133A7FEF, 0xC7747D8C, 0xD3D6253D, 0x9DF361D2, 0xD42D235B, 0xAA861C28,
+    0xA56211C9, 0xE72C920E, 0x69711C07, 0x3D590D04, 0xDDDEE195, 0x11369A8A, 0x7CE455F3, 0x0D006C20,
+    0xE10FA0A1, 0x87423746, 0x8C91FD1F, 0x5119957C, 0xB8B29AED, 0xB1D06442, 0xB31E7D8B, 0xE3682518,
+    0xDE0D5C79, 0x17EE5D7E, 0x75738337, 0xF9B1F6F4, 0x16B8B145, 0x48B19EFA, 0x81ABFA23, 0xBDDB2710,
+    0x70ACA551, 0x48F3E4B6, 0x8B400E4F, 0x2042116C, 0xA98C849D, 0x814F2AB2, 0xB0712BBB, 0x805B5208,
+    0x8D32DB29, 0x6859ACEE, 0x14F5FE67, 0x078DC4E4, 0x177D74F5, 0x6521E76A, 0x9DE67253, 0xD24E8600,
+    0x65595E01, 0xA5EA9626, 0xFAE7B37F, 0x437CF15C, 0xC10EE24D, 0xE726B522, 0x68982DEB, 0x1DFEA2F8,
+    0x55CD8DD9, 0x66B5805E, 0xD83B8D97, 0x409B76D4, 0x56782CA5, 0x7F5E73DA, 0x68A6BE83, 0x201988F0,
+    0xA3B0CAB1, 0xA88D4B96, 0x5C6BECAF, 0x5B99354C, 0x3D24B3FD, 0xD64E0392, 0xF946841B, 0x073117E8,
+    0x0A187489, 0x7588D7CE, 0xFCC730C7, 0x88CA0CC4, 0xC533D855, 0x807E444A, 0x923FDEB3, 0x233B2FE0,
+    0x178DEB61, 0x67830506, 0xF5EFB9DF, 0x8BA5DD3C, 0x2EF8F9AD, 0xC9FC1602, 0x316F2E4B, 0x2511B0D8,
+    0x5B8E8F39, 0x3B9AB33E, 0x9D5BE7F7, 0xBE4886B4, 0x807B7805, 0x91D858BA, 0x1444D2E3, 0xEDF27AD0,
+    0x640BC011, 0x75B2C276, 0x02D61B0F, 0x68F1E92C, 0x2AF6B35D, 0x35A7EC72, 0xC1452C7B, 0xEEFF6DC8,
+    0x8AEADDE9, 0x13F212AE, 0xE1FCB327, 0xA985E4A4, 0x805A0BB5, 0x8D03B12A, 0x61889B13, 0x18BE69C0,
+    0x938548C1, 0x524383E6, 0xE3C2103F, 0xEB0C591C, 0xF8C8E10D, 0xF50886E2, 0x6A3B7EAB, 0x5A994EB8,
+    0x18286099, 0x7DD5F61E, 0x2FEC9257, 0xED312694, 0x481A9365, 0x6BD74D9A, 0x961E3743, 0xB25DFCB0,
+    0xC7958571, 0xD89C4956, 0x4E96996F, 0x5BC42D0C, 0x435A82BD, 0xBC14E552, 0x2F0524DB, 0xCBBE53A8,
+    0x72821749, 0x8CCD5D8E, 0x59AE8587, 0xF6394C84, 0x96480F15, 0xB86A2E0A, 0xA758A773, 0x2FD033A0,
+    0xE9177621, 0xB06412C6, 0x7E76B69F, 0x472864FC, 0x48D6986D, 0x870407C2, 0x83951F0B, 0x048D7C98,
+    0xA87301F9, 0x589F48FE, 0xCF058CB7, 0xEBCD5674, 0x14AD7EC5, 0xFD13527A, 0x93CAEBA3, 0x5C540E90,
+    0x58261AD1, 0xBD81E036, 0x63C567CF, 0x6B8800EC, 0x8AA8221D, 0x0A4CEE32, 0x7D1E6D3B, 0x1565C988,
+    0x17B620A9, 0x6D52B86E, 0xCCF4A7E7, 0x9F5C4464, 0x0855E275, 0x3469BAEA, 0x934803D3, 0x49688D80,
+    0x9C1C7381
+  },
+  {
+    0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+    0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+    0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+    0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AB,
+    0x986FE5BA, 0x082C33E4, 0x2E637FF6, 0xB4617E92, 0x12174B1C, 0x9D5DDB0E, 0xBE90A909, 0x8AE86E4F,
+    0x1397F16D, 0xD4F5E4C3, 0xC78A1031, 0xD6F45718, 0x1150967A, 0x80A5BFA4, 0x97F4B2B8, 0xF65DD499,
+    0x9B8FBA1E, 0x7BC5E657, 0xE39A4A94, 0xE54CC765, 0x2418D19A, 0x37964B4A, 0x08B8E1B4, 0x42B89F05,
+    0xA4AEFBBB, 0xCD4A6209, 0xABC02B50, 0xD2C64292, 0x76A79F1C, 0x2639FF10, 0x8661DD52, 0x6C24FCDC,
+    0xA1588BCF, 0x51CC34ED, 0xD283A643, 0x6D0707B1, 0xC2041C96, 0x0A9821B0, 0x87FCDE77, 0xA78C2734,
+    0x3741AA86, 0xFC7DA55F, 0x7E28E6BD, 0x3BE95952, 0xA8B9E8DC, 0x62DEA7CD, 0x4A2E40A3, 0xB8AF5791,
+    0xB157A7F8, 0xA1AB46DA, 0x5DC13D84, 0x8CEDE418, 0x5E61F77A, 0xA428C4A4, 0xB9E46BB7, 0xDE039175,
+    0x168405EB, 0x4114DAF9, 0x6803A5FE, 0x0886FDB8, 0x3B82AB99, 0x99E2CD1F, 0x3DC7A57C, 0xEDDAEAEE,
+    0x60A3F468, 0xF7B2530B, 0xCCC60099, 0x989E161F, 0x0ED9327F, 0x25644C5D, 0x677F0973, 0xF55C5DA2,
+    0x7659886C, 0x1AF0B79E, 0xE4CA89D8, 0x1145EC39, 0x7F1B243F, 0x5EEC3D1D, 0xB824D533, 0x9D52D062,
+    0xBCF81E2C, 0x4FDC5C5E, 0x8AD9599A, 0x1169F343, 0x845028B1, 0x1F95E197, 0x90A99AD6, 0xE88360F0,
+    0x9AFD02B2, 0x669163BE, 0xD3036A78, 0x7F7E6359, 0x6D445BDF, 0xCAE1473C, 0x528F4BAE, 0xEEB5F02A,
+    0x804BB614, 0x8AF150E6, 0x14E0B141, 0x04799E67, 0xA593E4E5, 0xEE60151A, 0x73E30CCB, 0xBFD0D958,
+    0xB92F69B9, 0xC3DA47BE, 0x4E8C5E77, 0x5A49A734, 0x0CA52A85, 0xD3DF253A, 0x9F406163, 0x044E1350,
+    0x9F48CA91, 0x058546F6, 0xCC43418F, 0x85B879AC, 0x53A995DD, 0x1782A8F2, 0x65E26AFB, 0xB9B97648,
+    0xD7CE1869, 0x30C9872E, 0x0D2089A7, 0xE5B3E524, 0x33001E35, 0x5F045DAA, 0xBBA18993, 0x1E58E240,
+    0x62D8B341, 0x4951E866, 0x98D696BF, 0x1703C99C, 0x538C238D, 0x13412362, 0xC86A1D2B, 0xF7563738,
+    0xBF75FB19, 0xAC0D4A9E, 0xDDEBC8D7, 0x13140714, 0xC1E505E5, 0x0619DA1A, 0xE1BC85C3, 0xA03F5530,
+    0x29274FF1, 0xF2AE8DD6, 0x133A7FEF, 0xC7747D8C, 0xD3D6253D, 0x9DF361D2, 0xD42D235B, 0xAA861C28,
+    0xA56211C9, 0xE72C920E, 0x69711C07, 0x3D590D04, 0xDDDEE195, 0x11369A8A, 0x7CE455F3, 0x0D006C20,
+    0xE10FA0A1, 0x87423746, 0x8C91FD1F, 0x5119957C, 0xB8B29AED, 0xB1D06442, 0xB31E7D8B, 0xE3682518,
+    0xDE0D5C79, 0x17EE5D7E, 0x75738337, 0xF9B1F6F4, 0x16B8B145, 0x48B19EFA, 0x81ABFA23, 0xBDDB2710,
+    0x70ACA551, 0x48F3E4B6, 0x8B400E4F, 0x2042116C, 0xA98C849D, 0x814F2AB2, 0xB0712BBB, 0x805B5208,
+    0x8D32DB29, 0x6859ACEE, 0x14F5FE67, 0x078DC4E4, 0x177D74F5, 0x6521E76A, 0x9DE67253, 0xD24E8600,
+    0x65595E01, 0xA5EA9626, 0xFAE7B37F, 0x437CF15C, 0xC10EE24D, 0xE726B522, 0x68982DEB, 0x1DFEA2F8,
+    0x55CD8DD9, 0x66B5805E, 0xD83B8D97, 0x409B76D4, 0x56782CA5, 0x7F5E73DA, 0x68A6BE83, 0x201988F0,
+    0xA3B0CAB1, 0xA88D4B96, 0x5C6BECAF, 0x5B99354C, 0x3D24B3FD, 0xD64E0392, 0xF946841B, 0x073117E8,
+    0x0A187489, 0x7588D7CE, 0xFCC730C7, 0x88CA0CC4, 0xC533D855, 0x807E444A, 0x923FDEB3, 0x233B2FE0,
+    0x178DEB61, 0x67830506, 0xF5EFB9DF, 0x8BA5DD3C, 0x2EF8F9AD, 0xC9FC1602, 0x316F2E4B, 0x2511B0D8,
+    0x5B8E8F39, 0x3B9AB33E, 0x9D5BE7F7, 0xBE4886B4, 0x807B7805, 0x91D858BA, 0x1444D2E3, 0xEDF27AD0,
+    0x640BC011, 0x75B2C276, 0x02D61B0F, 0x68F1E92C, 0x2AF6B35D, 0x35A7EC72, 0xC1452C7B, 0xEEFF6DC8,
+    0x8AEADDE9, 0x13F212AE, 0xE1FCB327, 0xA985E4A4, 0x805A0BB5, 0x8D03B12A, 0x61889B13, 0x18BE69C0,
+    0x938548C1, 0x524383E6, 0xE3C2103F, 0xEB0C591C, 0xF8C8E10D, 0xF50886E2, 0x6A3B7EAB, 0x5A994EB8,
+    0x18286099, 0x7DD5F61E, 0x2FEC9257, 0xED312694, 0x481A9365, 0x6BD74D9A, 0x961E3743, 0xB25DFCB0,
+    0xC7958571, 0xD89C4956, 0x4E96996F, 0x5BC42D0C, 0x435A82BD, 0xBC14E552, 0x2F0524DB, 0xCBBE53A8,
+    0x72821749, 0x8CCD5D8E, 0x59AE8587, 0xF6394C84, 0x96480F15, 0xB86A2E0A, 0xA758A773, 0x2FD033A0,
+    0xE9177621, 0xB06412C6, 0x7E76B69F, 0x472864FC, 0x48D6986D, 0x870407C2, 0x83951F0B, 0x048D7C98,
+    0xA87301F9, 0x589F48FE, 0xCF058CB7, 0xEBCD5674, 0x14AD7EC5, 0xFD13527A, 0x93CAEBA3, 0x5C540E90,
+    0x58261AD1, 0xBD81E036, 0x63C567CF, 0x6B8800EC, 0x8AA8221D, 0x0A4CEE32, 0x7D1E6D3B, 0x1565C988,
+    0x17B620A9, 0x6D52B86E, 0xCCF4A7E7, 0x9F5C4464, 0x0855E275, 0x3469BAEA, 0x934803D3, 0x49688D80,
+    0x9C1C7381
+  },
+  {
+    0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+    0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+    0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+    0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AB,
+    0x986FE5BA, 0x082C33E4, 0x2E637FF6, 0xB4617E92, 0x12174B1C, 0x9D5DDB0E, 0xBE90A909, 0x8AE86E4F,
+    0x1397F16D, 0xD4F5E4C3, 0xC78A1031, 0xD6F45718, 0x1150967A, 0x80A5BFA4, 0x97F4B2B8, 0xF65DD499,
+    0x9B8FBA1E, 0x7BC5E657, 0xE39A4A94, 0xE54CC765, 0x2418D19A, 0x37964B4A, 0x08B8E1B4, 0x42B89F05,
+    0xA4AEFBBB, 0xCD4A6209, 0xABC02B50, 0xD2C64292, 0x76A79F1C, 0x2639FF10, 0x8661DD52, 0x6C24FCDC,
+    0xA1588BCF, 0x51CC34ED, 0xD283A643, 0x6D0707B1, 0xC2041C96, 0x0A9821B0, 0x87FCDE77, 0xA78C2734,
+    0x3741AA86, 0xFC7DA55F, 0x7E28E6BD, 0x3BE95952, 0xA8B9E8DC, 0x62DEA7CD, 0x4A2E40A3, 0xB8AF5791,
+    0xB157A7F8, 0xA1AB46DA, 0x5DC13D84, 0x8CEDE418, 0x5E61F77A, 0xA428C4A4, 0xB9E46BB7, 0xDE039175,
+    0x168405EB, 0x4114DAF9, 0x6803A5FE, 0x0886FDB8, 0x3B82AB99, 0x99E2CD1F, 0x3DC7A57C, 0xEDDAEAEE,
+    0x60A3F468, 0xF7B2530B, 0xCCC60099, 0x989E161F, 0x0ED9327F, 0x25644C5D, 0x677F0973, 0xF55C5DA2,
+    0x7659886C, 0x1AF0B79E, 0xE4CA89D8, 0x1145EC39, 0x7F1B243F, 0x5EEC3D1D, 0xB824D533, 0x9D52D062,
+    0xBCF81E2C, 0x4FDC5C5E, 0x8AD9599A, 0x1169F343, 0x845028B1, 0x1F95E197, 0x90A99AD6, 0xE88360F0,
+    0x9AFD02B2, 0x669163BE, 0xD3036A78, 0x7F7E6359, 0x6D445BDF, 0xCAE1473C, 0x528F4BAE, 0xEEB5F02A,
+    0x804BB614, 0x8AF150E6, 0x14E0B141, 0x04799E67, 0xA593E4E5, 0xEE60151A, 0x73E30CCB, 0xBFD0D958,
+    0xB92F69B9, 0xC3DA47BE, 0x4E8C5E77, 0x5A49A734, 0x0CA52A85, 0xD3DF253A, 0x9F406163, 0x044E1350,
+    0x9F48CA91, 0x058546F6, 0xCC43418F, 0x85B879AC, 0x53A995DD, 0x1782A8F2, 0x65E26AFB, 0xB9B97648,
+    0xD7CE1869, 0x30C9872E, 0x0D2089A7, 0xE5B3E524, 0x33001E35, 0x5F045DAA, 0xBBA18993, 0x1E58E240,
+    0x62D8B341, 0x4951E866, 0x98D696BF, 0x1703C99C, 0x538C238D, 0x13412362, 0xC86A1D2B, 0xF7563738,
+    0xBF75FB19, 0xAC0D4A9E, 0xDDEBC8D7, 0x13140714, 0xC1E505E5, 0x0619DA1A, 0xE1BC85C3, 0xA03F5530,
+    0x29274FF1, 0xF2AE8DD6, 0x133A7FEF, 0xC7747D8C, 0xD3D6253D, 0x9DF361D2, 0xD42D235B, 0xAA861C28,
+    0xA56211C9, 0xE72C920E, 0x69711C07, 0x3D590D04, 0xDDDEE195, 0x11369A8A, 0x7CE455F3, 0x0D006C20,
+    0xE10FA0A1, 0x87423746, 0x8C91FD1F, 0x5119957C, 0xB8B29AED, 0xB1D06442, 0xB31E7D8B, 0xE3682518,
+    0xDE0D5C79, 0x17EE5D7E, 0x75738337, 0xF9B1F6F4, 0x16B8B145, 0x48B19EFA, 0x81ABFA23, 0xBDDB2710,
+    0x70ACA551, 0x48F3E4B6, 0x8B400E4F, 0x2042116C, 0xA98C849D, 0x814F2AB2, 0xB0712BBB, 0x805B5208,
+    0x8D32DB29, 0x6859ACEE, 0x14F5FE67, 0x078DC4E4, 0x177D74F5, 0x6521E76A, 0x9DE67253, 0xD24E8600,
+    0x65595E01, 0xA5EA9626, 0xFAE7B37F, 0x437CF15C, 0xC10EE24D, 0xE726B522, 0x68982DEB, 0x1DFEA2F8,
+    0x55CD8DD9, 0x66B5805E, 0xD83B8D97, 0x409B76D4, 0x56782CA5, 0x7F5E73DA, 0x68A6BE83, 0x201988F0,
+    0xA3B0CAB1, 0xA88D4B96, 0x5C6BECAF, 0x5B99354C, 0x3D24B3FD, 0xD64E0392, 0xF946841B, 0x073117E8,
+    0x0A187489, 0x7588D7CE, 0xFCC730C7, 0x88CA0CC4, 0xC533D855, 0x807E444A, 0x923FDEB3, 0x233B2FE0,
+    0x178DEB61, 0x67830506, 0xF5EFB9DF, 0x8BA5DD3C, 0x2EF8F9AD, 0xC9FC1602, 0x316F2E4B, 0x2511B0D8,
+    0x5B8E8F39, 0x3B9AB33E, 0x9D5BE7F7, 0xBE4886B4, 0x807B7805, 0x91D858BA, 0x1444D2E3, 0xEDF27AD0,
+    0x640BC011, 0x75B2C276, 0x02D61B0F, 0x68F1E92C, 0x2AF6B35D, 0x35A7EC72, 0xC1452C7B, 0xEEFF6DC8,
+    0x8AEADDE9, 0x13F212AE, 0xE1FCB327, 0xA985E4A4, 0x805A0BB5, 0x8D03B12A, 0x61889B13, 0x18BE69C0,
+    0x938548C1, 0x524383E6, 0xE3C2103F, 0xEB0C591C, 0xF8C8E10D, 0xF50886E2, 0x6A3B7EAB, 0x5A994EB8,
+    0x18286099, 0x7DD5F61E, 0x2FEC9257, 0xED312694, 0x481A9365, 0x6BD74D9A, 0x961E3743, 0xB25DFCB0,
+    0xC7958571, 0xD89C4956, 0x4E96996F, 0x5BC42D0C, 0x435A82BD, 0xBC14E552, 0x2F0524DB, 0xCBBE53A8,
+    0x72821749, 0x8CCD5D8E, 0x59AE8587, 0xF6394C84, 0x96480F15, 0xB86A2E0A, 0xA758A773, 0x2FD033A0,
+    0xE9177621, 0xB06412C6, 0x7E76B69F, 0x472864FC, 0x48D6986D, 0x870407C2, 0x83951F0B, 0x048D7C98,
+    0xA87301F9, 0x589F48FE, 0xCF058CB7, 0xEBCD5674, 0x14AD7EC5, 0xFD13527A, 0x93CAEBA3, 0x5C540E90,
+    0x58261AD1, 0xBD81E036, 0x63C567CF, 0x6B8800EC, 0x8AA8221D, 0x0A4CEE32, 0x7D1E6D3B, 0x1565C988,
+    0x17B620A9, 0x6D52B86E, 0xCCF4A7E7, 0x9F5C4464, 0x0855E275, 0x3469BAEA, 0x934803D3, 0x49688D80,
+    0x9C1C7381
+  },
+  {
+    0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+    0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+    0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+    0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AB,
+    0x986FE5BA, 0x082C33E4, 0x2E637FF6, 0xB4617E92, 0x12174B1C, 0x9D5DDB0E, 0xBE90A909, 0x8AE86E4F,
+    0x1397F16D, 0xD4F5E4C3, 0xC78A1031, 0xD6F45718, 0x1150967A, 0x80A5BFA4, 0x97F4B2B8, 0xF65DD499,
+    0x9B8FBA1E, 0x7BC5E657, 0xE39A4A94, 0xE54CC765, 0x2418D19A, 0x37964B4A, 0x08B8E1B4, 0x42B89F05,
+    0xA4AEFBBB, 0xCD4A6209, 0xABC02B50, 0xD2C64292, 0x76A79F1C, 0x2639FF10, 0x8661DD52, 0x6C24FCDC,
+    0xA1588BCF, 0x51CC34ED, 0xD283A643, 0x6D0707B1, 0xC2041C96, 0x0A9821B0, 0x87FCDE77, 0xA78C2734,
+    0x3741AA86, 0xFC7DA55F, 0x7E28E6BD, 0x3BE95952, 0xA8B9E8DC, 0x62DEA7CD, 0x4A2E40A3, 0xB8AF5791,
+    0xB157A7F8, 0xA1AB46DA, 0x5DC13D84, 0x8CEDE418, 0x5E61F77A, 0xA428C4A4, 0xB9E46BB7, 0xDE039175,
+    0x168405EB, 0x4114DAF9, 0x6803A5FE, 0x0886FDB8, 0x3B82AB99, 0x99E2CD1F, 0x3DC7A57C, 0xEDDAEAEE,
+    0x60A3F468, 0xF7B2530B, 0xCCC60099, 0x989E161F, 0x0ED9327F, 0x25644C5D, 0x677F0973, 0xF55C5DA2,
+    0x7659886C, 0x1AF0B79E, 0xE4CA89D8, 0x1145EC39, 0x7F1B243F, 0x5EEC3D1D, 0xB824D533, 0x9D52D062,
+    0xBCF81E2C, 0x4FDC5C5E, 0x8AD9599A, 0x1169F343, 0x845028B1, 0x1F95E197, 0x90A99AD6, 0xE88360F0,
+    0x9AFD02B2, 0x669163BE, 0xD3036A78, 0x7F7E6359, 0x6D445BDF, 0xCAE1473C, 0x528F4BAE, 0xEEB5F02A,
+    0x804BB614, 0x8AF150E6, 0x14E0B141, 0x04799E67, 0xA593E4E5, 0xEE60151A, 0x73E30CCB, 0xBFD0D958,
+    0xB92F69B9, 0xC3DA47BE, 0x4E8C5E77, 0x5A49A734, 0x0CA52A85, 0xD3DF253A, 0x9F406163, 0x044E1350,
+    0x9F48CA91, 0x058546F6, 0xCC43418F, 0x85B879AC, 0x53A995DD, 0x1782A8F2, 0x65E26AFB, 0xB9B97648,
+    0xD7CE1869, 0x30C9872E, 0x0D2089A7, 0xE5B3E524, 0x33001E35, 0x5F045DAA, 0xBBA18993, 0x1E58E240,
+    0x62D8B341, 0x4951E866, 0x98D696BF, 0x1703C99C, 0x538C238D, 0x13412362, 0xC86A1D2B, 0xF7563738,
+    0xBF75FB19, 0xAC0D4A9E, 0xDDEBC8D7, 0x13140714, 0xC1E505E5, 0x0619DA1A, 0xE1BC85C3, 0xA03F5530,
+    0x29274FF1, 0xF2AE8DD6, 0x133A7FEF, 0xC7747D8C, 0xD3D6253D, 0x9DF361D2, 0xD42D235B, 0xAA861C28,
+    0xA56211C9, 0xE72C920E, 0x69711C07, 0x3D590D04, 0xDDDEE195, 0x11369A8A, 0x7CE455F3, 0x0D006C20,
+    0xE10FA0A1, 0x87423746, 0x8C91FD1F, 0x5119957C, 0xB8B29AED, 0xB1D06442, 0xB31E7D8B, 0xE3682518,
+    0xDE0D5C79, 0x17EE5D7E, 0x75738337, 0xF9B1F6F4, 0x16B8B145, 0x48B19EFA, 0x81ABFA23, 0xBDDB2710,
+    0x70ACA551, 0x48F3E4B6, 0x8B400E4F, 0x2042116C, 0xA98C849D, 0x814F2AB2, 0xB0712BBB, 0x805B5208,
+    0x8D32DB29, 0x6859ACEE, 0x14F5FE67, 0x078DC4E4, 0x177D74F5, 0x6521E76A, 0x9DE67253, 0xD24E8600,
+    0x65595E01, 0xA5EA9626, 0xFAE7B37F, 0x437CF15C, 0xC10EE24D, 0xE726B522, 0x68982DEB, 0x1DFEA2F8,
+    0x55CD8DD9, 0x66B5805E, 0xD83B8D97, 0x409B76D4, 0x56782CA5, 0x7F5E73DA, 0x68A6BE83, 0x201988F0,
+    0xA3B0CAB1, 0xA88D4B96, 0x5C6BECAF, 0x5B99354C, 0x3D24B3FD, 0xD64E0392, 0xF946841B, 0x073117E8,
+    0x0A187489, 0x7588D7CE, 0xFCC730C7, 0x88CA0CC4, 0xC533D855, 0x807E444A, 0x923FDEB3, 0x233B2FE0,
+    0x178DEB61, 0x67830506, 0xF5EFB9DF, 0x8BA5DD3C, 0x2EF8F9AD, 0xC9FC1602, 0x316F2E4B, 0x2511B0D8,
+    0x5B8E8F39, 0x3B9AB33E, 0x9D5BE7F7, 0xBE4886B4, 0x807B7805, 0x91D858BA, 0x1444D2E3, 0xEDF27AD0,
+    0x640BC011, 0x75B2C276, 0x02D61B0F, 0x68F1E92C, 0x2AF6B35D, 0x35A7EC72, 0xC1452C7B, 0xEEFF6DC8,
+    0x8AEADDE9, 0x13F212AE, 0xE1FCB327, 0xA985E4A4, 0x805A0BB5, 0x8D03B12A, 0x61889B13, 0x18BE69C0,
+    0x938548C1, 0x524383E6, 0xE3C2103F, 0xEB0C591C, 0xF8C8E10D, 0xF50886E2, 0x6A3B7EAB, 0x5A994EB8,
+    0x18286099, 0x7DD5F61E, 0x2FEC9257, 0xED312694, 0x481A9365, 0x6BD74D9A, 0x961E3743, 0xB25DFCB0,
+    0xC7958571, 0xD89C4956, 0x4E96996F, 0x5BC42D0C, 0x435A82BD, 0xBC14E552, 0x2F0524DB, 0xCBBE53A8,
+    0x72821749, 0x8CCD5D8E, 0x59AE8587, 0xF6394C84, 0x96480F15, 0xB86A2E0A, 0xA758A773, 0x2FD033A0,
+    0xE9177621, 0xB06412C6, 0x7E76B69F, 0x472864FC, 0x48D6986D, 0x870407C2, 0x83951F0B, 0x048D7C98,
+    0xA87301F9, 0x589F48FE, 0xCF058CB7, 0xEBCD5674, 0x14AD7EC5, 0xFD13527A, 0x93CAEBA3, 0x5C540E90,
+    0x58261AD1, 0xBD81E036, 0x63C567CF, 0x6B8800EC, 0x8AA8221D, 0x0A4CEE32, 0x7D1E6D3B, 0x1565C988,
+    0x17B620A9, 0x6D52B86E, 0xCCF4A7E7, 0x9F5C4464, 0x0855E275, 0x3469BAEA, 0x934803D3, 0x49688D80,
+    0x9C1C7381
+  },
+  {
+    0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+    0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+    0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+    0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AB,
+    0x986FE5BA, 0x082C33E4, 0x2E637FF6, 0xB4617E92, 0x12174B1C, 0x9D5DDB0E, 0xBE90A909, 0x8AE86E4F,
+    0x1397F16D, 0xD4F5E4C3, 0xC78A1031, 0xD6F45718, 0x1150967A, 0x80A5BFA4, 0x97F4B2B8, 0xF65DD499,
+    0x9B8FBA1E, 0x7BC5E657, 0xE39A4A94, 0xE54CC765, 0x2418D19A, 0x37964B4A, 0x08B8E1B4, 0x42B89F05,
+    0xA4AEFBBB, 0xCD4A6209, 0xABC02B50, 0xD2C64292, 0x76A79F1C, 0x2639FF10, 0x8661DD52, 0x6C24FCDC,
+    0xA1588BCF, 0x51CC34ED, 0xD283A643, 0x6D0707B1, 0xC2041C96, 0x0A9821B0, 0x87FCDE77, 0xA78C2734,
+    0x3741AA86, 0xFC7DA55F, 0x7E28E6BD, 0x3BE95952, 0xA8B9E8DC, 0x62DEA7CD, 0x4A2E40A3, 0xB8AF5791,
+    0xB157A7F8, 0xA1AB46DA, 0x5DC13D84, 0x8CEDE418, 0x5E61F77A, 0xA428C4A4, 0xB9E46BB7, 0xDE039175,
+    0x168405EB, 0x4114DAF9, 0x6803A5FE, 0x0886FDB8, 0x3B82AB99, 0x99E2CD1F, 0x3DC7A57C, 0xEDDAEAEE,
+    0x60A3F468, 0xF7B2530B, 0xCCC60099, 0x989E161F, 0x0ED9327F, 0x25644C5D, 0x677F0973, 0xF55C5DA2,
+    0x7659886C, 0x1AF0B79E, 0xE4CA89D8, 0x1145EC39, 0x7F1B243F, 0x5EEC3D1D, 0xB824D533, 0x9D52D062,
+    0xBCF81E2C, 0x4FDC5C5E, 0x8AD9599A, 0x1169F343, 0x845028B1, 0x1F95E197, 0x90A99AD6, 0xE88360F0,
+    0x9AFD02B2, 0x669163BE, 0xD3036A78, 0x7F7E6359, 0x6D445BDF, 0xCAE1473C, 0x528F4BAE, 0xEEB5F02A,
+    0x804BB614, 0x8AF150E6, 0x14E0B141, 0x04799E67, 0xA593E4E5, 0xEE60151A, 0x73E30CC6, 0xBFD0D89F,
+    0xB92F4EFD, 0xC3D66A92, 0x4DFD671C, 0x459FE712, 0x101C659F, 0x541AAFFC, 0x27DB6F6D, 0xC2B71AC2,
+    0x2476DE0B, 0x452E1798, 0xFFA968F9, 0xF37C2BFE, 0x30F25BB7, 0x13074174, 0xC00C75C5, 0xC1CD057A,
+    0x02A1CAA3, 0x61624990, 0x1334A1D1, 0xC69B6336, 0xB47556CF, 0x14F58BEC, 0x077D391D, 0x15194132,
+    0x0CA66C3B, 0xD40DA488, 0xA5F8C7A9, 0xFCF4DB6E, 0x8F63B6E7, 0xB9696F64, 0xCC3D1975, 0x84D4ADEA,
+    0x32BD22D3, 0x55560880, 0x556F3A81, 0x591374A6, 0xDFCFDBFF, 0x590ACBDC, 0xDE8F76CD, 0x2ABC2BA2,
+    0x2D324E6B, 0x88455578, 0xB2055A59, 0xBAC60EDE, 0xFEA02617, 0xCD258154, 0xA66BB125, 0x0D909A5A,
+    0xF5E64F03, 0x8A496B70, 0xFC9C8731, 0x829F8A16, 0xE10EF52F, 0x87296FCC, 0x88FD287D, 0xCC96DA12,
+    0x91CD849B, 0x12B42A68, 0xB40A2109, 0x0576C64E, 0xCA2AA947, 0x382A7744, 0x1E233CD5, 0x5B17CACA,
+    0x2A704F33, 0x223B7260, 0xF29787E1, 0x0FE6A386, 0x4C55A25F, 0x086077BC, 0x35F14E2D, 0xCBE04C82,
+    0x776B0ECB, 0x42792358, 0x9B821BB9, 0x79CE01BE, 0x9AC64077, 0x5EA75134, 0xAE2EBC85, 0x2CC13F3A,
+    0x77EE2363, 0x556B1D50, 0x587B3C91, 0xC9CFC0F6, 0x2B06E38F, 0x37FEE3AC, 0x17D6E7DD, 0x720F82F2,
+    0x7C3DECFB, 0xF4F34048, 0x67284A69, 0xE8D2C12E, 0xA675EBA7, 0x0F0B0F24, 0x2C993035, 0x7223F7AA,
+    0x7F32CB93, 0x62576C40, 0x36A2A541, 0xE581E266, 0x2BC5B8BF, 0x5393B39C, 0x1458F58D, 0xF0DB7D62,
+    0xCFB91F2B, 0x05C18138, 0xD4F7AD19, 0xC7CC049E, 0xE07CAAD7, 0x7204B114, 0x7AAD97E5, 0xBB16F41A,
+    0x0A5147C3, 0x7DBF5F30, 0x2CA8C1F1, 0x746407D6, 0xD27521EF, 0x6AEDE78C, 0x7462773D, 0xD23B3BD2,
+    0x628FA55B, 0x3EC2E628, 0x122B43C9, 0xA040CC0E, 0x295D7E07, 0xFA833704, 0x34F6F395, 0xA7B1348A,
+    0x3C9C97F3, 0xC2A1F620, 0x216892A1, 0xD41D3146, 0xA8381F1F, 0x501C7F7C, 0x941E6CED, 0x6865BE42,
+    0x16B47F8B, 0x48166F18, 0x6B3E0E79, 0x7FF8177E, 0x7EDB6537, 0x55B5A0F4, 0x63404345, 0x5849B8FA,
+    0xC2A7BC23, 0x223E3110, 0xF2FD1751, 0x1E945EB6, 0x6B71B04F, 0x876E7B6C, 0x92F7D69D, 0x3DD204B2,
+    0xEF5AADBB, 0x981B1C08, 0xFBEB0D29, 0x68F8E6EE, 0x2BF96067, 0x5B0AEEE4, 0x289486F5, 0xDD77816A,
+    0x0245B453, 0x54131000, 0x26C15001, 0x99F09026, 0x3FC4D57F, 0x3772DB5C, 0x0399B44D, 0x85370F22,
+    0x40F52FEB, 0x636FECF8, 0x5F2D3FD9, 0xC18A3A5E, 0xF8FA6F97, 0xFC3220D4, 0x733EBEA5, 0xA8118DDA,
+    0x4A898083, 0xC5DF92F0, 0x99503CB1, 0x2898C596, 0xDE148EAF, 0x18F89F4C, 0x9BEF05FD, 0x898BDD92,
+    0xE137061B, 0x8CF3E1E8, 0x5F3FA689, 0xC43311CE, 0x5B6192C7, 0x351A36C4, 0xACC9EA55, 0xF92EDE4A,
+    0x03C620B3, 0x8BA2B9E0, 0x2E84DD61, 0xB933FF06, 0xC483DBDF, 0x670EC73C, 0xE522CBAD, 0x1E077002,
+    0x5713304B, 0x95C5FAD8, 0xA59D4139, 0xEFBA6D3E, 0xA5F1C9F7, 0xFBF230B4, 0x6A010A05, 0x522672BA,
+    0xDF8E94E3, 0x4F9B84D0, 0x817A3211, 0xB6A93C76, 0x6675BD0F, 0xCF04532C, 0xEBA0055D, 0x0E20C672,
+    0x0ABCAE7B
+  },
+  {
+    0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+    0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+    0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+    0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AB,
+    0x986FE5BA, 0x082C33E4, 0x2E637FF6, 0xB4617E92, 0x12174B1C, 0x9D5DDB0E, 0xBE90A909, 0x8AE86E4F,
+    0x1397F16D, 0xD4F5E4C3, 0xC78A1031, 0xD6F45718, 0x1150967A, 0x80A5BFA4, 0x97F4B2B8, 0xF65DD499,
+    0x9B8FBA1E, 0x7BC5E657, 0xE39A4A94, 0xE54CC765, 0x2418D19A, 0x37964B4A, 0x08B8E1B4, 0x42B89F05,
+    0xA4AEFBBB, 0xCD4A6209, 0xABC02B50, 0xD2C64292, 0x76A79F1C, 0x2639FF10, 0x8661DD52, 0x6C24FCDC,
+    0xA1588BCF, 0x51CC34ED, 0xD283A643, 0x6D0707B1, 0xC2041C96, 0x0A9821B0, 0x87FCDE77, 0xA78C2734,
+    0x3741AA86, 0xFC7DA55F, 0x7E28E6BD, 0x3BE95952, 0xA8B9E8DC, 0x62DEA7CD, 0x4A2E40A3, 0xB8AF5791,
+    0xB157A7F8, 0xA1AB46DA, 0x5DC13D84, 0x8CEDE418, 0x5E61F77A, 0xA428C4A4, 0xB9E46BB7, 0xDE039175,
+    0x168405EB, 0x4114DAF9, 0x6803A5FE, 0x0886FDB8, 0x3B82AB99, 0x99E2CD1F, 0x3DC7A57C, 0xEDDAEAEE,
+    0x60A3F468, 0xF7B2530B, 0xCCC60099, 0x989E161F, 0x0ED9327F, 0x25644C5D, 0x677F0973, 0xF55C5DA2,
+    0x7659886C, 0x1AF0B79E, 0xE4CA89D8, 0x1145EC39, 0x7F1B243F, 0x5EEC3D1D, 0xB824D533, 0x9D52D062,
+    0xBCF81E2C, 0x4FDC5C5E, 0x8AD9599A, 0x1169F343, 0x845028B1, 0x1F95E197, 0x90A99AD6, 0xE88360F0,
+    0x9AFD02B2, 0x669163BE, 0xD3036A78, 0x7F7E6359, 0x6D445BDF, 0xCAE1473C, 0x528F4BAE, 0xEEB5F02A,
+    0x804BB614, 0x8AF150E6, 0x14E0B141, 0x04799E67, 0xA593E4E5, 0xEE60151A, 0x73E30CC6, 0xBFD0D89F,
+    0xB92F4EFD, 0xC3D66A92, 0x4DFD671C, 0x459FE712, 0x101C659F, 0x541AAFFC, 0x27DB6F6D, 0xC2B71AC2,
+    0x2476DE0B, 0x452E1798, 0xFFA968F9, 0xF37C2BFE, 0x30F25BB7, 0x13074174, 0xC00C75C5, 0xC1CD057A,
+    0x02A1CAA3, 0x61624990, 0x1334A1D1, 0xC69B6336, 0xB47556CF, 0x14F58BEC, 0x077D391D, 0x15194132,
+    0x0CA66C3B, 0xD40DA488, 0xA5F8C7A9, 0xFCF4DB6E, 0x8F63B6E7, 0xB9696F64, 0xCC3D1975, 0x84D4ADEA,
+    0x32BD22D3, 0x55560880, 0x556F3A81, 0x591374A6, 0xDFCFDBFF, 0x590ACBDC, 0xDE8F76CD, 0x2ABC2BA2,
+    0x2D324E6B, 0x88455578, 0xB2055A59, 0xBAC60EDE, 0xFEA02617, 0xCD258154, 0xA66BB125, 0x0D909A5A,
+    0xF5E64F03, 0x8A496B70, 0xFC9C8731, 0x829F8A16, 0xE10EF52F, 0x87296FCC, 0x88FD287D, 0xCC96DA12,
+    0x91CD849B, 0x12B42A68, 0xB40A2109, 0x0576C64E, 0xCA2AA947, 0x382A7744, 0x1E233CD5, 0x5B17CACA,
+    0x2A704F33, 0x223B7260, 0xF29787E1, 0x0FE6A386, 0x4C55A25F, 0x086077BC, 0x35F14E2D, 0xCBE04C82,
+    0x776B0ECB, 0x42792358, 0x9B821BB9, 0x79CE01BE, 0x9AC64077, 0x5EA75134, 0xAE2EBC85, 0x2CC13F3A,
+    0x77EE2363, 0x556B1D50, 0x587B3C91, 0xC9CFC0F6, 0x2B06E38F, 0x37FEE3AC, 0x17D6E7DD, 0x720F82F2,
+    0x7C3DECFB, 0xF4F34048, 0x67284A69, 0xE8D2C12E, 0xA675EBA7, 0x0F0B0F24, 0x2C993035, 0x7223F7AA,
+    0x7F32CB93, 0x62576C40, 0x36A2A541, 0xE581E266, 0x2BC5B8BF, 0x5393B39C, 0x1458F58D, 0xF0DB7D62,
+    0xCFB91F2B, 0x05C18138, 0xD4F7AD19, 0xC7CC049E, 0xE07CAAD7, 0x7204B114, 0x7AAD97E5, 0xBB16F41A,
+    0x0A5147C3, 0x7DBF5F30, 0x2CA8C1F1, 0x746407D6, 0xD27521EF, 0x6AEDE78C, 0x7462773D, 0xD23B3BD2,
+    0x628FA55B, 0x3EC2E628, 0x122B43C9, 0xA040CC0E, 0x295D7E07, 0xFA833704, 0x34F6F395, 0xA7B1348A,
+    0x3C9C97F3, 0xC2A1F620, 0x216892A1, 0xD41D3146, 0xA8381F1F, 0x501C7F7C, 0x941E6CED, 0x6865BE42,
+    0x16B47F8B, 0x48166F18, 0x6B3E0E79, 0x7FF8177E, 0x7EDB6537, 0x55B5A0F4, 0x63404345, 0x5849B8FA,
+    0xC2A7BC23, 0x223E3110, 0xF2FD1751, 0x1E945EB6, 0x6B71B04F, 0x876E7B6C, 0x92F7D69D, 0x3DD204B2,
+    0xEF5AADBB, 0x981B1C08, 0xFBEB0D29, 0x68F8E6EE, 0x2BF96067, 0x5B0AEEE4, 0x289486F5, 0xDD77816A,
+    0x0245B453, 0x54131000, 0x26C15001, 0x99F09026, 0x3FC4D57F, 0x3772DB5C, 0x0399B44D, 0x85370F22,
+    0x40F52FEB, 0x636FECF8, 0x5F2D3FD9, 0xC18A3A5E, 0xF8FA6F97, 0xFC3220D4, 0x733EBEA5, 0xA8118DDA,
+    0x4A898083, 0xC5DF92F0, 0x99503CB1, 0x2898C596, 0xDE148EAF, 0x18F89F4C, 0x9BEF05FD, 0x898BDD92,
+    0xE137061B, 0x8CF3E1E8, 0x5F3FA689, 0xC43311CE, 0x5B6192C7, 0x351A36C4, 0xACC9EA55, 0xF92EDE4A,
+    0x03C620B3, 0x8BA2B9E0, 0x2E84DD61, 0xB933FF06, 0xC483DBDF, 0x670EC73C, 0xE522CBAD, 0x1E077002,
+    0x5713304B, 0x95C5FAD8, 0xA59D4139, 0xEFBA6D3E, 0xA5F1C9F7, 0xFBF230B4, 0x6A010A05, 0x522672BA,
+    0xDF8E94E3, 0x4F9B84D0, 0x817A3211, 0xB6A93C76, 0x6675BD0F, 0xCF04532C, 0xEBA0055D, 0x0E20C672,
+    0x0ABCAE7B
+  },
+  {
+    0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+    0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+    0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+    0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AB,
+    0x986FE5BA, 0x082C33E4, 0x2E637FF6, 0xB4617E92, 0x12174B1C, 0x9D5DDB0E, 0xBE90A909, 0x8AE86E4F,
+    0x1397F16D, 0xD4F5E4C3, 0xC78A1031, 0xD6F45718, 0x1150967A, 0x80A5BFA4, 0x97F4B2B8, 0xF65DD499,
+    0x9B8FBA1E, 0x7BC5E657, 0xE39A4A94, 0xE54CC765, 0x2418D19A, 0x37964B4A, 0x08B8E1B4, 0x42B89F05,
+    0xA4AEFBBB, 0xCD4A6209, 0xABC02B50, 0xD2C64292, 0x76A79F1C, 0x2639FF10, 0x8661DD52, 0x6C24FCDC,
+    0xA1588BCF, 0x51CC34ED, 0xD283A643, 0x6D0707B1, 0xC2041C96, 0x0A9821B0, 0x87FCDE77, 0xA78C2734,
+    0x3741AA86, 0xFC7DA55F, 0x7E28E6BD, 0x3BE95952, 0xA8B9E8DC, 0x62DEA7CD, 0x4A2E40A3, 0xB8AF5791,
+    0xB157A7F8, 0xA1AB46DA, 0x5DC13D84, 0x8CEDE418, 0x5E61F77A, 0xA428C4A4, 0xB9E46BB7, 0xDE039175,
+    0x168405EB, 0x4114DAF9, 0x6803A5FE, 0x0886FDB8, 0x3B82AB99, 0x99E2CD1F, 0x3DC7A57C, 0xEDDAEAEE,
+    0x60A3F468, 0xF7B2530B, 0xCCC60099, 0x989E161F, 0x0ED9327F, 0x25644C5D, 0x677F0973, 0xF55C5DA2,
+    0x7659886C, 0x1AF0B79E, 0xE4CA89D8, 0x1145EC39, 0x7F1B243F, 0x5EEC3D1D, 0xB824D533, 0x9D52D062,
+    0xBCF81E2C, 0x4FDC5C5E, 0x8AD9599A, 0x1169F343, 0x845028B1, 0x1F95E197, 0x90A99AD6, 0xE88360F0,
+    0x9AFD02B2, 0x669163BE, 0xD3036A78, 0x7F7E6359, 0x6D445BDF, 0xCAE1473C, 0x528F4BAE, 0xEEB5F02A,
+    0x804BB614, 0x8AF150E6, 0x14E0B141, 0x04799E67, 0xA593E4E5, 0xEE60151A, 0x73E30CC6, 0xBFD0D89F,
+    0xB92F4EFD, 0xC3D66A92, 0x4DFD671C, 0x459FE712, 0x101C659F, 0x541AAFFC, 0x27DB6F6D, 0xC2B71AC2,
+    0x2476DE0B, 0x452E1798, 0xFFA968F9, 0xF37C2BFE, 0x30F25BB7, 0x13074174, 0xC00C75C5, 0xC1CD057A,
+    0x02A1CAA3, 0x61624990, 0x1334A1D1, 0xC69B6336, 0xB47556CF, 0x14F58BEC, 0x077D391D, 0x15194132,
+    0x0CA66C3B, 0xD40DA488, 0xA5F8C7A9, 0xFCF4DB6E, 0x8F63B6E7, 0xB9696F64, 0xCC3D1975, 0x84D4ADEA,
+    0x32BD22D3, 0x55560880, 0x556F3A81, 0x591374A6, 0xDFCFDBFF, 0x590ACBDC, 0xDE8F76CD, 0x2ABC2BA2,
+    0x2D324E6B, 0x88455578, 0xB2055A59, 0xBAC60EDE, 0xFEA02617, 0xCD258154, 0xA66BB125, 0x0D909A5A,
+    0xF5E64F03, 0x8A496B70, 0xFC9C8731, 0x829F8A16, 0xE10EF52F, 0x87296FCC, 0x88FD287D, 0xCC96DA12,
+    0x91CD849B, 0x12B42A68, 0xB40A2109, 0x0576C64E, 0xCA2AA947, 0x382A7744, 0x1E233CD5, 0x5B17CACA,
+    0x2A704F33, 0x223B7260, 0xF29787E1, 0x0FE6A386, 0x4C55A25F, 0x086077BC, 0x35F14E2D, 0xCBE04C82,
+    0x776B0ECB, 0x42792358, 0x9B821BB9, 0x79CE01BE, 0x9AC64077, 0x5EA75134, 0xAE2EBC85, 0x2CC13F3A,
+    0x77EE2363, 0x556B1D50, 0x587B3C91, 0xC9CFC0F6, 0x2B06E38F, 0x37FEE3AC, 0x17D6E7DD, 0x720F82F2,
+    0x7C3DECFB, 0xF4F34048, 0x67284A69, 0xE8D2C12E, 0xA675EBA7, 0x0F0B0F24, 0x2C993035, 0x7223F7AA,
+    0x7F32CB93, 0x62576C40, 0x36A2A541, 0xE581E266, 0x2BC5B8BF, 0x5393B39C, 0x1458F58D, 0xF0DB7D62,
+    0xCFB91F2B, 0x05C18138, 0xD4F7AD19, 0xC7CC049E, 0xE07CAAD7, 0x7204B114, 0x7AAD97E5, 0xBB16F41A,
+    0x0A5147C3, 0x7DBF5F30, 0x2CA8C1F1, 0x746407D6, 0xD27521EF, 0x6AEDE78C, 0x7462773D, 0xD23B3BD2,
+    0x628FA55B, 0x3EC2E628, 0x122B43C9, 0xA040CC0E, 0x295D7E07, 0xFA833704, 0x34F6F395, 0xA7B1348A,
+    0x3C9C97F3, 0xC2A1F620, 0x216892A1, 0xD41D3146, 0xA8381F1F, 0x501C7F7C, 0x941E6CED, 0x6865BE42,
+    0x16B47F8B, 0x48166F18, 0x6B3E0E79, 0x7FF8177E, 0x7EDB6537, 0x55B5A0F4, 0x63404345, 0x5849B8FA,
+    0xC2A7BC23, 0x223E3110, 0xF2FD1751, 0x1E945EB6, 0x6B71B04F, 0x876E7B6C, 0x92F7D69D, 0x3DD204B2,
+    0xEF5AADBB, 0x981B1C08, 0xFBEB0D29, 0x68F8E6EE, 0x2BF96067, 0x5B0AEEE4, 0x289486F5, 0xDD77816A,
+    0x0245B453, 0x54131000, 0x26C15001, 0x99F09026, 0x3FC4D57F, 0x3772DB5C, 0x0399B44D, 0x85370F22,
+    0x40F52FEB, 0x636FECF8, 0x5F2D3FD9, 0xC18A3A5E, 0xF8FA6F97, 0xFC3220D4, 0x733EBEA5, 0xA8118DDA,
+    0x4A898083, 0xC5DF92F0, 0x99503CB1, 0x2898C596, 0xDE148EAF, 0x18F89F4C, 0x9BEF05FD, 0x898BDD92,
+    0xE137061B, 0x8CF3E1E8, 0x5F3FA689, 0xC43311CE, 0x5B6192C7, 0x351A36C4, 0xACC9EA55, 0xF92EDE4A,
+    0x03C620B3, 0x8BA2B9E0, 0x2E84DD61, 0xB933FF06, 0xC483DBDF, 0x670EC73C, 0xE522CBAD, 0x1E077002,
+    0x5713304B, 0x95C5FAD8, 0xA59D4139, 0xEFBA6D3E, 0xA5F1C9F7, 0xFBF230B4, 0x6A010A05, 0x522672BA,
+    0xDF8E94E3, 0x4F9B84D0, 0x817A3211, 0xB6A93C76, 0x6675BD0F, 0xCF04532C, 0xEBA0055D, 0x0E20C672,
+    0x0ABCAE7B
+  }
+};
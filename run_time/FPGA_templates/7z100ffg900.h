@@ -29,4 +29,11 @@ extern const u32 fpga[MAX_ROWS][MAX_COLUMNS][2];
 
 extern const u32 fpga_bram[MAX_ROWS][MAX_COLUMNS];
 
+// Prefix hashes of the column types of each row. The hash of the columns
+// [first, first + width) of a row is
+// fpga_column_hash[row][first + width] - fpga_column_hash[row][first] * COLUMN_HASH_BASE^width
+// (32-bit arithmetic) and it is used to find relocatable regions
+#define COLUMN_HASH_BASE 37
+extern const u32 fpga_column_hash[MAX_ROWS][MAX_COLUMNS + 1];
+
 #endif
@@ -161,6 +161,22 @@ proc find_resource_type {tile_type} {
   return $resource_type
 }
 
+# Returns the value of the *_TYPE definition of a resource
+proc find_resource_type_number {resource} {
+  switch -exact -- $resource {
+    CLB_L {return 0}
+    CLB_M {return 1}
+    DSP {return 2}
+    BRAM {return 3}
+    IOBA {return 4}
+    IOBB {return 5}
+    CLK {return 6}
+    CFG {return 7}
+    GT {return 8}
+    default {return 0}
+  }
+}
+
 proc write_run_time_description {file_path resource_list row_order_list first_top_row max_column} {
   set device [get_parts -of_objects [get_projects]]
   set fpga_name [string range $device 2 [expr [string length $device] - 3]]
@@ -284,6 +300,26 @@ proc write_run_time_description {file_path resource_list row_order_list first_to
   }
   puts $file_c "\};"
   
+  # We write the prefix hashes of the column types of each row
+  puts $file_c ""
+  puts $file_c "// Prefix hashes of the column types of each row (see COLUMN_HASH_BASE)"
+  puts $file_c "const u32 fpga_column_hash\[MAX_ROWS\]\[MAX_COLUMNS + 1\] = \{"
+  for {set i 0} {$i < [llength $resource_list]} {incr i} {
+    set row_resources_expanded [lindex $resource_list $i]
+    set hash 0
+    puts -nonewline $file_c "  \{0x00000000"
+    for {set j 0} {$j < [llength $row_resources_expanded]} {incr j} {
+      set hash [expr {($hash * 37 + [find_resource_type_number [lindex $row_resources_expanded $j]] + 1) & 0xFFFFFFFF}]
+      puts -nonewline $file_c ", [format 0x%08X $hash]"
+    }
+    if {[expr $i + 1] == [llength $resource_list]} {
+      puts $file_c "\}"
+    } else {
+      puts $file_c "\},"
+    }
+  }
+  puts $file_c "\};"
+  
   flush $file_c
   close $file_c
   
@@ -296,20 +332,20 @@ proc write_run_time_description {file_path resource_list row_order_list first_to
   puts $file_h "#include \"series7.h\""
   puts $file_h "#include \"xil_types.h\""
   puts $file_h ""
-  puts $file_c "// BRAM content definitions"
-  puts $file_c "#define BRAM_CONTENT   1"
-  puts $file_c "#define BRAM_NOCONTENT 0"
+  puts $file_h "// BRAM content definitions"
+  puts $file_h "#define BRAM_CONTENT   1"
+  puts $file_h "#define BRAM_NOCONTENT 0"
   puts $file_h ""
-  puts $file_c "// Block type definition"
-  puts $file_c "#define CLB_L_TYPE 		0"
-  puts $file_c "#define CLB_M_TYPE 		1"
-  puts $file_c "#define DSP_TYPE 			2"
-  puts $file_c "#define BRAM_TYPE 		3"
-  puts $file_c "#define IOBA_TYPE 		4"
-  puts $file_c "#define IOBB_TYPE 		5"
-  puts $file_c "#define CLK_TYPE 			6"
-  puts $file_c "#define CFG_TYPE			7"
-  puts $file_c "#define GT_TYPE 			8"
+  puts $file_h "// Block type definition"
+  puts $file_h "#define CLB_L_TYPE 		0"
+  puts $file_h "#define CLB_M_TYPE 		1"
+  puts $file_h "#define DSP_TYPE 			2"
+  puts $file_h "#define BRAM_TYPE 		3"
+  puts $file_h "#define IOBA_TYPE 		4"
+  puts $file_h "#define IOBB_TYPE 		5"
+  puts $file_h "#define CLK_TYPE 			6"
+  puts $file_h "#define CFG_TYPE			7"
+  puts $file_h "#define GT_TYPE 			8"
   puts $file_h ""
   puts $file_h "#define MAX_ROWS    [llength $row_order_list]"
   puts $file_h "#define MAX_COLUMNS $max_column"
@@ -320,6 +356,13 @@ proc write_run_time_description {file_path resource_list row_order_list first_to
   puts $file_h ""
   puts $file_h "extern const u32 fpga_bram\[MAX_ROWS\]\[MAX_COLUMNS\];"
   puts $file_h ""
+  puts $file_h "// Prefix hashes of the column types of each row. The hash of the columns"
+  puts $file_h "// \[first, first + width) of a row is"
+  puts $file_h "// fpga_column_hash\[row\]\[first + width\] - fpga_column_hash\[row\]\[first\] * COLUMN_HASH_BASE^width"
+  puts $file_h "// (32-bit arithmetic) and it is used to find relocatable regions"
+  puts $file_h "#define COLUMN_HASH_BASE 37"
+  puts $file_h "extern const u32 fpga_column_hash\[MAX_ROWS\]\[MAX_COLUMNS + 1\];"
+  puts $file_h ""
   puts $file_h "#endif"
   
   flush $file_h
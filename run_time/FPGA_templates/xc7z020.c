@@ -463,4 +463,44 @@ const u32 fpga_bram[MAX_ROWS][MAX_COLUMNS] = {
 		content(BRAM_NOCONTENT, 0),
 		content(BRAM_NOCONTENT, 0)
 	}
-};
\ No newline at end of file
+};
+
+// Prefix hashes of the column types of each row (see COLUMN_HASH_BASE)
+const u32 fpga_column_hash[MAX_ROWS][MAX_COLUMNS + 1] = {
+	{
+		0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+		0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+		0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+		0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AA,
+		0x986FE594, 0x082C2E65, 0x2E62B4A0, 0xB4441B22, 0x0DD7EBEB, 0x003518FB, 0x07AC9C49, 0x1BF2968E,
+		0x0A0FC288, 0x74471DA9, 0xCE47496F, 0xD04D9D0C, 0x1B37B2BE, 0xEF0CD577, 0x8CDADA34, 0x5BA18985,
+		0x3E58E03A, 0x02D86863, 0x69471650, 0x37463998, 0xFD2652F9, 0x9689FDFF, 0xC1F1B5DC, 0x07EF48CE,
+		0x259585C7, 0x6E9C55C7, 0xFC9865C5, 0x8206B57B, 0xCAF83ACA, 0x55E07F34, 0x69726286, 0x3D883D60,
+		0xE4B0DEE2, 0x0D9036AD, 0xF5D7E703, 0x88346371, 0xAF925F59, 0x6027C7DE, 0xE5BFE318, 0x34BBD279,
+		0x9F256B7F, 0x00688961, 0x0F1BDB0A
+	},
+	{
+		0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+		0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+		0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+		0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AA,
+		0x986FE594, 0x082C2E65, 0x2E62B4A0, 0xB4441B22, 0x0DD7EBEB, 0x003518FB, 0x07AC9C49, 0x1BF2968E,
+		0x0A0FC288, 0x74471DA9, 0xCE47496F, 0xD04D9D0C, 0x1B37B2BE, 0xEF0CD577, 0x8CDADA34, 0x5BA18985,
+		0x3E58E03A, 0x02D86863, 0x69471650, 0x37463998, 0xFD2652F9, 0x9689FDFF, 0xC1F1B5DC, 0x07EF48CE,
+		0x259585C7, 0x6E9C55C7, 0xFC9865C5, 0x8206B57B, 0xCAF83ACA, 0x55E07F34, 0x69726286, 0x3D883D60,
+		0xE4B0DEE2, 0x0D9036AD, 0xF5D7E703, 0x88346371, 0xAF925F59, 0x6027C7DE, 0xE5BFE318, 0x34BBD279,
+		0x9F256B7F, 0x00688961, 0x0F1BDB0A
+	},
+	{
+		0x00000000, 0x00000005, 0x000000BF, 0x00001B9D, 0x0003FDB3, 0x0093AAE1, 0x1557B287, 0x15ACCD87,
+		0x21F9B485, 0xE917173B, 0xB0565B8A, 0x7C7B3AF4, 0xFDCF8546, 0xAEFE4320, 0x4ABFB3A2, 0xCDB4F66D,
+		0xBB279DC3, 0x0CB9CD31, 0xD6DAA819, 0x0D9A4B9E, 0xF74CEDD8, 0xBE1E6039, 0x7A63E83F, 0xB070911F,
+		0x8044F97D, 0x89F80F13, 0xF0DA2DC2, 0xCF889D0C, 0xFEBEB2BE, 0xD18FD577, 0x49C9DA35, 0xAA2C89AA,
+		0x986FE594, 0x082C2E65, 0x2E62B4A0, 0xB4441B22, 0x0DD7EBEB, 0x003518FB, 0x07AC9C49, 0x1BF2968E,
+		0x0A0FC288, 0x74471DA9, 0xCE47496F, 0xD04D9D0C, 0x1B37B2BE, 0xEF0CD577, 0x8CDADA34, 0x5BA18985,
+		0x3E58E03A, 0x02D86863, 0x69471650, 0x37463998, 0xFD2652F9, 0x9689FDFF, 0xC1F1B5DC, 0x07EF48CE,
+		0x259585C7, 0x6E9C55C7, 0xFC9865C5, 0x8206B57B, 0xCAF83ACA, 0x55E07F34, 0x69726286, 0x3D883D60,
+		0xE4B0DEE2, 0x0D9036AD, 0xF5D7E703, 0x88346371, 0xAF925F59, 0x6027C7DE, 0xE5BFE318, 0x34BBD279,
+		0x9F256B7F, 0x00688961, 0x0F1BDB0A
+	}
+};
@@ -0,0 +1,65 @@
+#include <stdint.h>
+#include <stddef.h>
+#include "IMPRESS_command_ring.h"
+
+/* Function definitions*/
+void init_command_ring(command_ring_t *ring) {
+  int i;
+
+  ring->head = 0;
+  ring->tail = 0;
+  for (i = 0; i < COMMAND_RING_SIZE; i++) {
+    ring->status[i] = 0;
+  }
+  COMMAND_RING_BARRIER();
+}
+
+int command_ring_push(command_ring_t *ring, const ring_command_t *command, uint32_t *ticket) {
+  uint32_t head = ring->head;
+
+  // The counters are free running, so their difference is valid when they wrap
+  if (head - ring->tail >= COMMAND_RING_SIZE) {
+    return 0;
+  }
+  // The position is only reused after the consumer has finished with it
+  COMMAND_RING_BARRIER();
+  ring->commands[head & (COMMAND_RING_SIZE - 1)] = *command;
+  // The consumer cannot see the new head before the command
+  COMMAND_RING_BARRIER();
+  ring->head = head + 1;
+  *ticket = head;
+  return 1;
+}
+
+int command_ring_is_done(command_ring_t *ring, uint32_t ticket, int32_t *status) {
+  if ((int32_t) (ring->tail - ticket) <= 0) {
+    return 0;
+  }
+  // The status is written before the tail
+  COMMAND_RING_BARRIER();
+  if (status != NULL) {
+    *status = ring->status[ticket & (COMMAND_RING_SIZE - 1)];
+  }
+  return 1;
+}
+
+int command_ring_peek(command_ring_t *ring, ring_command_t *command) {
+  uint32_t tail = ring->tail;
+
+  if (ring->head == tail) {
+    return 0;
+  }
+  // The command is written before the head
+  COMMAND_RING_BARRIER();
+  *command = ring->commands[tail & (COMMAND_RING_SIZE - 1)];
+  return 1;
+}
+
+void command_ring_complete(command_ring_t *ring, int32_t status) {
+  uint32_t tail = ring->tail;
+
+  ring->status[tail & (COMMAND_RING_SIZE - 1)] = status;
+  // The producer cannot see the new tail before the status
+  COMMAND_RING_BARRIER();
+  ring->tail = tail + 1;
+}
@@ -0,0 +1,110 @@
+#ifndef IMPRESS_COMMAND_RING
+#define IMPRESS_COMMAND_RING
+
+#include <stdint.h>
+
+// Single-producer single-consumer ring used to send commands from one core
+// (producer) to another core (consumer) without locks. It only depends on
+// stdint.h so that the protocol can be tested in a host with two threads.
+#ifndef COMMAND_RING_SIZE
+  #define COMMAND_RING_SIZE             16 // Must be a power of 2
+#endif
+#if COMMAND_RING_SIZE & (COMMAND_RING_SIZE - 1)
+  #error "COMMAND_RING_SIZE must be a power of 2"
+#endif
+#ifndef COMMAND_RING_ARGS
+  #define COMMAND_RING_ARGS             8
+#endif
+#define COMMAND_RING_LINE_WORDS         8 // Words of a cache line (head and tail are kept in different lines)
+
+// Memory barrier between the accesses to a command and to the head or tail
+#ifndef COMMAND_RING_BARRIER
+  #if defined(__arm__)
+    #define COMMAND_RING_BARRIER()      __asm__ __volatile__ ("dmb" : : : "memory")
+  #else
+    #define COMMAND_RING_BARRIER()      __sync_synchronize()
+  #endif
+#endif
+
+typedef struct {
+  uint32_t type;
+  int32_t args[COMMAND_RING_ARGS];
+} ring_command_t;
+
+typedef struct {
+  volatile uint32_t head; // Commands submitted. Only written by the producer
+  uint32_t head_padding[COMMAND_RING_LINE_WORDS - 1];
+  volatile uint32_t tail; // Commands completed. Only written by the consumer
+  uint32_t tail_padding[COMMAND_RING_LINE_WORDS - 1];
+  ring_command_t commands[COMMAND_RING_SIZE];
+  volatile int32_t status[COMMAND_RING_SIZE]; // Result of each completed command
+} command_ring_t;
+
+/****************************************************************************/
+/**
+*
+* Empties a command ring. It must be called before the consumer starts
+* reading the ring.
+*
+* @param ring: ring to initialize
+* @return   none
+*
+*****************************************************************************/
+void init_command_ring(command_ring_t *ring);
+/****************************************************************************/
+/**
+*
+* Adds a command to the ring. It can only be called by the producer.
+*
+* @param ring:
+* @param command: command to copy into the ring
+* @param ticket: returns the identifier used to check if the command has been
+*        completed
+* @return   1 if the command has been added else 0 if the ring is full
+*
+*****************************************************************************/
+int command_ring_push(command_ring_t *ring, const ring_command_t *command, uint32_t *ticket);
+/****************************************************************************/
+/**
+*
+* Checks if a command submitted with command_ring_push() has been completed.
+* It can only be called by the producer. The status of a command is
+* overwritten when the command with ticket + COMMAND_RING_SIZE is completed, so
+* it must be read before COMMAND_RING_SIZE more commands are submitted.
+*
+* @param ring:
+* @param ticket: identifier returned by command_ring_push()
+* @param status: returns the value given to command_ring_complete() (it can
+*        be NULL)
+* @return   1 if the command has been completed else 0
+*
+*****************************************************************************/
+int command_ring_is_done(command_ring_t *ring, uint32_t ticket, int32_t *status);
+/****************************************************************************/
+/**
+*
+* Returns the oldest command that has not been completed. The command stays in
+* the ring until command_ring_complete() is called, so that the producer cannot
+* reuse its position while it is being executed. It can only be called by the
+* consumer.
+*
+* @param ring:
+* @param command: returns a copy of the command
+* @return   1 if there is a command else 0 if the ring is empty
+*
+*****************************************************************************/
+int command_ring_peek(command_ring_t *ring, ring_command_t *command);
+/****************************************************************************/
+/**
+*
+* Marks the command returned by command_ring_peek() as completed. It can only
+* be called by the consumer.
+*
+* @param ring:
+* @param status: result of the command
+* @return   none
+*
+*****************************************************************************/
+void command_ring_complete(command_ring_t *ring, int32_t status);
+
+#endif
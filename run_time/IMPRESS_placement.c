@@ -0,0 +1,639 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "IMPRESS_placement.h"
+#include "series7.h"
+#include "xc7z020.h"
+#include <xstatus.h>
+
+#define X_POS                               0
+#define Y_POS                               1
+#define WIDTH_POS                           0
+#define HEIGHT_POS                          1
+#define ROWS_PER_BRAM_TILE                  5 // BRAM and DSP tiles span 5 CLB rows
+
+struct relocation_index_entry {
+  uint32_t hash;
+  uint16_t width;
+  uint16_t row;
+  uint16_t column;
+};
+
+// Visit of the positions of the FPGA compatible with an element, from the
+// bottom-left corner, with the entries of the relocation index
+typedef struct {
+  element_info_t *element;
+  int hash_entry;     // First entry with the signature of the element
+  int row_entry;      // First entry of the clock region row being visited
+  int next_row_entry; // First entry of the next clock region row
+  int position_y;
+  int entry;
+} position_iterator_t;
+
+/* Function declarations*/
+static uint32_t column_types_hash(int row, int first_column, int width);
+static int compare_relocation_index_entries(const void *a, const void *b);
+static int find_first_index_entry(reconfiguration_engine_t *engine, uint32_t hash, int width);
+static int init_position_iterator(reconfiguration_engine_t *engine, element_info_t *element, position_iterator_t *iterator);
+static int next_compatible_position(reconfiguration_engine_t *engine, position_iterator_t *iterator, int position[2]);
+static int is_position_compatible(element_info_t *element, int position_x, int position_y);
+static int is_position_free(virtual_architecture_t *virtual_architecture, int x, int y, int x0, int y0, int xf, int yf);
+static int regions_overlap(int x0, int y0, int xf, int yf, pblock region);
+static int has_tile_columns(element_info_t *element);
+static int can_move_element(virtual_architecture_t *virtual_architecture, int x, int y, element_info_t *element, int position_x, int position_y);
+static void element_region(element_info_t *element, int position_x, int position_y, pblock *region);
+static int relocation_frames(int element_info, int position_x, int position_y);
+static int plan_position_moves(virtual_architecture_t *virtual_architecture, defragmentation_plan_t *plan);
+static int plan_move_position(virtual_architecture_t *virtual_architecture, defragmentation_plan_t *plan, int move);
+
+/* Function definitions*/
+int reserve_placement_region(reconfiguration_engine_t *engine, pblock region) {
+  if (engine->num_reserved_regions >= MAX_RESERVED_REGIONS) {
+    return XST_FAILURE;
+  }
+  engine->reserved_regions[engine->num_reserved_regions++] = region;
+  return XST_SUCCESS;
+}
+
+void clear_reserved_placement_regions(reconfiguration_engine_t *engine) {
+  engine->num_reserved_regions = 0;
+}
+
+int init_relocation_index(reconfiguration_engine_t *engine) {
+  int widths[NUM_ELEMENTS];
+  int num_widths = 0;
+  int i, j, row, column;
+  int entries;
+
+  if (engine->relocation_index != NULL) {
+    return XST_SUCCESS;
+  }
+
+  // Only the widths of the elements are indexed
+  for (i = 0; i < NUM_ELEMENTS; i++) {
+    for (j = 0; j < num_widths; j++) {
+      if (widths[j] == elements[i].size[WIDTH_POS]) {
+        break;
+      }
+    }
+    if (j == num_widths && elements[i].size[WIDTH_POS] > 0 && elements[i].size[WIDTH_POS] <= MAX_COLUMNS) {
+      widths[num_widths++] = elements[i].size[WIDTH_POS];
+    }
+  }
+
+  entries = 0;
+  for (j = 0; j < num_widths; j++) {
+    entries += MAX_ROWS * (MAX_COLUMNS - widths[j] + 1);
+  }
+  engine->relocation_index = malloc(entries * sizeof(relocation_index_entry_t));
+  if (engine->relocation_index == NULL) {
+    return XST_FAILURE;
+  }
+
+  engine->relocation_index_entries = 0;
+  for (j = 0; j < num_widths; j++) {
+    for (row = 0; row < MAX_ROWS; row++) {
+      for (column = 0; column + widths[j] <= MAX_COLUMNS; column++) {
+        engine->relocation_index[engine->relocation_index_entries].hash = column_types_hash(row, column, widths[j]);
+        engine->relocation_index[engine->relocation_index_entries].width = widths[j];
+        engine->relocation_index[engine->relocation_index_entries].row = row;
+        engine->relocation_index[engine->relocation_index_entries].column = column;
+        engine->relocation_index_entries++;
+      }
+    }
+  }
+  // The entries with the same signature are sorted by row and column so that the
+  // positions are visited from the bottom-left corner
+  qsort(engine->relocation_index, engine->relocation_index_entries, sizeof(relocation_index_entry_t), compare_relocation_index_entries);
+
+  return XST_SUCCESS;
+}
+
+int find_partition_position(virtual_architecture_t *virtual_architecture, int x, int y, int element_info, placement_policy_t policy, int preferred_clock_row, int position[2]) {
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  element_info_t *element = &elements[element_info];
+  position_iterator_t iterator;
+  int width, height;
+  int candidate[2];
+  int frames, best_frames;
+  int found = 0;
+
+  width = element->size[WIDTH_POS];
+  height = element->size[HEIGHT_POS];
+  best_frames = 0;
+
+  if (init_position_iterator(engine, element, &iterator) != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  while (next_compatible_position(engine, &iterator, candidate)) {
+    if (!is_position_free(virtual_architecture, x, y, candidate[X_POS], candidate[Y_POS], candidate[X_POS] + width - 1, candidate[Y_POS] + height - 1)) {
+      continue;
+    }
+
+    switch (policy) {
+      case minimize_frames:
+        frames = placement_frames(element_info, candidate[X_POS], candidate[Y_POS]);
+        if (!found || frames < best_frames) {
+          best_frames = frames;
+          position[X_POS] = candidate[X_POS];
+          position[Y_POS] = candidate[Y_POS];
+        }
+        found = 1;
+        break;
+      case same_clock_row:
+        if (candidate[Y_POS] / ROWS_PER_CLOCK_REGION == preferred_clock_row && (candidate[Y_POS] + height - 1) / ROWS_PER_CLOCK_REGION == preferred_clock_row) {
+          position[X_POS] = candidate[X_POS];
+          position[Y_POS] = candidate[Y_POS];
+          return XST_SUCCESS;
+        }
+        // The first compatible position is kept in case there is no space in the preferred row
+        if (!found) {
+          position[X_POS] = candidate[X_POS];
+          position[Y_POS] = candidate[Y_POS];
+        }
+        found = 1;
+        break;
+      case first_fit:
+      default:
+        position[X_POS] = candidate[X_POS];
+        position[Y_POS] = candidate[Y_POS];
+        return XST_SUCCESS;
+    }
+  }
+
+  if (found) {
+    return XST_SUCCESS;
+  }
+  return XST_FAILURE;
+}
+
+int place_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int element_info, placement_policy_t policy, int preferred_clock_row) {
+  int position[2];
+  int status;
+
+  status = find_partition_position(virtual_architecture, x, y, element_info, policy, preferred_clock_row, position);
+  if (status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+
+  change_partition_position(virtual_architecture, x, y, position[X_POS], position[Y_POS]);
+  return change_partition_element(virtual_architecture, x, y, element_info);
+}
+
+int plan_defragmentation(virtual_architecture_t *virtual_architecture, int x, int y, int element_info, defragmentation_plan_t *plan) {
+  position_iterator_t iterator;
+  defragmentation_plan_t candidate;
+  int found = 0;
+
+  if (element_info < 0 || element_info >= NUM_ELEMENTS) {
+    return XST_FAILURE;
+  }
+  if (init_position_iterator(virtual_architecture->engine, &elements[element_info], &iterator) != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  candidate.x = x;
+  candidate.y = y;
+  candidate.element_info = element_info;
+  while (next_compatible_position(virtual_architecture->engine, &iterator, candidate.position)) {
+    if (plan_position_moves(virtual_architecture, &candidate) != XST_SUCCESS) {
+      continue;
+    }
+    candidate.placement_frames = placement_frames(element_info, candidate.position[X_POS], candidate.position[Y_POS]);
+    if (!found || candidate.move_frames + candidate.placement_frames < plan->move_frames + plan->placement_frames
+        || (candidate.move_frames + candidate.placement_frames == plan->move_frames + plan->placement_frames && candidate.num_moves < plan->num_moves)) {
+      *plan = candidate;
+      found = 1;
+    }
+  }
+
+  if (found) {
+    return XST_SUCCESS;
+  }
+  return XST_FAILURE;
+}
+
+int execute_defragmentation(virtual_architecture_t *virtual_architecture, defragmentation_plan_t *plan) {
+  int i, status;
+
+  for (i = 0; i < plan->num_moves; i++) {
+    status = relocate_partition_element(virtual_architecture, plan->moves[i].x, plan->moves[i].y, plan->moves[i].position[X_POS], plan->moves[i].position[Y_POS]);
+    if (status != XST_SUCCESS) {
+      return XST_FAILURE;
+    }
+  }
+  change_partition_position(virtual_architecture, plan->x, plan->y, plan->position[X_POS], plan->position[Y_POS]);
+  return change_partition_element(virtual_architecture, plan->x, plan->y, plan->element_info);
+}
+
+/*
+* write_subclock_region_PBS() reconfigures all the frames of the columns of each
+* clock region row of the element
+*/
+int placement_frames(int element_info, int position_x, int position_y) {
+  element_info_t *element = &elements[element_info];
+  int first_clock_row, last_clock_row;
+  int row, column;
+  int frames = 0;
+
+  first_clock_row = position_y / ROWS_PER_CLOCK_REGION;
+  last_clock_row = (position_y + element->size[HEIGHT_POS] - 1) / ROWS_PER_CLOCK_REGION;
+  for (row = first_clock_row; row <= last_clock_row; row++) {
+    for (column = position_x; column < position_x + element->size[WIDTH_POS]; column++) {
+      frames += fpga[row][column][0] & 0xFFFF;
+    }
+  }
+  return frames;
+}
+
+int migrate_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int new_x, int new_y) {
+  element_info_t *element = virtual_architecture->partition[x][y].element.element_info;
+  element_state_t state;
+  int status;
+
+  if (element == NULL || (x == new_x && y == new_y)) {
+    return XST_FAILURE;
+  }
+  // An element running in the other partition would be overwritten
+  if (virtual_architecture->partition[new_x][new_y].element.element_info != NULL) {
+    return XST_FAILURE;
+  }
+  // No partition is considered free: the actual position of the element is occupied until it has been moved
+  if (!can_move_element(virtual_architecture, -1, -1, element, virtual_architecture->partition[new_x][new_y].position[X_POS], virtual_architecture->partition[new_x][new_y].position[Y_POS])) {
+    return XST_FAILURE;
+  }
+
+  status = capture_partition_state(virtual_architecture, x, y, &state);
+  if (status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  status = restore_partition_state(virtual_architecture, new_x, new_y, &state);
+  release_partition_state(&state);
+  if (status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  virtual_architecture->partition[x][y].element.element_info = NULL;
+  return XST_SUCCESS;
+}
+
+int relocate_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int position_x, int position_y) {
+  element_info_t *element = virtual_architecture->partition[x][y].element.element_info;
+  element_state_t state;
+  int old_position_x, old_position_y;
+  int status;
+
+  if (element == NULL || !can_move_element(virtual_architecture, x, y, element, position_x, position_y)) {
+    return XST_FAILURE;
+  }
+  old_position_x = virtual_architecture->partition[x][y].position[X_POS];
+  old_position_y = virtual_architecture->partition[x][y].position[Y_POS];
+
+  status = capture_partition_state(virtual_architecture, x, y, &state);
+  if (status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  change_partition_position(virtual_architecture, x, y, position_x, position_y);
+  status = restore_partition_state(virtual_architecture, x, y, &state);
+  if (status != XST_SUCCESS) {
+    // The element is written again in its position from the state
+    change_partition_position(virtual_architecture, x, y, old_position_x, old_position_y);
+    restore_partition_state(virtual_architecture, x, y, &state);
+  }
+  release_partition_state(&state);
+  return status;
+}
+
+static int init_position_iterator(reconfiguration_engine_t *engine, element_info_t *element, position_iterator_t *iterator) {
+  int width = element->size[WIDTH_POS];
+  int origin_row;
+
+  if (init_relocation_index(engine) != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  origin_row = element->PBS_origin[Y_POS] / ROWS_PER_CLOCK_REGION;
+  if (origin_row >= MAX_ROWS || element->PBS_origin[X_POS] + width > MAX_COLUMNS) {
+    return XST_FAILURE;
+  }
+  iterator->hash_entry = find_first_index_entry(engine, column_types_hash(origin_row, element->PBS_origin[X_POS], width), width);
+  if (iterator->hash_entry < 0) {
+    return XST_FAILURE;
+  }
+  iterator->element = element;
+  iterator->row_entry = iterator->hash_entry;
+  iterator->next_row_entry = -1;
+  return XST_SUCCESS;
+}
+
+/*
+* Each entry is a column with the same signature in the first clock region row of the
+* element. The rest of the rows, the vertical alignment and the hash collisions are
+* checked by is_position_compatible(). It returns 0 when all the positions have been
+* visited.
+*/
+static int next_compatible_position(reconfiguration_engine_t *engine, position_iterator_t *iterator, int position[2]) {
+  relocation_index_entry_t *index = engine->relocation_index;
+  int width = iterator->element->size[WIDTH_POS];
+  int row;
+
+  while (iterator->row_entry < engine->relocation_index_entries && index[iterator->row_entry].hash == index[iterator->hash_entry].hash && index[iterator->row_entry].width == width) {
+    row = index[iterator->row_entry].row;
+    if (iterator->next_row_entry == -1) {
+      iterator->next_row_entry = iterator->row_entry;
+      while (iterator->next_row_entry < engine->relocation_index_entries && index[iterator->next_row_entry].hash == index[iterator->hash_entry].hash && index[iterator->next_row_entry].width == width && index[iterator->next_row_entry].row == row) {
+        iterator->next_row_entry++;
+      }
+      iterator->position_y = row * ROWS_PER_CLOCK_REGION;
+      iterator->entry = iterator->row_entry;
+    }
+    for (; iterator->position_y < (row + 1) * ROWS_PER_CLOCK_REGION; iterator->position_y++, iterator->entry = iterator->row_entry) {
+      while (iterator->entry < iterator->next_row_entry) {
+        position[X_POS] = index[iterator->entry++].column;
+        position[Y_POS] = iterator->position_y;
+        if (is_position_compatible(iterator->element, position[X_POS], position[Y_POS])) {
+          return 1;
+        }
+      }
+    }
+    iterator->row_entry = iterator->next_row_entry;
+    iterator->next_row_entry = -1;
+  }
+  return 0;
+}
+
+static int is_position_compatible(element_info_t *element, int position_x, int position_y) {
+  int width, height;
+  int origin_x, origin_y, origin_row;
+  int first_clock_row, last_clock_row;
+  int row, i;
+
+  width = element->size[WIDTH_POS];
+  height = element->size[HEIGHT_POS];
+  origin_x = element->PBS_origin[X_POS];
+  origin_y = element->PBS_origin[Y_POS];
+  origin_row = origin_y / ROWS_PER_CLOCK_REGION;
+
+  if (position_x < 0 || position_x + width > MAX_COLUMNS || position_y < 0 || position_y + height > MAX_ROWS * ROWS_PER_CLOCK_REGION) {
+    return 0;
+  }
+
+  // BRAM and DSP tiles cannot be split
+  if (has_tile_columns(element) && ((position_y - origin_y) % ROWS_PER_BRAM_TILE) != 0) {
+    return 0;
+  }
+
+  first_clock_row = position_y / ROWS_PER_CLOCK_REGION;
+  last_clock_row = (position_y + height - 1) / ROWS_PER_CLOCK_REGION;
+
+  // If the PBS is stored clock region row by clock region row the rows of the element
+  // have to be distributed in the same way between the clock region rows
+  if (!element->PBS_contiguous_frames) {
+    if (origin_row != (origin_y + height - 1) / ROWS_PER_CLOCK_REGION || first_clock_row != last_clock_row) {
+      if ((position_y % ROWS_PER_CLOCK_REGION) != (origin_y % ROWS_PER_CLOCK_REGION)) {
+        return 0;
+      }
+    }
+  }
+
+  for (row = first_clock_row; row <= last_clock_row; row++) {
+    for (i = 0; i < width; i++) {
+      if (fpga[row][position_x + i][1] != fpga[origin_row][origin_x + i][1]) {
+        return 0;
+      }
+      if ((fpga[row][position_x + i][0] & 0xFFFF) != (fpga[origin_row][origin_x + i][0] & 0xFFFF)) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+static int is_position_free(virtual_architecture_t *virtual_architecture, int x, int y, int x0, int y0, int xf, int yf) {
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  pblock partition_region;
+  element_info_t *element_info;
+  int i, j;
+
+  for (i = 0; i < engine->num_reserved_regions; i++) {
+    if (regions_overlap(x0, y0, xf, yf, engine->reserved_regions[i])) {
+      return 0;
+    }
+  }
+
+  for (i = 0; i < virtual_architecture->width; i++) {
+    for (j = 0; j < virtual_architecture->height; j++) {
+      element_info = virtual_architecture->partition[i][j].element.element_info;
+      if ((i == x && j == y) || element_info == NULL) {
+        continue;
+      }
+      partition_region.X0 = virtual_architecture->partition[i][j].position[X_POS];
+      partition_region.Y0 = virtual_architecture->partition[i][j].position[Y_POS];
+      partition_region.Xf = partition_region.X0 + element_info->size[WIDTH_POS] - 1;
+      partition_region.Yf = partition_region.Y0 + element_info->size[HEIGHT_POS] - 1;
+      if (regions_overlap(x0, y0, xf, yf, partition_region)) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+/*
+* The state of an element can be restored in the positions where its PBS can be
+* relocated. Partition x, y is considered free.
+*/
+static int can_move_element(virtual_architecture_t *virtual_architecture, int x, int y, element_info_t *element, int position_x, int position_y) {
+  if (!is_position_compatible(element, position_x, position_y)) {
+    return 0;
+  }
+  return is_position_free(virtual_architecture, x, y, position_x, position_y, position_x + element->size[WIDTH_POS] - 1, position_y + element->size[HEIGHT_POS] - 1);
+}
+
+static void element_region(element_info_t *element, int position_x, int position_y, pblock *region) {
+  region->X0 = position_x;
+  region->Y0 = position_y;
+  region->Xf = position_x + element->size[WIDTH_POS] - 1;
+  region->Yf = position_y + element->size[HEIGHT_POS] - 1;
+}
+
+/*
+* Frames written by relocate_partition_element(): the frames of the columns of
+* each clock region row and the BRAM content frames of the BRAM columns
+*/
+static int relocation_frames(int element_info, int position_x, int position_y) {
+  element_info_t *element = &elements[element_info];
+
+  return placement_frames(element_info, position_x, position_y)
+         + PCAP_BRAM_content_frames(position_x, position_y / ROWS_PER_CLOCK_REGION, position_x + element->size[WIDTH_POS] - 1, (position_y + element->size[HEIGHT_POS] - 1) / ROWS_PER_CLOCK_REGION);
+}
+
+/*
+* Finds the elements that overlap the position of the plan and a new position for
+* each of them, the biggest elements first
+*/
+static int plan_position_moves(virtual_architecture_t *virtual_architecture, defragmentation_plan_t *plan) {
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  defragmentation_move_t move;
+  element_info_t *element_info;
+  pblock target, region;
+  int i, j;
+
+  element_region(&elements[plan->element_info], plan->position[X_POS], plan->position[Y_POS], &target);
+  for (i = 0; i < engine->num_reserved_regions; i++) {
+    if (regions_overlap(target.X0, target.Y0, target.Xf, target.Yf, engine->reserved_regions[i])) {
+      return XST_FAILURE;
+    }
+  }
+
+  plan->num_moves = 0;
+  plan->move_frames = 0;
+  for (i = 0; i < virtual_architecture->width; i++) {
+    for (j = 0; j < virtual_architecture->height; j++) {
+      element_info = virtual_architecture->partition[i][j].element.element_info;
+      if ((i == plan->x && j == plan->y) || element_info == NULL) {
+        continue;
+      }
+      element_region(element_info, virtual_architecture->partition[i][j].position[X_POS], virtual_architecture->partition[i][j].position[Y_POS], &region);
+      if (!regions_overlap(target.X0, target.Y0, target.Xf, target.Yf, region)) {
+        continue;
+      }
+      if (plan->num_moves >= DEFRAGMENTATION_MAX_MOVES) {
+        return XST_FAILURE;
+      }
+      plan->moves[plan->num_moves].x = i;
+      plan->moves[plan->num_moves].y = j;
+      // The frames of the actual position sort the moves by size
+      plan->moves[plan->num_moves].frames = relocation_frames(element_info - elements, virtual_architecture->partition[i][j].position[X_POS], virtual_architecture->partition[i][j].position[Y_POS]);
+      plan->num_moves++;
+    }
+  }
+
+  for (i = 1; i < plan->num_moves; i++) {
+    move = plan->moves[i];
+    for (j = i; j > 0 && plan->moves[j - 1].frames < move.frames; j--) {
+      plan->moves[j] = plan->moves[j - 1];
+    }
+    plan->moves[j] = move;
+  }
+
+  for (i = 0; i < plan->num_moves; i++) {
+    if (plan_move_position(virtual_architecture, plan, i) != XST_SUCCESS) {
+      return XST_FAILURE;
+    }
+    plan->move_frames += plan->moves[i].frames;
+  }
+  return XST_SUCCESS;
+}
+
+/*
+* Selects the free compatible position that needs less frames for a move of the
+* plan. It must not overlap the actual position of the other elements, the
+* position opened by the plan or the new positions of the previous moves, so the
+* moves can be executed one after the other.
+*/
+static int plan_move_position(virtual_architecture_t *virtual_architecture, defragmentation_plan_t *plan, int move) {
+  defragmentation_move_t *current = &plan->moves[move];
+  element_info_t *element = virtual_architecture->partition[current->x][current->y].element.element_info;
+  position_iterator_t iterator;
+  pblock target, region, previous;
+  int position[2];
+  int frames, i;
+  int found = 0;
+
+  if (init_position_iterator(virtual_architecture->engine, element, &iterator) != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  element_region(&elements[plan->element_info], plan->position[X_POS], plan->position[Y_POS], &target);
+  while (next_compatible_position(virtual_architecture->engine, &iterator, position)) {
+    element_region(element, position[X_POS], position[Y_POS], &region);
+    if (regions_overlap(region.X0, region.Y0, region.Xf, region.Yf, target)) {
+      continue;
+    }
+    for (i = 0; i < move; i++) {
+      element_region(virtual_architecture->partition[plan->moves[i].x][plan->moves[i].y].element.element_info, plan->moves[i].position[X_POS], plan->moves[i].position[Y_POS], &previous);
+      if (regions_overlap(region.X0, region.Y0, region.Xf, region.Yf, previous)) {
+        break;
+      }
+    }
+    if (i < move || !is_position_free(virtual_architecture, current->x, current->y, region.X0, region.Y0, region.Xf, region.Yf)) {
+      continue;
+    }
+    frames = relocation_frames(element - elements, position[X_POS], position[Y_POS]);
+    if (!found || frames < current->frames) {
+      current->frames = frames;
+      current->position[X_POS] = position[X_POS];
+      current->position[Y_POS] = position[Y_POS];
+    }
+    found = 1;
+  }
+
+  if (found) {
+    return XST_SUCCESS;
+  }
+  return XST_FAILURE;
+}
+
+static int regions_overlap(int x0, int y0, int xf, int yf, pblock region) {
+  return !(xf < region.X0 || region.Xf < x0 || yf < region.Y0 || region.Yf < y0);
+}
+
+static int has_tile_columns(element_info_t *element) {
+  int origin_row, i;
+
+  origin_row = element->PBS_origin[Y_POS] / ROWS_PER_CLOCK_REGION;
+  for (i = 0; i < element->size[WIDTH_POS]; i++) {
+    if (fpga[origin_row][element->PBS_origin[X_POS] + i][1] == BRAM_TYPE || fpga[origin_row][element->PBS_origin[X_POS] + i][1] == DSP_TYPE) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+* Hash of the column types of [first_column, first_column + width) obtained from the
+* prefix hashes of the device template
+*/
+static uint32_t column_types_hash(int row, int first_column, int width) {
+  uint32_t base_power = 1;
+  int i;
+
+  for (i = 0; i < width; i++) {
+    base_power *= COLUMN_HASH_BASE;
+  }
+  return fpga_column_hash[row][first_column + width] - fpga_column_hash[row][first_column] * base_power;
+}
+
+static int compare_relocation_index_entries(const void *a, const void *b) {
+  const relocation_index_entry_t *entry_a = a;
+  const relocation_index_entry_t *entry_b = b;
+
+  if (entry_a->width != entry_b->width) {
+    return entry_a->width < entry_b->width ? -1 : 1;
+  }
+  if (entry_a->hash != entry_b->hash) {
+    return entry_a->hash < entry_b->hash ? -1 : 1;
+  }
+  if (entry_a->row != entry_b->row) {
+    return entry_a->row < entry_b->row ? -1 : 1;
+  }
+  return (int) entry_a->column - (int) entry_b->column;
+}
+
+/*
+* Binary search of the first entry of the index with a signature. It returns -1 if
+* there is no entry.
+*/
+static int find_first_index_entry(reconfiguration_engine_t *engine, uint32_t hash, int width) {
+  int low = 0, high = engine->relocation_index_entries;
+  int middle;
+
+  while (low < high) {
+    middle = (low + high) / 2;
+    if (engine->relocation_index[middle].width < width || (engine->relocation_index[middle].width == width && engine->relocation_index[middle].hash < hash)) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  if (low < engine->relocation_index_entries && engine->relocation_index[low].width == width && engine->relocation_index[low].hash == hash) {
+    return low;
+  }
+  return -1;
+}
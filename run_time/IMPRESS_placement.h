@@ -0,0 +1,218 @@
+#ifndef IMPRESS_PLACEMENT
+#define IMPRESS_PLACEMENT
+
+#include "IMPRESS_reconfiguration.h"
+#include "reconfig_pcap.h"
+
+/**
+ * Policies used to select the position of an element among all the compatible
+ * free positions of the FPGA
+ *
+ * [first_fit] First compatible position found (from the bottom-left corner)
+ * [minimize_frames] Position that needs less frames to be reconfigured
+ * [same_clock_row] Position in the preferred clock region row so that it can be
+ * reconfigured together with other elements of that row (see
+ * change_partition_element_stacked_modules()). If there is no position in that
+ * row the first compatible position is used
+ * */
+typedef enum {	first_fit,
+				minimize_frames,
+				same_clock_row} placement_policy_t;
+
+#ifndef DEFRAGMENTATION_MAX_MOVES
+  #define DEFRAGMENTATION_MAX_MOVES     8 // Elements that a defragmentation plan can move
+#endif
+
+// Relocation of an element with relocate_partition_element()
+typedef struct {
+  int x;
+  int y;
+  int position[2];  // New position of the partition
+  int frames;       // Frames written by the relocation (configuration and BRAM)
+} defragmentation_move_t;
+
+/**
+ * Sequence of relocations that opens a position for an element (see
+ * plan_defragmentation()). The predicted cost is the number of frames written:
+ * move_frames by the relocations and placement_frames by the reconfiguration
+ * of the element.
+ */
+typedef struct {
+  int x;            // Partition where the element is placed
+  int y;
+  int element_info;
+  int position[2];  // Position opened for the element
+  defragmentation_move_t moves[DEFRAGMENTATION_MAX_MOVES];
+  int num_moves;
+  int move_frames;
+  int placement_frames;
+} defragmentation_plan_t;
+
+/****************************************************************************/
+/**
+*
+* Marks a region of the FPGA as occupied (e.g. the static system or other
+* reconfigurable regions that are not managed by the virtual architecture) so
+* that no element is placed over it. The positions of the elements allocated in
+* the virtual architecture are always considered occupied.
+*
+* @param engine: engine of the FPGA
+* @param region: region in FPGA coordinates
+* @return   XST_SUCCESS else XST_FAILURE if there is no space for more regions
+*
+*****************************************************************************/
+int reserve_placement_region(reconfiguration_engine_t *engine, pblock region);
+/****************************************************************************/
+/**
+*
+* Removes all the regions reserved with reserve_placement_region()
+*
+* @param engine: engine of the FPGA
+* @return   none
+*
+*****************************************************************************/
+void clear_reserved_placement_regions(reconfiguration_engine_t *engine);
+/****************************************************************************/
+/**
+*
+* Builds the relocation index: for each width of the elements of elements[] it
+* stores the hash of the column types of every possible start column of each
+* clock region row (obtained from fpga_column_hash of the device template) so
+* that the compatible positions of an element are found with a lookup. It is
+* called by find_partition_position() the first time if it was not called
+* before. It is released by release_reconfiguration_engine().
+*
+* @param engine: engine of the FPGA
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int init_relocation_index(reconfiguration_engine_t *engine);
+/****************************************************************************/
+/**
+*
+* Searches a free position of the FPGA where the PBS of an element can be
+* relocated. A position is compatible if it has the same sequence of column
+* types as the position where the PBS was extracted (PBS_origin of the element).
+* Elements with BRAM or DSP columns can only be moved vertically a multiple of
+* the height of a BRAM/DSP tile and the PBS that are not stored with contiguous
+* frames must keep the same position inside the clock region rows. The
+* candidate positions are obtained from the relocation index.
+*
+* @param virtual_architecture:
+* @param x: x coordinate of the partition of the virtual architecture that will
+* host the element (its actual position is considered free)
+* @param y: y coordinate of the partition of the virtual architecture that will
+* host the element
+* @param element_info: position of the element in elements[]
+* @param policy: placement policy
+* @param preferred_clock_row: clock region row used by the same_clock_row policy
+* @param position: returns the position found (X, Y of the down-left corner)
+* @return   XST_SUCCESS else XST_FAILURE if there is no compatible free position
+*
+*****************************************************************************/
+int find_partition_position(virtual_architecture_t *virtual_architecture, int x, int y, int element_info, placement_policy_t policy, int preferred_clock_row, int position[2]);
+/****************************************************************************/
+/**
+*
+* Searches a position for an element with find_partition_position(), moves the
+* partition to that position and reconfigures the element.
+*
+* @param virtual_architecture:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @param element_info: position of the element in elements[]
+* @param policy: placement policy
+* @param preferred_clock_row: clock region row used by the same_clock_row policy
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int place_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int element_info, placement_policy_t policy, int preferred_clock_row);
+/****************************************************************************/
+/**
+*
+* Calculates the number of frames that are written when an element is
+* reconfigured in a position.
+*
+* @param element_info: position of the element in elements[]
+* @param position_x, position_y: position of the down-left corner
+* @return   number of frames
+*
+*****************************************************************************/
+int placement_frames(int element_info, int position_x, int position_y);
+/****************************************************************************/
+/**
+*
+* Moves the running element of a partition to another partition of the virtual
+* architecture with its state: the state is captured with
+* capture_partition_state() and restored in the position of the other partition
+* with restore_partition_state(), so the PBS is not loaded from the SD card. The
+* position must be compatible with the element (see find_partition_position())
+* and must not overlap other elements, including the actual position. The
+* other partition must not have an element, since it would be overwritten while
+* it runs (it can be invalidated with change_partition_element() and -1),
+* and the first partition is left without element (its frames are not erased).
+*
+* NOTE the element should be stopped (e.g. its clock disabled) while it is
+* moved, and the restore sets all the flip-flops of the FPGA (see
+* restore_subclock_region_state())
+*
+* @param virtual_architecture:
+* @param x, y: partition of the element
+* @param new_x, new_y: partition where the element is moved
+* @return   XST_SUCCESS else XST_FAILURE (the element is kept in the first
+*           partition)
+*
+*****************************************************************************/
+int migrate_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int new_x, int new_y);
+/****************************************************************************/
+/**
+*
+* Moves the running element of a partition to another position of the FPGA
+* with its state, like migrate_partition_element(). The new position may
+* overlap the actual one.
+*
+* @param virtual_architecture:
+* @param x, y: partition of the element
+* @param position_x, position_y: new position of the partition
+* @return   XST_SUCCESS else XST_FAILURE (the element is kept in its position)
+*
+*****************************************************************************/
+int relocate_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int position_x, int position_y);
+/****************************************************************************/
+/**
+*
+* Plans the relocations of the elements of the virtual architecture that open
+* a compatible position for an element when there is not a free one (the free
+* columns are fragmented). For each compatible position the elements that
+* overlap it are moved to the free compatible position that needs less frames
+* (the biggest elements first) and the plan with less frames written in total
+* is selected. The elements are moved with their state, so they keep running
+* after the plan is executed. If there is already a free position the plan has
+* no moves. Nothing is written.
+*
+* @param virtual_architecture:
+* @param x, y: partition where the element will be placed (its actual element
+* is replaced, so its position is considered free)
+* @param element_info: position of the element in elements[]
+* @param plan: returns the moves, the position and the predicted cost
+* @return   XST_SUCCESS else XST_FAILURE if no position can be opened moving
+*           up to DEFRAGMENTATION_MAX_MOVES elements
+*
+*****************************************************************************/
+int plan_defragmentation(virtual_architecture_t *virtual_architecture, int x, int y, int element_info, defragmentation_plan_t *plan);
+/****************************************************************************/
+/**
+*
+* Executes a plan obtained with plan_defragmentation(): the elements are
+* relocated in order with relocate_partition_element() and the element is
+* placed in the position opened. The virtual architecture must not have
+* changed since the plan was obtained.
+*
+* @param virtual_architecture:
+* @param plan:
+* @return   XST_SUCCESS else XST_FAILURE (the moves already executed are kept)
+*
+*****************************************************************************/
+int execute_defragmentation(virtual_architecture_t *virtual_architecture, defragmentation_plan_t *plan);
+
+#endif
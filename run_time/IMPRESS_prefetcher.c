@@ -0,0 +1,183 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "IMPRESS_prefetcher.h"
+#include <xstatus.h>
+
+/* Function declarations*/
+static int partition_index(virtual_architecture_t *virtual_architecture, int x, int y);
+static int current_element(virtual_architecture_t *virtual_architecture, int x, int y);
+static uint16_t *transition_row(predictive_prefetcher_t *prefetcher, int partition, int previous_element);
+
+/* Function definitions*/
+int init_predictive_prefetcher(predictive_prefetcher_t *prefetcher, virtual_architecture_t *virtual_architecture) {
+  int i;
+
+  prefetcher->num_partitions = virtual_architecture->width * virtual_architecture->height;
+  prefetcher->transition_counts = calloc(prefetcher->num_partitions * (NUM_ELEMENTS + 1) * NUM_ELEMENTS, sizeof(uint16_t));
+  prefetcher->predicted_element = malloc(prefetcher->num_partitions * sizeof(int));
+  if (prefetcher->transition_counts == NULL || prefetcher->predicted_element == NULL) {
+    prefetcher->virtual_architecture = NULL;
+    release_predictive_prefetcher(prefetcher);
+    return XST_FAILURE;
+  }
+  for (i = 0; i < prefetcher->num_partitions; i++) {
+    prefetcher->predicted_element[i] = -1;
+  }
+  prefetcher->virtual_architecture = virtual_architecture;
+  prefetcher->next_partition = 0;
+  prefetcher->prepared_partition = -1;
+  reset_prefetch_statistics(prefetcher);
+  virtual_architecture->prefetcher = prefetcher;
+  return XST_SUCCESS;
+}
+
+void release_predictive_prefetcher(predictive_prefetcher_t *prefetcher) {
+  if (prefetcher->virtual_architecture != NULL && prefetcher->virtual_architecture->prefetcher == prefetcher) {
+    prefetcher->virtual_architecture->prefetcher = NULL;
+  }
+  free(prefetcher->transition_counts);
+  free(prefetcher->predicted_element);
+  prefetcher->transition_counts = NULL;
+  prefetcher->predicted_element = NULL;
+  prefetcher->virtual_architecture = NULL;
+  prefetcher->num_partitions = 0;
+}
+
+void record_element_transition(virtual_architecture_t *virtual_architecture, int x, int y, int element_info) {
+  predictive_prefetcher_t *prefetcher = virtual_architecture->prefetcher;
+  int partition, i;
+  uint16_t *row;
+
+  partition = partition_index(virtual_architecture, x, y);
+  if (partition == -1) {
+    return;
+  }
+
+  if (prefetcher->predicted_element[partition] == element_info) {
+    prefetcher->statistics.hits++;
+  } else if (prefetcher->predicted_element[partition] != -1) {
+    prefetcher->statistics.misses++;
+  } else {
+    prefetcher->statistics.unpredicted++;
+  }
+  if (is_partition_element_prepared(virtual_architecture, x, y, element_info)) {
+    prefetcher->statistics.readback_hits++;
+  }
+  prefetcher->predicted_element[partition] = -1;
+
+  row = transition_row(prefetcher, partition, current_element(virtual_architecture, x, y));
+  if (row[element_info] == MAX_TRANSITION_COUNT) {
+    // Old transitions lose weight so that the prediction follows changes in the workload
+    for (i = 0; i < NUM_ELEMENTS; i++) {
+      row[i] >>= 1;
+    }
+  }
+  row[element_info]++;
+}
+
+int predict_next_element(virtual_architecture_t *virtual_architecture, int x, int y) {
+  int partition, previous, next, i;
+  uint16_t *row;
+
+  partition = partition_index(virtual_architecture, x, y);
+  if (partition == -1) {
+    return -1;
+  }
+
+  previous = current_element(virtual_architecture, x, y);
+  row = transition_row(virtual_architecture->prefetcher, partition, previous);
+  next = -1;
+  for (i = 0; i < NUM_ELEMENTS; i++) {
+    if (i != previous && row[i] > 0 && (next == -1 || row[i] > row[next])) {
+      next = i;
+    }
+  }
+  return next;
+}
+
+int predictive_prefetch_step(virtual_architecture_t *virtual_architecture, int prepare) {
+  predictive_prefetcher_t *prefetcher = virtual_architecture->prefetcher;
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  int partition, next, x, y, i;
+
+  if (prefetch_PBS_step(engine)) {
+    return 1;
+  }
+  if (partition_index(virtual_architecture, 0, 0) == -1) {
+    return 0;
+  }
+
+  for (i = 0; i < prefetcher->num_partitions; i++) {
+    partition = prefetcher->next_partition;
+    prefetcher->next_partition = (prefetcher->next_partition + 1) % prefetcher->num_partitions;
+    x = partition / virtual_architecture->height;
+    y = partition % virtual_architecture->height;
+
+    next = predict_next_element(virtual_architecture, x, y);
+    if (next == -1) {
+      continue;
+    }
+    prefetcher->predicted_element[partition] = next;
+    if (!is_element_PBS_prefetched(engine, next)) {
+      if (prefetch_element_PBS(engine, next) != XST_SUCCESS) {
+        prefetcher->predicted_element[partition] = -1;
+        return 0;
+      }
+      prefetcher->statistics.predictions++;
+      return prefetch_PBS_step(engine);
+    }
+
+    // Only one partition is prepared speculatively; it is kept while it is valid
+    if (prepare) {
+      if (prefetcher->prepared_partition != -1 && prefetcher->predicted_element[prefetcher->prepared_partition] != -1
+          && is_partition_element_prepared(virtual_architecture, prefetcher->prepared_partition / virtual_architecture->height, prefetcher->prepared_partition % virtual_architecture->height, prefetcher->predicted_element[prefetcher->prepared_partition])) {
+        continue;
+      }
+      if (prepare_partition_element(virtual_architecture, x, y, next) == XST_SUCCESS) {
+        prefetcher->prepared_partition = partition;
+        return 0;
+      }
+    }
+  }
+  return 0;
+}
+
+void get_prefetch_statistics(predictive_prefetcher_t *prefetcher, prefetch_statistics_t *statistics) {
+  *statistics = prefetcher->statistics;
+}
+
+void reset_prefetch_statistics(predictive_prefetcher_t *prefetcher) {
+  memset(&prefetcher->statistics, 0, sizeof(prefetcher->statistics));
+}
+
+/*
+* Returns the position of the partition in the tables or -1 if the virtual
+* architecture does not have a prefetcher
+*/
+static int partition_index(virtual_architecture_t *virtual_architecture, int x, int y) {
+  if (virtual_architecture->prefetcher == NULL) {
+    return -1;
+  }
+  if (x < 0 || x >= virtual_architecture->width || y < 0 || y >= virtual_architecture->height) {
+    return -1;
+  }
+  return x * virtual_architecture->height + y;
+}
+
+/*
+* Returns the element of the partition or -1 if it is empty
+*/
+static int current_element(virtual_architecture_t *virtual_architecture, int x, int y) {
+  element_info_t *element_info;
+
+  element_info = virtual_architecture->partition[x][y].element.element_info;
+  if (element_info == NULL) {
+    return -1;
+  }
+  return element_info - elements;
+}
+
+static uint16_t *transition_row(predictive_prefetcher_t *prefetcher, int partition, int previous_element) {
+  return prefetcher->transition_counts + (partition * (NUM_ELEMENTS + 1) + previous_element + 1) * NUM_ELEMENTS;
+}
@@ -0,0 +1,117 @@
+#ifndef IMPRESS_PREFETCHER
+#define IMPRESS_PREFETCHER
+
+#include "IMPRESS_reconfiguration.h"
+
+#define MAX_TRANSITION_COUNT            0xFFFF // The counts of a partition are halved when one of them reaches this value
+
+typedef struct {
+  uint32_t predictions;   // PBS loaded speculatively
+  uint32_t hits;          // Reconfigurations of an element that was predicted for the partition
+  uint32_t misses;        // Reconfigurations of a partition for which another element was predicted
+  uint32_t unpredicted;   // Reconfigurations of a partition without prediction
+  uint32_t readback_hits; // Reconfigurations that had been prepared in advance
+} prefetch_statistics_t;
+
+struct predictive_prefetcher {
+  virtual_architecture_t *virtual_architecture;
+  // Transition counts: one row of NUM_ELEMENTS counts for each partition and previous element (or empty partition)
+  uint16_t *transition_counts;
+  // Element predicted for each partition (-1 if there is no prediction)
+  int *predicted_element;
+  int num_partitions;
+  int next_partition;
+  int prepared_partition; // Partition prepared speculatively (-1 if none)
+  prefetch_statistics_t statistics;
+};
+
+/****************************************************************************/
+/**
+*
+* Initializes the predictive prefetcher of a virtual architecture. For each
+* partition it keeps a table (Markov chain) with the number of times that each
+* element of elements[] has been reconfigured after each other element. The
+* transitions are recorded by change_partition_element() when
+* PREDICTIVE_PREFETCH is set to 1. It must be called after
+* init_virtual_architecture().
+*
+* @param prefetcher: prefetcher to initialize
+* @param virtual_architecture:
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int init_predictive_prefetcher(predictive_prefetcher_t *prefetcher, virtual_architecture_t *virtual_architecture);
+/****************************************************************************/
+/**
+*
+* Releases the transition tables of the predictive prefetcher and detaches it
+* from its virtual architecture
+*
+* @param prefetcher:
+* @return   none
+*
+*****************************************************************************/
+void release_predictive_prefetcher(predictive_prefetcher_t *prefetcher);
+/****************************************************************************/
+/**
+*
+* Records that an element is going to be reconfigured in a partition. It is
+* called by change_partition_element() before the element of the partition is
+* changed.
+*
+* @param virtual_architecture:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @param num_element: reconfigurable module position in elements variable
+* @return   none
+*
+*****************************************************************************/
+void record_element_transition(virtual_architecture_t *virtual_architecture, int x, int y, int num_element);
+/****************************************************************************/
+/**
+*
+* @param virtual_architecture:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @return   element that has followed more times the actual element of the
+*           partition or -1 if there is no history
+*
+*****************************************************************************/
+int predict_next_element(virtual_architecture_t *virtual_architecture, int x, int y);
+/****************************************************************************/
+/**
+*
+* Loads speculatively the PBS of the next element predicted for the partitions
+* (one partition each call). It must be called when the processor is idle;
+* each call loads at most PBS_PREFETCH_STEP_BYTES. The speculative PBS use the
+* same RAM cache as prefetch_element_PBS().
+*
+* @param virtual_architecture:
+* @param prepare: if set to 1, when the PBS of the predicted element of a
+*        partition is loaded, its reconfiguration is also prepared in advance
+*        with prepare_partition_element()
+* @return   1 if a PBS is still being loaded, else 0
+*
+*****************************************************************************/
+int predictive_prefetch_step(virtual_architecture_t *virtual_architecture, int prepare);
+/****************************************************************************/
+/**
+*
+* @param prefetcher:
+* @param statistics: returns the hits and misses of the prefetcher
+* @return   none
+*
+*****************************************************************************/
+void get_prefetch_statistics(predictive_prefetcher_t *prefetcher, prefetch_statistics_t *statistics);
+/****************************************************************************/
+/**
+*
+* Sets to 0 the hits and misses of the prefetcher
+*
+* @param prefetcher:
+* @return   none
+*
+*****************************************************************************/
+void reset_prefetch_statistics(predictive_prefetcher_t *prefetcher);
+
+#endif
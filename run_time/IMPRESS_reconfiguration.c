@@ -3,13 +3,22 @@
 #include "series7.h"
 #include "xc7z020.h"
 #include "reconfig_pcap.h"
+#include "reconfig_os.h"
 #include "xparameters.h"
 #include <xstatus.h>
 #include "xtime_l.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if PREDICTIVE_PREFETCH
+#include "IMPRESS_prefetcher.h"
+#endif
+#if CONFIGURATION_SCRUBBING
+#include "IMPRESS_scrubber.h"
+#endif
 
 #if FINE_GRAIN
-#define SEARCH_IF_FINE_GRAIN_VALUE_HAS_CHANGED		0
+#define SEARCH_IF_FINE_GRAIN_VALUE_HAS_CHANGED		1
 /*Constant declaration*/
 #define ICAP_CTRL_BASEADDR  XPAR_FINE_GRAIN_RE_0_S_CTRL_BASEADDR
 #define ICAP_MEM_BASEADDR   XPAR_FINE_GRAIN_RE_0_S_MEM_BASEADDR
@@ -38,44 +47,41 @@ please set ICAP_CTRL_BASEADDR manually
 #define CONST_TYPE                          0 
 #define MUX_TYPE                            1
 #define FU_TYPE                             2
-#define WORDS_PER_CONSTANTS                 13
-#define WORDS_PER_MUX                       13
-#define WORDS_PER_FU                        10
 #define LUTS_PER_CLB						            4
 
-typedef struct {
-  uint32_t frame_address;
-  // Each frame is defined with 400 bits and therefore has 13 words
-  uint32_t value[WORDS_PER_CONSTANTS];
-} frame_constant_t;
-
-typedef struct {
-  uint32_t frame_address;
-  // Each frame has 50 four-bit blocks. For each block we need to define it with 2 bit
-  // therefore we need 4 words to send to the fine grain RE.
-  uint32_t value[WORDS_PER_MUX];
-} frame_mux_t;
-
-typedef struct {
-  uint32_t frame_address;
-  uint32_t value[WORDS_PER_FU];
-} frame_FU_t;
-
-
 /* Function declarations*/
 static void update_partition_location_info(virtual_architecture_t *virtual_architecture, int x, int y);
-static int init_PCAP();
+static void set_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int element_info);
+static int init_PCAP(reconfiguration_engine_t *engine);
+static void enable_PCAP(reconfiguration_engine_t *engine);
+static void init_PBS_cache(reconfiguration_engine_t *engine);
+static u32 *PBS_cache_slot_addr(reconfiguration_engine_t *engine, int slot);
+static int find_PBS_cache_slot(reconfiguration_engine_t *engine, int element_info);
+static int free_PBS_cache_slot(reconfiguration_engine_t *engine);
+static int load_element_PBS(reconfiguration_engine_t *engine, int element_info);
+static void PBS_cache_idle(void *engine);
+static int write_element_PBS(virtual_architecture_t *virtual_architecture, int x, int y, u8 stacked_modules);
+static int commit_element_PBS(reconfiguration_engine_t *engine, int buffer, u32 erase_bram);
+static int write_element_BRAM(virtual_architecture_t *virtual_architecture, int x, int y);
+static void partition_pblock(virtual_architecture_t *virtual_architecture, int x, int y, element_info_t *element_info, pblock *pblock_1);
+static void init_staging_buffers(reconfiguration_engine_t *engine);
+static int find_prepared_staging_buffer(reconfiguration_engine_t *engine, pblock *pblock_1, int element_info);
+static int free_staging_buffer(reconfiguration_engine_t *engine);
+static void invalidate_staging_buffers(reconfiguration_engine_t *engine, int written_buffer);
+static int prepare_element_PBS(reconfiguration_engine_t *engine, int buffer, element_info_t *element_info, pblock *pblock_1, u8 stacked_modules);
+static void *arena_alloc(char *arena, size_t *arena_offset, size_t size);
+static size_t allocate_partitions(virtual_architecture_t *virtual_architecture, char *arena);
 #if FINE_GRAIN
 static void init_num_constant_columns_elements();
 static void init_num_mux_columns_elements();
 static void init_num_FU_columns_elements();
-static void init_constant_frames();
-static void init_mux_frames();
-static void init_FU_frames();
+static void init_constant_frames(reconfiguration_engine_t *engine);
+static void init_mux_frames(reconfiguration_engine_t *engine);
+static void init_FU_frames(reconfiguration_engine_t *engine);
 static uint32_t obtain_frame_address_of_CLB_column(virtual_architecture_t *virtual_architecture, int x, int y, int clock_row_number, int column_number);
-static void change_constant_frame_address(uint32_t frame_address_position, int first_bit, int last_bit, int previous_bits_sent, uint32_t *value);
-static void change_mux_frame_address(uint32_t frame_address_position, int first_LUT, int last_LUT, int value, int LUT_position, int num_inputs);
-static void change_FU_frame_address(uint32_t frame_address_position, int first_block, int last_block, int value);
+static void change_constant_frame_address(reconfiguration_engine_t *engine, uint32_t frame_address_position, int first_bit, int last_bit, int previous_bits_sent, const uint32_t *value);
+static void change_mux_frame_address(reconfiguration_engine_t *engine, uint32_t frame_address_position, int first_LUT, int last_LUT, int value, int LUT_position, int num_inputs);
+static void change_FU_frame_address(reconfiguration_engine_t *engine, uint32_t frame_address_position, int first_block, int last_block, int value);
 static int obtain_CLB_minor_column(int row, int column, int num_slice);
 static int is_column_CLB_type(int row, int column);
 static void reset_fine_grain_elements(virtual_architecture_t *virtual_architecture, int x, int y);
@@ -86,46 +92,248 @@ static int calculate_FU_parameters(virtual_architecture_t *virtual_architecture,
 static uint16_t get_PBS_2_bits(int bits);
 static void load_constant_PBS();
 static void load_mux_PBS();
-static void load_FU();
-static void load_fine_grain_PBS();
+static void load_FU(reconfiguration_engine_t *engine);
+static void write_FU_slot(int slot, uint32_t stage1, uint32_t stage2);
+static int num_FU_slots();
+static void load_fine_grain_PBS(reconfiguration_engine_t *engine);
 static uint32_t obtain_XFAR(uint32_t element_type, uint32_t num_frames, uint32_t frame_address);
 static int LUTs_in_mux(int data_width, int num_inputs);
-static void enable_ICAP();
+static void enable_ICAP(reconfiguration_engine_t *engine);
 static int update_partition_fine_grain_info(virtual_architecture_t *virtual_architecture, int x, int y);
-static void reconfigure_constants();
-static void reconfigure_muxes();
-static void reconfigure_FU();
+static void reconfigure_constants(reconfiguration_engine_t *engine);
+static void reconfigure_muxes(reconfiguration_engine_t *engine);
+static void reconfigure_FU(reconfiguration_engine_t *engine);
+static int frame_has_changed(const uint32_t *value, uint32_t *written_value, int8_t *written, int num_words);
 #endif
 
-/*Global variables*/
-static XDcfg xCAP_component;
-#if FINE_GRAIN
-static frame_constant_t constant_t_frames[MAX_COLUMNS_CONSTANTS]; //__attribute__((section(".OCM.data")));
-static int8_t constant_frames_flags[MAX_COLUMNS_CONSTANTS];
-static frame_mux_t mux_t_frames[MAX_COLUMNS_MUX];
-static int8_t mux_frames_flags[MAX_COLUMNS_MUX];
-static frame_FU_t  FU_t_frames[MAX_COLUMNS_FU];
-static int8_t FU_frames_flags[MAX_COLUMNS_FU];
-#endif
 /* Function definitions*/
-void init_virtual_architecture() {
-  init_PCAP();
+int init_reconfiguration_engine(reconfiguration_engine_t *engine, u32 RAM_addr) {
+  int status;
+
+  status = init_PCAP(engine);
+  if (status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  engine->RAM_start = RAM_addr;
+  init_staging_buffers(engine);
+  init_PBS_cache(engine);
+  engine->verify_mode = RECONFIGURATION_VERIFY_MODE;
+  engine->verify_count = 0;
+  engine->verify_errors = 0;
+  engine->scrubber = NULL;
+  engine->num_reserved_regions = 0;
+  engine->relocation_index = NULL;
+  engine->relocation_index_entries = 0;
   #if FINE_GRAIN
   find_number_of_fine_grain_blocks();
-  init_constant_frames();
-  init_mux_frames();
-  init_FU_frames();
+  init_constant_frames(engine);
+  init_mux_frames(engine);
+  init_FU_frames(engine);
   init_num_constant_columns_elements();
   init_num_mux_columns_elements();
   init_num_FU_columns_elements();
-  load_fine_grain_PBS();
+  load_fine_grain_PBS(engine);
+  #endif
+  return XST_SUCCESS;
+}
+
+void release_reconfiguration_engine(reconfiguration_engine_t *engine) {
+  if (engine->PBS_cache_loading_slot != -1) {
+    abort_bitstream_load_from_SD();
+    engine->PBS_cache_loading_slot = -1;
+  }
+  PCAP_set_idle_callback(NULL, NULL);
+  free(engine->relocation_index);
+  engine->relocation_index = NULL;
+  engine->relocation_index_entries = 0;
+}
+
+int calibrate_PCAP_clock(reconfiguration_engine_t *engine, int column, int clock_row) {
+  staging_buffer_t *work = &engine->staging_buffers[0];
+  int status;
+
+  // The readback of the stacked modules being reconfigured may be in the buffer
+  if (engine->stacked_staging_buffer != -1) {
+    return XST_FAILURE;
+  }
+  if (work->addr_limit - work->addr_start < PCAP_CALIBRATION_WORDS(fpga[clock_row][column][0] & 0xFFFF)) {
+    return XST_FAILURE;
+  }
+  engine->staging_element[0] = -1;
+  reconfig_os_lock(RECONFIG_LOCK_PCAP);
+  enable_PCAP(engine);
+  status = PCAP_calibrate_clock(&engine->xCAP_component, column, clock_row, work->addr_start);
+  reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+  return status;
+}
+
+int set_reconfiguration_transport(reconfiguration_engine_t *engine, u32 transport) {
+  int i;
+
+  if (!CAP_transport_available(transport)) {
+    return XST_FAILURE;
+  }
+  for (i = 0; i < NUM_STAGING_BUFFERS; i++) {
+    engine->staging_buffers[i].transport = transport;
+  }
+  return XST_SUCCESS;
+}
+
+int benchmark_reconfiguration_transport(reconfiguration_engine_t *engine, u32 transport, int first_column, int last_column, int clock_row, CAP_benchmark_t *result) {
+  staging_buffer_t *work = &engine->staging_buffers[0];
+  u32 frames = 0;
+  int x, status;
+
+  for (x = first_column; x <= last_column; x++) {
+    frames += fpga[clock_row][x][0] & 0xFFFF;
+  }
+  if (work->addr_limit - work->addr_start < CAP_BENCHMARK_WORDS(frames)) {
+    return XST_FAILURE;
+  }
+  engine->staging_element[0] = -1;
+  reconfig_os_lock(RECONFIG_LOCK_PCAP);
+  enable_PCAP(engine);
+  status = CAP_benchmark_transport(&engine->xCAP_component, transport, first_column, clock_row, last_column, work->addr_start, result);
+  reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+  return status;
+}
+
+void set_reconfiguration_verify_mode(reconfiguration_engine_t *engine, u32 mode) {
+  engine->verify_mode = mode;
+}
+
+void lock_PCAP(reconfiguration_engine_t *engine) {
+  reconfig_os_lock(RECONFIG_LOCK_PCAP);
+  enable_PCAP(engine);
+}
+
+void unlock_PCAP(reconfiguration_engine_t *engine) {
+  reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+}
+
+void discard_prepared_reconfigurations(reconfiguration_engine_t *engine) {
+  invalidate_staging_buffers(engine, -1);
+}
+
+int init_virtual_architecture(virtual_architecture_t *virtual_architecture, reconfiguration_engine_t *engine, int width, int height) {
+  size_t arena_size;
+
+  if (width <= 0 || height <= 0) {
+    return XST_FAILURE;
+  }
+
+  virtual_architecture->engine = engine;
+  virtual_architecture->prefetcher = NULL;
+  virtual_architecture->width = width;
+  virtual_architecture->height = height;
+  virtual_architecture->max_constants = 0;
+  virtual_architecture->max_muxes = 0;
+  virtual_architecture->max_FU = 0;
+  #if FINE_GRAIN
+  int i;
+  for (i = 0; i < NUM_ELEMENTS; i++) {
+    if (elements[i].num_constants > virtual_architecture->max_constants) {
+      virtual_architecture->max_constants = elements[i].num_constants;
+    }
+    if (elements[i].num_muxes > virtual_architecture->max_muxes) {
+      virtual_architecture->max_muxes = elements[i].num_muxes;
+    }
+    if (elements[i].num_FU > virtual_architecture->max_FU) {
+      virtual_architecture->max_FU = elements[i].num_FU;
+    }
+  }
   #endif
+
+  // We first calculate the size of all the partitions and then we allocate them in one block
+  arena_size = allocate_partitions(virtual_architecture, NULL);
+  virtual_architecture->arena = calloc(1, arena_size);
+  if (virtual_architecture->arena == NULL) {
+    return XST_FAILURE;
+  }
+  allocate_partitions(virtual_architecture, (char *) virtual_architecture->arena);
+  return XST_SUCCESS;
 }
 
-static int init_PCAP() {
+void release_virtual_architecture(virtual_architecture_t *virtual_architecture) {
+  free(virtual_architecture->arena);
+  virtual_architecture->arena = NULL;
+  virtual_architecture->partition = NULL;
+  virtual_architecture->width = 0;
+  virtual_architecture->height = 0;
+}
+
+/*
+* Distributes the arena between the partitions and returns the size used. If arena
+* is NULL the pointers are not stored and it only calculates the size of the arena.
+*/
+static size_t allocate_partitions(virtual_architecture_t *virtual_architecture, char *arena) {
+  size_t arena_offset = 0;
+  int assign = (arena != NULL);
+  int x, y;
+  int width, height;
+  partition_t **partition;
+  partition_t *column;
+
+  width = virtual_architecture->width;
+  height = virtual_architecture->height;
+  partition = arena_alloc(arena, &arena_offset, width * sizeof(partition_t *));
+  if (assign) {
+    virtual_architecture->partition = partition;
+  }
+  for (x = 0; x < width; x++) {
+    column = arena_alloc(arena, &arena_offset, height * sizeof(partition_t));
+    if (assign) {
+      virtual_architecture->partition[x] = column;
+    }
+  }
+  #if FINE_GRAIN
+  element_t element;
+  for (x = 0; x < width; x++) {
+    for (y = 0; y < height; y++) {
+      element.constants_definition = arena_alloc(arena, &arena_offset, virtual_architecture->max_constants * sizeof(constant_t));
+      element.mux_definition = arena_alloc(arena, &arena_offset, virtual_architecture->max_muxes * sizeof(mux_t));
+      element.FU_definition = arena_alloc(arena, &arena_offset, virtual_architecture->max_FU * sizeof(FU_t));
+      element.constant_frame_address_position = arena_alloc(arena, &arena_offset, virtual_architecture->max_constants * sizeof(*element.constant_frame_address_position));
+      element.first_bit_in_frame = arena_alloc(arena, &arena_offset, virtual_architecture->max_constants * sizeof(*element.first_bit_in_frame));
+      element.last_bit_in_frame = arena_alloc(arena, &arena_offset, virtual_architecture->max_constants * sizeof(*element.last_bit_in_frame));
+      element.mux_frame_address_position = arena_alloc(arena, &arena_offset, virtual_architecture->max_muxes * sizeof(*element.mux_frame_address_position));
+      element.first_LUT_in_frame = arena_alloc(arena, &arena_offset, virtual_architecture->max_muxes * sizeof(*element.first_LUT_in_frame));
+      element.last_LUT_in_frame = arena_alloc(arena, &arena_offset, virtual_architecture->max_muxes * sizeof(*element.last_LUT_in_frame));
+      element.LUT_position_in_frame = arena_alloc(arena, &arena_offset, virtual_architecture->max_muxes * sizeof(*element.LUT_position_in_frame));
+      element.total_LUTs_in_mux = arena_alloc(arena, &arena_offset, virtual_architecture->max_muxes * sizeof(int));
+      element.FU_frame_address_position = arena_alloc(arena, &arena_offset, virtual_architecture->max_FU * sizeof(*element.FU_frame_address_position));
+      element.first_FU_block_in_frame = arena_alloc(arena, &arena_offset, virtual_architecture->max_FU * sizeof(*element.first_FU_block_in_frame));
+      element.last_FU_block_in_frame = arena_alloc(arena, &arena_offset, virtual_architecture->max_FU * sizeof(*element.last_FU_block_in_frame));
+      if (assign) {
+        element.element_info = NULL;
+        virtual_architecture->partition[x][y].element = element;
+      }
+    }
+  }
+  #else
+  (void) y;
+  #endif
+  return arena_offset;
+}
+
+/*
+* Returns the next block of the arena aligned to 8 bytes (NULL if the arena is
+* NULL, when it is used to calculate the size of the arena).
+*/
+static void *arena_alloc(char *arena, size_t *arena_offset, size_t size) {
+  void *block = NULL;
+
+  if (arena != NULL) {
+    block = arena + *arena_offset;
+  }
+  *arena_offset += (size + 7) & ~((size_t) 7);
+  return block;
+}
+
+static int init_PCAP(reconfiguration_engine_t *engine) {
   int status;
   
-  status = PCAP_Initialize(&xCAP_component, PCAP_ID);
+  status = PCAP_Initialize(&engine->xCAP_component, PCAP_ID);
   if (status != XST_SUCCESS) {
     return XST_FAILURE;
   }
@@ -135,8 +343,445 @@ static int init_PCAP() {
 
 
 
-static void enable_PCAP() {
-  XDcfg_SelectPcapInterface(&xCAP_component);
+/*
+* Prepares the PCAP before a transfer. The SD loads of the PBS cache of the engine
+* continue while the PCAP is busy. The interface of the DEVCFG is selected by the
+* transfers (the staging buffers can use the HWICAP), so the fine-grain work that
+* follows does not have to select the ICAP again.
+*/
+static void enable_PCAP(reconfiguration_engine_t *engine) {
+  PCAP_set_idle_callback(PBS_cache_idle, engine);
+}
+
+/*
+* The PBS of the elements are kept in the RAM (after the staging buffers) once they are
+* loaded from the SD card. The PBS that will be needed can be loaded in advance
+* with prefetch_element_PBS(); the load continues while the PCAP is writing
+* other PBS.
+*/
+static void init_PBS_cache(reconfiguration_engine_t *engine) {
+  int i;
+
+  abort_bitstream_load_from_SD();
+  for (i = 0; i < PBS_CACHE_SLOTS; i++) {
+    engine->PBS_cache[i].element_info = -1;
+    engine->PBS_cache[i].loaded = 0;
+    engine->PBS_cache[i].last_use = 0;
+  }
+  engine->PBS_cache_loading_slot = -1;
+  engine->PBS_cache_use_count = 0;
+  engine->RAM_end = engine->PBS_cache_base + PBS_CACHE_SLOTS * PBS_CACHE_SLOT_BYTES;
+}
+
+static u32 *PBS_cache_slot_addr(reconfiguration_engine_t *engine, int slot) {
+  return (u32 *) (engine->PBS_cache_base + slot * PBS_CACHE_SLOT_BYTES);
+}
+
+/*
+* Returns the slot that contains (or is loading) the PBS of the element or -1
+*/
+static int find_PBS_cache_slot(reconfiguration_engine_t *engine, int element_info) {
+  int i;
+
+  for (i = 0; i < PBS_CACHE_SLOTS; i++) {
+    if (engine->PBS_cache[i].element_info == element_info) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*
+* Returns an empty slot or else the least recently used slot (-1 if the only
+* slot is being loaded)
+*/
+static int free_PBS_cache_slot(reconfiguration_engine_t *engine) {
+  int i, slot = -1;
+
+  for (i = 0; i < PBS_CACHE_SLOTS; i++) {
+    if (i == engine->PBS_cache_loading_slot) {
+      continue;
+    }
+    if (engine->PBS_cache[i].element_info == -1) {
+      return i;
+    }
+    if (slot == -1 || engine->PBS_cache[i].last_use < engine->PBS_cache[slot].last_use) {
+      slot = i;
+    }
+  }
+  return slot;
+}
+
+int prefetch_element_PBS(reconfiguration_engine_t *engine, int element_info) {
+  int slot;
+
+  if (element_info < 0 || element_info >= NUM_ELEMENTS) {
+    return XST_FAILURE;
+  }
+  slot = find_PBS_cache_slot(engine, element_info);
+  if (slot != -1) {
+    engine->PBS_cache[slot].last_use = ++engine->PBS_cache_use_count;
+    return XST_SUCCESS;
+  }
+  if (engine->PBS_cache_loading_slot != -1) {
+    return XST_FAILURE;
+  }
+  slot = free_PBS_cache_slot(engine);
+  if (slot == -1) {
+    return XST_FAILURE;
+  }
+  engine->PBS_cache[slot].element_info = -1;
+  if (start_bitstream_load_from_SD(elements[element_info].PBS_name, PBS_cache_slot_addr(engine, slot), PBS_cache_slot_addr(engine, slot + 1)) != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  engine->PBS_cache[slot].element_info = element_info;
+  engine->PBS_cache[slot].loaded = 0;
+  engine->PBS_cache[slot].last_use = ++engine->PBS_cache_use_count;
+  engine->PBS_cache_loading_slot = slot;
+  return XST_SUCCESS;
+}
+
+int prefetch_PBS_step(reconfiguration_engine_t *engine) {
+  int slot, state;
+  u32 *PBS_last_addr;
+
+  slot = engine->PBS_cache_loading_slot;
+  if (slot == -1) {
+    return 0;
+  }
+  state = continue_bitstream_load_from_SD(PBS_PREFETCH_STEP_BYTES, &PBS_last_addr);
+  if (state == SD_LOAD_DONE) {
+    engine->PBS_cache[slot].PBS_last_addr = PBS_last_addr;
+    engine->PBS_cache[slot].loaded = 1;
+    engine->PBS_cache_loading_slot = -1;
+  } else if (state != SD_LOAD_IN_PROGRESS) {
+    engine->PBS_cache[slot].element_info = -1;
+    engine->PBS_cache_loading_slot = -1;
+  }
+  return (engine->PBS_cache_loading_slot != -1);
+}
+
+int is_element_PBS_prefetched(reconfiguration_engine_t *engine, int element_info) {
+  int slot;
+
+  slot = find_PBS_cache_slot(engine, element_info);
+  return (slot != -1 && engine->PBS_cache[slot].loaded);
+}
+
+/*
+* Called while the PCAP transfers are in progress
+*/
+static void PBS_cache_idle(void *engine) {
+  prefetch_PBS_step((reconfiguration_engine_t *) engine);
+}
+
+/*
+* Returns the slot with the PBS of the element loaded or -1 if it cannot be stored
+* in the cache. If another PBS is being loaded it is completed first.
+*/
+static int load_element_PBS(reconfiguration_engine_t *engine, int element_info) {
+  int slot;
+
+  slot = find_PBS_cache_slot(engine, element_info);
+  if (slot == -1 || !engine->PBS_cache[slot].loaded) {
+    if (slot == -1) {
+      while (prefetch_PBS_step(engine));
+      if (prefetch_element_PBS(engine, element_info) != XST_SUCCESS) {
+        return -1;
+      }
+    }
+    while (prefetch_PBS_step(engine));
+    slot = find_PBS_cache_slot(engine, element_info);
+    if (slot == -1) {
+      return -1;
+    }
+  }
+  engine->PBS_cache[slot].last_use = ++engine->PBS_cache_use_count;
+  return slot;
+}
+
+/*
+* The reconfigurations are prepared (read back and combined with the new PBS) in
+* NUM_STAGING_BUFFERS buffers placed from the RAM of the engine. Their size is obtained
+* from the FPGA description and the size of the elements. The PBS cache is placed
+* after them.
+*/
+static void init_staging_buffers(reconfiguration_engine_t *engine) {
+  u32 buffer_bytes, bytes, addr;
+  int i, clock_rows;
+
+  buffer_bytes = 0;
+  for (i = 0; i < NUM_ELEMENTS; i++) {
+    // Worst case: the element is not aligned with the clock region rows
+    clock_rows = (elements[i].size[HEIGHT_POS] + ROWS_PER_CLOCK_REGION - 2) / ROWS_PER_CLOCK_REGION + 1;
+    bytes = staging_buffer_bytes(elements[i].size[WIDTH_POS], clock_rows);
+    if (bytes > buffer_bytes) {
+      buffer_bytes = bytes;
+    }
+  }
+  buffer_bytes = (buffer_bytes + SAFE_AREA - 1) & ~(SAFE_AREA - 1);
+
+  addr = engine->RAM_start;
+  for (i = 0; i < NUM_STAGING_BUFFERS; i++) {
+    init_staging_buffer(&engine->staging_buffers[i], (u32 *) addr, (u32 *) (addr + buffer_bytes));
+    engine->staging_element[i] = -1;
+    engine->staging_last_use[i] = 0;
+    addr += buffer_bytes + SAFE_AREA;
+  }
+  engine->staging_use_count = 0;
+  engine->stacked_staging_buffer = -1;
+  engine->PBS_cache_base = addr;
+}
+
+/*
+* Returns the buffer that contains the reconfiguration of the element in the
+* pblock prepared in advance or -1
+*/
+static int find_prepared_staging_buffer(reconfiguration_engine_t *engine, pblock *pblock_1, int element_info) {
+  int i;
+
+  for (i = 0; i < NUM_STAGING_BUFFERS; i++) {
+    if (engine->staging_element[i] == element_info && memcmp(&engine->staging_pblock[i], pblock_1, sizeof(pblock)) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*
+* Returns an empty buffer or else the least recently prepared one, which is
+* discarded. The buffer of the stacked modules being reconfigured is not used.
+*/
+static int free_staging_buffer(reconfiguration_engine_t *engine) {
+  int i, buffer = -1;
+
+  for (i = 0; i < NUM_STAGING_BUFFERS; i++) {
+    if (i == engine->stacked_staging_buffer) {
+      continue;
+    }
+    if (engine->staging_element[i] == -1) {
+      return i;
+    }
+    if (buffer == -1 || engine->staging_last_use[i] < engine->staging_last_use[buffer]) {
+      buffer = i;
+    }
+  }
+  engine->staging_element[buffer] = -1;
+  return buffer;
+}
+
+/*
+* Discards the buffers prepared in advance whose readback shares frames with the
+* buffer that has been written (all of them if written_buffer is -1)
+*/
+static void invalidate_staging_buffers(reconfiguration_engine_t *engine, int written_buffer) {
+  int i;
+
+  for (i = 0; i < NUM_STAGING_BUFFERS; i++) {
+    if (i != written_buffer && engine->staging_element[i] != -1
+        && (written_buffer == -1 || staging_buffers_overlap(&engine->staging_buffers[i], &engine->staging_buffers[written_buffer]))) {
+      engine->staging_element[i] = -1;
+    }
+  }
+}
+
+/*
+* Reads back the pblock in a staging buffer and combines it with the PBS of the
+* element. The PBS is taken from the cache when possible. Otherwise it is loaded
+* from the SD card above the readback.
+*/
+static int prepare_element_PBS(reconfiguration_engine_t *engine, int buffer, element_info_t *element_info, pblock *pblock_1, u8 stacked_modules) {
+  u32 *PBS_last_addr;
+  int slot, status;
+
+  slot = load_element_PBS(engine, element_info - elements);
+  // The BRAM contents are written from the cache after the reconfiguration
+  if (slot == -1 && element_info->PBS_BRAM_contents) {
+    return XST_FAILURE;
+  }
+  // The interface selection is shared with the fine-grain reconfiguration of other tasks
+  reconfig_os_lock(RECONFIG_LOCK_PCAP);
+  enable_PCAP(engine);
+  if (slot == -1) {
+    status = prepare_subclock_region_PBS(&engine->xCAP_component, &engine->staging_buffers[buffer], element_info->PBS_name, NULL, NULL, pblock_1, 1, stacked_modules, element_info->PBS_contiguous_frames);
+  } else {
+    PBS_last_addr = engine->PBS_cache[slot].PBS_last_addr;
+    if (element_info->PBS_BRAM_contents) {
+      PBS_last_addr -= subclock_region_BRAM_words(pblock_1, 1, NULL);
+    }
+    status = prepare_subclock_region_PBS(&engine->xCAP_component, &engine->staging_buffers[buffer], NULL, PBS_cache_slot_addr(engine, slot), PBS_last_addr, pblock_1, 1, stacked_modules, element_info->PBS_contiguous_frames);
+  }
+  reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+  return status;
+}
+
+/*
+* Writes the PBS of the element of a partition. If the reconfiguration was
+* prepared in advance only the write is performed.
+*/
+static int write_element_PBS(virtual_architecture_t *virtual_architecture, int x, int y, u8 stacked_modules) {
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  pblock pblock_1;
+  element_info_t *element_info;
+  int buffer, status;
+
+  element_info = virtual_architecture->partition[x][y].element.element_info;
+  partition_pblock(virtual_architecture, x, y, element_info, &pblock_1);
+
+  if (stacked_modules == 0) {
+    buffer = find_prepared_staging_buffer(engine, &pblock_1, element_info - elements);
+    if (buffer == -1) {
+      buffer = free_staging_buffer(engine);
+      status = prepare_element_PBS(engine, buffer, element_info, &pblock_1, 0);
+      if (status != XST_SUCCESS) {
+        return XST_FAILURE;
+      }
+    }
+  } else {
+    // All the stacked modules are combined in the buffer read back by the first one
+    if (stacked_modules == 1) {
+      engine->stacked_staging_buffer = free_staging_buffer(engine);
+    } else if (engine->stacked_staging_buffer == -1) {
+      return XST_FAILURE;
+    }
+    buffer = engine->stacked_staging_buffer;
+    status = prepare_element_PBS(engine, buffer, element_info, &pblock_1, stacked_modules);
+    if (status != XST_SUCCESS) {
+      engine->stacked_staging_buffer = -1;
+      return XST_FAILURE;
+    }
+    if (stacked_modules != 3) {
+      return XST_SUCCESS;
+    }
+    engine->stacked_staging_buffer = -1;
+  }
+
+  engine->staging_element[buffer] = -1;
+  reconfig_os_lock(RECONFIG_LOCK_PCAP);
+  enable_PCAP(engine);
+  if (stacked_modules == 0 && virtual_architecture->partition[x][y].clear_BRAM_pending) {
+    // The deferred BRAM erase is added to the reconfiguration of the partition
+    status = commit_element_PBS(engine, buffer, PCAP_BRAM_ERASE);
+    if (status == XST_SUCCESS) {
+      virtual_architecture->partition[x][y].clear_BRAM_pending = 0;
+    }
+  } else {
+    status = commit_element_PBS(engine, buffer, PCAP_BRAM_DONOTHING);
+  }
+  #if CONFIGURATION_SCRUBBING
+    if (status == XST_SUCCESS && engine->scrubber != NULL) {
+      record_golden_image(engine->scrubber, &engine->staging_buffers[buffer], element_info - elements);
+    }
+  #endif
+  reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+  invalidate_staging_buffers(engine, buffer);
+  return status;
+}
+
+/*
+* Writes a staging buffer and checks it with the verify mode of the engine. The
+* write is repeated while the frames read back are not equal (up to
+* RECONFIGURATION_VERIFY_RETRIES times). It must be called with the PCAP locked.
+*/
+static int commit_element_PBS(reconfiguration_engine_t *engine, int buffer, u32 erase_bram) {
+  int retries, status;
+
+  status = commit_subclock_region_PBS(&engine->xCAP_component, &engine->staging_buffers[buffer], erase_bram);
+  for (retries = 0; status == XST_SUCCESS && engine->verify_mode != PCAP_VERIFY_OFF; retries++) {
+    status = verify_subclock_region_PBS(&engine->xCAP_component, &engine->staging_buffers[buffer], engine->verify_mode, engine->verify_count++);
+    if (status == XST_SUCCESS) {
+      break;
+    }
+    engine->verify_errors++;
+    if (retries >= RECONFIGURATION_VERIFY_RETRIES) {
+      break;
+    }
+    // The BRAM contents are not checked, so they are not erased again
+    status = commit_subclock_region_PBS(&engine->xCAP_component, &engine->staging_buffers[buffer], PCAP_BRAM_DONOTHING);
+  }
+  return status;
+}
+
+/*
+* Writes the initial BRAM contents at the end of the PBS of the element of a
+* partition (if it has them). The PBS is taken from the cache, where it has been
+* loaded to prepare the reconfiguration.
+*/
+static int write_element_BRAM(virtual_architecture_t *virtual_architecture, int x, int y) {
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  element_info_t *element_info = virtual_architecture->partition[x][y].element.element_info;
+  pblock pblock_1;
+  u32 BRAM_words, work_words;
+  u32 *PBS_last_addr;
+  void *work_memory;
+  int slot, status;
+
+  if (!element_info->PBS_BRAM_contents) {
+    return XST_SUCCESS;
+  }
+  slot = load_element_PBS(engine, element_info - elements);
+  if (slot == -1) {
+    return XST_FAILURE;
+  }
+  partition_pblock(virtual_architecture, x, y, element_info, &pblock_1);
+  BRAM_words = subclock_region_BRAM_words(&pblock_1, 1, &work_words);
+  PBS_last_addr = engine->PBS_cache[slot].PBS_last_addr;
+  if (PBS_last_addr - PBS_cache_slot_addr(engine, slot) < BRAM_words) {
+    return XST_FAILURE;
+  }
+  // The BRAM frames are read back by the DMA, so they do not share cache lines
+  work_memory = malloc(work_words * sizeof(u32) + 64);
+  if (work_memory == NULL) {
+    return XST_FAILURE;
+  }
+
+  reconfig_os_lock(RECONFIG_LOCK_PCAP);
+  enable_PCAP(engine);
+  status = write_subclock_region_BRAM(&engine->xCAP_component, (u32 *) (((u32) work_memory + 31) & ~31), PBS_last_addr - BRAM_words, PBS_last_addr, &pblock_1, 1);
+  reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+  free(work_memory);
+  return status;
+}
+
+static void partition_pblock(virtual_architecture_t *virtual_architecture, int x, int y, element_info_t *element_info, pblock *pblock_1) {
+  pblock_1->X0 = virtual_architecture->partition[x][y].position[X_POS];
+  pblock_1->Y0 = virtual_architecture->partition[x][y].position[Y_POS];
+  pblock_1->Xf = virtual_architecture->partition[x][y].position[X_POS] + element_info->size[WIDTH_POS] - 1;
+  pblock_1->Yf = virtual_architecture->partition[x][y].position[Y_POS] + element_info->size[HEIGHT_POS] - 1;
+}
+
+int prepare_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int element_info) {
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  pblock pblock_1;
+  int buffer, status;
+
+  if (element_info < 0 || element_info >= NUM_ELEMENTS) {
+    return XST_FAILURE;
+  }
+  partition_pblock(virtual_architecture, x, y, &elements[element_info], &pblock_1);
+  if (find_prepared_staging_buffer(engine, &pblock_1, element_info) != -1) {
+    return XST_SUCCESS;
+  }
+
+  buffer = free_staging_buffer(engine);
+  status = prepare_element_PBS(engine, buffer, &elements[element_info], &pblock_1, 0);
+  if (status != XST_SUCCESS) {
+    return XST_FAILURE;
+  }
+  engine->staging_element[buffer] = element_info;
+  engine->staging_pblock[buffer] = pblock_1;
+  engine->staging_last_use[buffer] = ++engine->staging_use_count;
+  return XST_SUCCESS;
+}
+
+int is_partition_element_prepared(virtual_architecture_t *virtual_architecture, int x, int y, int element_info) {
+  pblock pblock_1;
+
+  if (element_info < 0 || element_info >= NUM_ELEMENTS) {
+    return 0;
+  }
+  partition_pblock(virtual_architecture, x, y, &elements[element_info], &pblock_1);
+  return find_prepared_staging_buffer(virtual_architecture->engine, &pblock_1, element_info) != -1;
 }
 
 /*
@@ -144,7 +789,6 @@ static void enable_PCAP() {
 */
 int change_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int element_info) {
   int status;
-  pblock pblock_1;
   
   if (virtual_architecture->partition[x][y].element.element_info == &elements[element_info]) {
     return XST_SUCCESS;
@@ -154,24 +798,12 @@ int change_partition_element(virtual_architecture_t *virtual_architecture, int x
     return XST_SUCCESS;
   }
   
-  virtual_architecture->partition[x][y].element.element_info = &elements[element_info];
-  
-  char *filename = virtual_architecture->partition[x][y].element.element_info->PBS_name;
-  
-  update_partition_location_info(virtual_architecture, x, y);
+  set_partition_element(virtual_architecture, x, y, element_info);
   
-  #if FINE_GRAIN
-    update_partition_fine_grain_info(virtual_architecture, x, y);
-    reset_fine_grain_elements(virtual_architecture, x, y);
-  #endif
-  
-  pblock_1.X0 = virtual_architecture->partition[x][y].position[X_POS];
-  pblock_1.Y0 = virtual_architecture->partition[x][y].position[Y_POS];
-  pblock_1.Xf = virtual_architecture->partition[x][y].position[X_POS] + virtual_architecture->partition[x][y].element.element_info->size[WIDTH_POS] - 1;
-  pblock_1.Yf = virtual_architecture->partition[x][y].position[Y_POS] + virtual_architecture->partition[x][y].element.element_info->size[HEIGHT_POS] - 1;
-  
-  enable_PCAP();
-  status = write_subclock_region_PBS(&xCAP_component, (u32*) INITIAL_ADDR_RAM, filename, &pblock_1, 1, 0, 0);
+  status = write_element_PBS(virtual_architecture, x, y, 0);
+  if (status == XST_SUCCESS) {
+    status = write_element_BRAM(virtual_architecture, x, y);
+  }
   
   return status;
 }
@@ -179,7 +811,6 @@ int change_partition_element(virtual_architecture_t *virtual_architecture, int x
 
 int change_partition_element_stacked_modules(virtual_architecture_t *virtual_architecture, int x, int y, int element_info, u8 first_module, u8 last_module) {
   int status;
-  pblock pblock_1;
   u8 stacked_modules;
 
   if (virtual_architecture->partition[x][y].element.element_info == &elements[element_info]) {
@@ -190,23 +821,8 @@ int change_partition_element_stacked_modules(virtual_architecture_t *virtual_arc
 	  return XST_SUCCESS;
   }
 
-  virtual_architecture->partition[x][y].element.element_info = &elements[element_info];
-
-  char *filename = virtual_architecture->partition[x][y].element.element_info->PBS_name;
+  set_partition_element(virtual_architecture, x, y, element_info);
 
-  update_partition_location_info(virtual_architecture, x, y);
-
-  #if FINE_GRAIN
-    update_partition_fine_grain_info(virtual_architecture, x, y);
-    reset_fine_grain_elements(virtual_architecture, x, y);
-  #endif
-
-  pblock_1.X0 = virtual_architecture->partition[x][y].position[X_POS];
-  pblock_1.Y0 = virtual_architecture->partition[x][y].position[Y_POS];
-  pblock_1.Xf = virtual_architecture->partition[x][y].position[X_POS] + virtual_architecture->partition[x][y].element.element_info->size[WIDTH_POS] - 1;
-  pblock_1.Yf = virtual_architecture->partition[x][y].position[Y_POS] + virtual_architecture->partition[x][y].element.element_info->size[HEIGHT_POS] - 1;
-
-  enable_PCAP();
   if (first_module == 1 && last_module == 0) {
 	  stacked_modules = 1;
   } else if (first_module == 0 && last_module == 0) {
@@ -216,16 +832,149 @@ int change_partition_element_stacked_modules(virtual_architecture_t *virtual_arc
   } else {
 	  stacked_modules = 0;
   }
-  status = write_subclock_region_PBS(&xCAP_component, (u32*) INITIAL_ADDR_RAM, filename, &pblock_1, 1, 0, stacked_modules);
+  status = write_element_PBS(virtual_architecture, x, y, stacked_modules);
+  // The stacked modules share the commit, so the BRAM of this partition is erased apart
+  if (status == XST_SUCCESS && virtual_architecture->partition[x][y].clear_BRAM_pending) {
+    status = clear_partition_BRAM(virtual_architecture, x, y, 0);
+  }
+  // The BRAM content frames are apart from the configuration frames, so they can be written before the commit
+  if (status == XST_SUCCESS) {
+    status = write_element_BRAM(virtual_architecture, x, y);
+  }
 
   return status;
 }
 
+int clear_partition_BRAM(virtual_architecture_t *virtual_architecture, int x, int y, int deferred) {
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  partition_t *partition = &virtual_architecture->partition[x][y];
+  int status;
+
+  if (deferred) {
+    partition->clear_BRAM_pending = 1;
+    return XST_SUCCESS;
+  }
+  if (partition->element.element_info == NULL) {
+    return XST_FAILURE;
+  }
+
+  reconfig_os_lock(RECONFIG_LOCK_PCAP);
+  enable_PCAP(engine);
+  status = PCAP_BRAM_erase(&engine->xCAP_component, partition->location_info.first_column, partition->location_info.first_row, partition->location_info.last_column, partition->location_info.last_row);
+  reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+  if (status == XST_SUCCESS) {
+    partition->clear_BRAM_pending = 0;
+  }
+  return status;
+}
+
+int capture_partition_state(virtual_architecture_t *virtual_architecture, int x, int y, element_state_t *state) {
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  element_info_t *element_info = virtual_architecture->partition[x][y].element.element_info;
+  pblock pblock_1;
+  u32 state_words, work_words;
+  int buffer, status;
+
+  state->element_info = -1;
+  state->memory = NULL;
+  if (element_info == NULL) {
+    return XST_FAILURE;
+  }
+  partition_pblock(virtual_architecture, x, y, element_info, &pblock_1);
+  state_words = subclock_region_state_words(&pblock_1, 1, &work_words);
+  // The BRAM frames are read back by the DMA, so they do not share cache lines
+  state->memory = malloc((state_words + work_words) * sizeof(u32) + 64);
+  if (state->memory == NULL) {
+    return XST_FAILURE;
+  }
+  state->state_first_addr = (u32 *) state->memory;
+  state->work_addr = (u32 *) (((u32) (state->state_first_addr + state_words) + 31) & ~31);
+
+  buffer = free_staging_buffer(engine);
+  reconfig_os_lock(RECONFIG_LOCK_PCAP);
+  enable_PCAP(engine);
+  status = capture_subclock_region_state(&engine->xCAP_component, &engine->staging_buffers[buffer], state->work_addr, &pblock_1, 1, state->state_first_addr, &state->state_last_addr);
+  #if CONFIGURATION_SCRUBBING
+    // GCAPTURE has changed the INIT bits of the frames of the golden images
+    if (engine->scrubber != NULL) {
+      refresh_golden_images(engine->scrubber);
+    }
+  #endif
+  reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+  if (status != XST_SUCCESS) {
+    release_partition_state(state);
+    return XST_FAILURE;
+  }
+  state->element_info = element_info - elements;
+  return XST_SUCCESS;
+}
+
+int restore_partition_state(virtual_architecture_t *virtual_architecture, int x, int y, element_state_t *state) {
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  pblock pblock_1;
+  int buffer, status;
+
+  if (state->element_info < 0 || state->element_info >= NUM_ELEMENTS || state->memory == NULL) {
+    return XST_FAILURE;
+  }
+  set_partition_element(virtual_architecture, x, y, state->element_info);
+  partition_pblock(virtual_architecture, x, y, &elements[state->element_info], &pblock_1);
+
+  buffer = free_staging_buffer(engine);
+  reconfig_os_lock(RECONFIG_LOCK_PCAP);
+  enable_PCAP(engine);
+  status = restore_subclock_region_state(&engine->xCAP_component, &engine->staging_buffers[buffer], state->work_addr, state->state_first_addr, state->state_last_addr, &pblock_1, 1);
+  #if CONFIGURATION_SCRUBBING
+    if (engine->scrubber != NULL) {
+      if (status == XST_SUCCESS) {
+        record_golden_image(engine->scrubber, &engine->staging_buffers[buffer], state->element_info);
+      }
+      // GCAPTURE has changed the INIT bits of the frames of the golden images
+      refresh_golden_images(engine->scrubber);
+    }
+  #endif
+  reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+  invalidate_staging_buffers(engine, buffer);
+  if (status != XST_SUCCESS) {
+    virtual_architecture->partition[x][y].element.element_info = NULL;
+    return XST_FAILURE;
+  }
+  // The BRAM contents have been restored too
+  virtual_architecture->partition[x][y].clear_BRAM_pending = 0;
+  return XST_SUCCESS;
+}
+
+void release_partition_state(element_state_t *state) {
+  free(state->memory);
+  state->memory = NULL;
+  state->element_info = -1;
+}
+
 void change_partition_position(virtual_architecture_t *virtual_architecture, int x, int y, int position_x, int position_y) {
+  // The location info depends on the size of the element so it is updated when a new element is allocated
   virtual_architecture->partition[x][y].element.element_info = NULL;
   virtual_architecture->partition[x][y].position[X_POS] = position_x;
   virtual_architecture->partition[x][y].position[Y_POS] = position_y;
+}
+
+/*
+* Allocates an element in a partition: the transition is recorded and the
+* location and the fine-grain information of the partition are updated
+*/
+static void set_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int element_info) {
+  #if PREDICTIVE_PREFETCH
+    if (virtual_architecture->partition[x][y].element.element_info != &elements[element_info]) {
+      record_element_transition(virtual_architecture, x, y, element_info);
+    }
+  #endif
+  virtual_architecture->partition[x][y].element.element_info = &elements[element_info];
+
   update_partition_location_info(virtual_architecture, x, y);
+
+  #if FINE_GRAIN
+    update_partition_fine_grain_info(virtual_architecture, x, y);
+    reset_fine_grain_elements(virtual_architecture, x, y);
+  #endif
 }
 
 static void update_partition_location_info(virtual_architecture_t *virtual_architecture, int x, int y) {
@@ -245,50 +994,58 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
 
 #if FINE_GRAIN
 
-  static void enable_ICAP() {
-    XDcfg_SelectIcapInterface(&xCAP_component);
+  static void enable_ICAP(reconfiguration_engine_t *engine) {
+    CAP_select_interface(&engine->xCAP_component, CAP_INTERFACE_ICAP);
   }
 
   /*
-  * TODO in this first version the midle+fine grain support is only possible with blocks
-  * completely contained in a clock region row (it can not cross vertical clock regions)
-  * if a PR is bigger than a clock region it must occupy the full heigh of the lowest
-  * clock region row.
+  * Fine-grain components can cross vertical clock regions. Inside each column the
+  * components are placed from the lowest to the highest clock region row of the
+  * partition and then they continue in the next column. Each piece of a component
+  * that is placed in a different clock region row or column uses a different frame
+  * (i.e. a different frame address) and the number of pieces is limited by
+  * MAX_CLOCK_ROWS_PER_ELEMENT.
   * NOTE for the next version it could be possible to use the pblock parameter even in the
   * RP and therefore have pblocks inside pblocks. Para esto lo que podemos hacer es guardar los 2 pblocks
   * el original y el de grano fino y con los 2 sacar el tamaño del pblock y la ubicacion de las constantes.
   * En la proxima version permitir cualquier combinacion.
   */
 
-  static void init_constant_frames() {
+  static void init_constant_frames(reconfiguration_engine_t *engine) {
     int i, j;
     for (i = 0; i < MAX_COLUMNS_CONSTANTS; i++) {
-      constant_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
-      constant_t_frames[i].frame_address = 0;
+      engine->constant_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
+      engine->constant_t_frames[i].frame_address = 0;
+      engine->constant_t_frames[i].written = 0;
       for (j = 0; j < WORDS_PER_CONSTANTS; j++) {
-        constant_t_frames[i].value[j] = 0;
+        engine->constant_t_frames[i].value[j] = 0;
+        engine->constant_t_frames[i].written_value[j] = 0;
       }
     }
   }
 
-  static void init_mux_frames() {
+  static void init_mux_frames(reconfiguration_engine_t *engine) {
     int i, j;
     for (i = 0; i < MAX_COLUMNS_MUX; i++) {
-      mux_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
-      mux_t_frames[i].frame_address = 0;
+      engine->mux_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
+      engine->mux_t_frames[i].frame_address = 0;
+      engine->mux_t_frames[i].written = 0;
       for (j = 0; j < WORDS_PER_MUX; j++) {
-        mux_t_frames[i].value[j] = 0;
+        engine->mux_t_frames[i].value[j] = 0;
+        engine->mux_t_frames[i].written_value[j] = 0;
       }
     }
   }
 
-  static void init_FU_frames() {
+  static void init_FU_frames(reconfiguration_engine_t *engine) {
     int i, j;
     for (i = 0; i < MAX_COLUMNS_FU; i++) {
-      FU_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
-      FU_t_frames[i].frame_address = 0;
+      engine->FU_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
+      engine->FU_t_frames[i].frame_address = 0;
+      engine->FU_t_frames[i].written = 0;
       for (j = 0; j < WORDS_PER_FU; j++) {
-        FU_t_frames[i].value[j] = 0;
+        engine->FU_t_frames[i].value[j] = 0;
+        engine->FU_t_frames[i].written_value[j] = 0;
       }
     }
   }
@@ -426,6 +1183,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
   #define BITS_PER_CLB 		  8
   #define MAX_BITS_IN_CLOCK_ROW 400
   static int calculate_constant_parameters(virtual_architecture_t *virtual_architecture, int x, int y, int first_clock_row, int last_clock_row, int first_row, int last_row, int *column, int offset) {
+    reconfiguration_engine_t *engine = virtual_architecture->engine;
     int i, j, k;
     int first_bit_first_clock_row, last_bit_first_clock_row, first_bit_last_clock_row, last_bit_last_clock_row;
     int first_bit_in_column, last_bit_in_column, total_bits_to_send, bits_to_send;
@@ -455,17 +1213,22 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
       total_bits_to_send = virtual_architecture->partition[x][y].element.element_info->num_bits_in_constant[i];
       j = 0;
       while (total_bits_to_send > 0) {
+        if (j >= MAX_COLUMNS_CONSTANT_PER_ELEMENT) {
+          return -1;
+        }
         frame_address = obtain_frame_address_of_CLB_column(virtual_architecture, x, y, clock_row_number, *column);
         if (frame_address == -1) {
           return -1;
         }
         for (k = 0; k < MAX_COLUMNS_CONSTANTS; k++) {
           // We search for an empty frame address or for a previous equal frame address.
-          if (constant_t_frames[k].frame_address != frame_address && constant_t_frames[k].frame_address != 0) {
+          if (engine->constant_t_frames[k].frame_address != frame_address && engine->constant_t_frames[k].frame_address != 0) {
             continue;
           }
           else {
-            constant_t_frames[k].frame_address = frame_address;
+            engine->constant_t_frames[k].frame_address = frame_address;
+            // The frame has been overwritten by the PBS of the new element
+            engine->constant_t_frames[k].written = 0;
             break;
           }
         }
@@ -519,6 +1282,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
   #define LUTS_PER_CLB 		  4
 
   static int calculate_mux_parameters(virtual_architecture_t *virtual_architecture, int x, int y, int first_clock_row, int last_clock_row, int first_row, int last_row, int *column, int offset) {
+    reconfiguration_engine_t *engine = virtual_architecture->engine;
     int i,j,k;
     int first_LUT_first_clock_row, last_LUT_first_clock_row, first_LUT_last_clock_row, last_LUT_last_clock_row;
     int LUT_position, num_inputs, total_LUTs_to_send, LUTs_to_send;
@@ -553,17 +1317,22 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
       j = 0;
       LUT_position = 0;
       while (total_LUTs_to_send > 0) {
+        if (j >= MAX_COLUMNS_MUX_PER_ELEMENT) {
+          return -1;
+        }
         frame_address = obtain_frame_address_of_CLB_column(virtual_architecture, x, y, clock_row_number, *column);
         if (frame_address == -1) {
           return -1;
         }
         for (k = 0; k < MAX_COLUMNS_MUX; k++) {
           // We search for an empty frame address or for a previous equal frame address.
-          if (mux_t_frames[k].frame_address != frame_address && mux_t_frames[k].frame_address != 0) {
+          if (engine->mux_t_frames[k].frame_address != frame_address && engine->mux_t_frames[k].frame_address != 0) {
             continue;
           }
           else {
-            mux_t_frames[k].frame_address = frame_address;
+            engine->mux_t_frames[k].frame_address = frame_address;
+            // The frame has been overwritten by the PBS of the new element
+            engine->mux_t_frames[k].written = 0;
             break;
           }
         }
@@ -614,6 +1383,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
   #define CLBS_IN_COLUMN	50
 
   static int calculate_FU_parameters(virtual_architecture_t *virtual_architecture, int x, int y, int first_clock_row, int last_clock_row, int first_row, int last_row, int *column, int offset) {
+    reconfiguration_engine_t *engine = virtual_architecture->engine;
     int i,j,k;
     int first_block_first_clock_row, last_block_first_clock_row, first_block_last_clock_row, last_block_last_clock_row;
     int first_block_in_column, last_block_in_column, total_blocks_to_send;
@@ -646,17 +1416,22 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
       total_blocks_to_send = 2*virtual_architecture->partition[x][y].element.element_info->FU_4_bit_blocks[i];
       j = 0;
       while (total_blocks_to_send > 0) {
+        if (j >= MAX_COLUMNS_FU_PER_ELEMENT) {
+          return -1;
+        }
         frame_address = obtain_frame_address_of_CLB_column(virtual_architecture, x, y, clock_row_number, (*column));
         if (frame_address == -1) {
           return -1;
         }
         for (k = 0; k < MAX_COLUMNS_FU; k++) {
           // We search for an empty frame address or for a previous equal frame address.
-          if (FU_t_frames[k].frame_address != frame_address && FU_t_frames[k].frame_address != 0) {
+          if (engine->FU_t_frames[k].frame_address != frame_address && engine->FU_t_frames[k].frame_address != 0) {
             continue;
           }
           else {
-            FU_t_frames[k].frame_address = frame_address;
+            engine->FU_t_frames[k].frame_address = frame_address;
+            // The frame has been overwritten by the PBS of the new element
+            engine->FU_t_frames[k].written = 0;
             break;
           }
         }
@@ -692,7 +1467,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
             last_block_in_column = last_block_last_clock_row;
           } else {
             first_block_in_column = 0;
-            last_block_in_column = MAX_BITS_IN_CLOCK_ROW - 1;
+            last_block_in_column = CLBS_IN_COLUMN - 1;
           }
         }
         j++;
@@ -775,14 +1550,14 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
 
   static void reset_fine_grain_elements(virtual_architecture_t *virtual_architecture, int x, int y) {
     int i;
-    for (i = 0; i < MAX_CONSTANTS; i++) {
+    for (i = 0; i < virtual_architecture->max_constants; i++) {
       virtual_architecture->partition[x][y].element.constants_definition[i].initialized = 0;
     }
-    for (i = 0; i < MAX_MUXES; i++) {
+    for (i = 0; i < virtual_architecture->max_muxes; i++) {
       virtual_architecture->partition[x][y].element.mux_definition[i].initialized = 0;
     }
-    for (i = 0; i < MAX_FU; i++) {
-      virtual_architecture->partition[x][y].element.mux_definition[i].initialized = 0;
+    for (i = 0; i < virtual_architecture->max_FU; i++) {
+      virtual_architecture->partition[x][y].element.FU_definition[i].initialized = 0;
     }
   }
 
@@ -799,7 +1574,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
   *
   * NOTE in overlays constant columns come first then mux columns and finally FUs.
   */
-  void change_partition_constant(virtual_architecture_t *virtual_architecture, int x, int y, int constant_number, uint32_t value[MAX_WORDS_PER_CONSTANT]) {
+  void change_partition_constant(virtual_architecture_t *virtual_architecture, int x, int y, int constant_number, const uint32_t value[MAX_WORDS_PER_CONSTANT]) {
       int i;
       int total_bits_to_send, bits_sent, first_bit, last_bit, bits_to_send;
       uint32_t frame_address_position;
@@ -808,17 +1583,24 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
 
       #if SEARCH_IF_FINE_GRAIN_VALUE_HAS_CHANGED == 1
         int same_value = 1;
+        uint32_t word_mask;
 
-      for (i = 0; i <= ((total_bits_to_send-1)/32); i++) {
-        if (value[i] != virtual_architecture->partition[x][y].element.constants_definition[constant_number].value[i]) {
-          same_value = 0;
-          virtual_architecture->partition[x][y].element.constants_definition[constant_number].value[i] = value[i];
+        for (i = 0; i <= ((total_bits_to_send-1)/32); i++) {
+          // Only the bits that belong to the constant are compared
+          if (i == ((total_bits_to_send-1)/32) && (total_bits_to_send % 32) != 0) {
+            word_mask = (0x1u << (total_bits_to_send % 32)) - 1;
+          } else {
+            word_mask = 0xFFFFFFFF;
+          }
+          if ((value[i] & word_mask) != (virtual_architecture->partition[x][y].element.constants_definition[constant_number].value[i] & word_mask)) {
+            same_value = 0;
+            virtual_architecture->partition[x][y].element.constants_definition[constant_number].value[i] = value[i];
+          }
+        }
+        // The constant already has that value, the frames are not marked to be reconfigured
+        if (same_value == 1 && virtual_architecture->partition[x][y].element.constants_definition[constant_number].initialized == 1) {
+          return;
         }
-      }
-      // The constant already has that value
-      if (same_value == 1 && virtual_architecture->partition[x][y].element.constants_definition[constant_number].initialized == 1) {
-        return;
-      }
 
         virtual_architecture->partition[x][y].element.constants_definition[constant_number].initialized = 1;
       #endif
@@ -830,67 +1612,73 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
         first_bit = virtual_architecture->partition[x][y].element.first_bit_in_frame[constant_number][i];
         last_bit = virtual_architecture->partition[x][y].element.last_bit_in_frame[constant_number][i];
         bits_to_send = last_bit + 1 - first_bit;
- 		if ((bits_to_send == 32) && ((first_bit % 32) == 0)) {
- 			constant_t_frames[frame_address_position].value[first_bit/32] = value[0];
- 			constant_frames_flags[frame_address_position] = RECONFIGURE_FRAME;
- 			return;
- 		} else if ((bits_to_send == 16) && ((first_bit % 16) == 0)) {
- 			//tmp = first_bit/32;
- 			if ((first_bit%32) == 0) {
- 				constant_t_frames[frame_address_position].value[first_bit/32] = (constant_t_frames[frame_address_position].value[first_bit/32]&0xFFFF0000) | (value[0]&0x0000FFFF);
- 			} else {
- 				constant_t_frames[frame_address_position].value[first_bit/32] = (constant_t_frames[frame_address_position].value[first_bit/32]&0x0000FFFF) | (value[0]<<16);
- 			}
- 			constant_frames_flags[frame_address_position] = RECONFIGURE_FRAME;
- 			return;
-         } else {
- 			change_constant_frame_address(frame_address_position, first_bit, last_bit, bits_sent, &value[0]);
- 		}
- 		//change_constant_frame_address(frame_address_position, first_bit, last_bit, bits_sent, &value[0]);
+        change_constant_frame_address(virtual_architecture->engine, frame_address_position, first_bit, last_bit, bits_sent, value);
         i++;
         bits_sent += bits_to_send;
       }
     }
 
-   static void change_constant_frame_address(uint32_t frame_address_position, int first_bit, int last_bit, int previous_bits_sent, uint32_t *value) {
-      uint32_t first_frame_word, first_frame_bit, last_frame_word, last_frame_bit, frame_mask;
-      uint32_t aux_value;
-      uint32_t j, k;
+  int change_partition_constant_bank(virtual_architecture_t *virtual_architecture, int x, int y, int first_constant, int num_constants, const uint32_t *values) {
+    int i;
+
+    if (virtual_architecture->partition[x][y].element.element_info == NULL || first_constant < 0 || num_constants < 0 ||
+        first_constant + num_constants > virtual_architecture->partition[x][y].element.element_info->num_constants) {
+      return XST_FAILURE;
+    }
 
-  	constant_frames_flags[frame_address_position] = RECONFIGURE_FRAME;
+    for (i = 0; i < num_constants; i++) {
+      change_partition_constant(virtual_architecture, x, y, first_constant + i, &values[i * MAX_WORDS_PER_CONSTANT]);
+    }
+    return XST_SUCCESS;
+  }
 
- 	if (((last_bit + 1 - first_bit) == 32) && ((first_bit % 32) == 0)) {
- 		constant_t_frames[frame_address_position].value[first_bit/32] = value[0];
- 		return;
- 	}
+  /*
+  * The bits of the constant are copied in blocks of up to 32 bits: each frame
+  * word is updated with one mask operation using the bits of the (at most two)
+  * words of the constant value that are aligned with it.
+  */
+  static void change_constant_frame_address(reconfiguration_engine_t *engine, uint32_t frame_address_position, int first_bit, int last_bit, int previous_bits_sent, const uint32_t *value) {
+    uint32_t first_frame_word, first_frame_bit, last_frame_word, last_frame_bit, frame_mask;
+    uint32_t aux_value, num_bits, value_word, value_bit;
+    uint32_t j;
 
-  	first_frame_word = first_bit / 32;
-  	last_frame_word = last_bit / 32;
+    engine->constant_frames_flags[frame_address_position] = RECONFIGURE_FRAME;
 
+    first_frame_word = first_bit / 32;
+    last_frame_word = last_bit / 32;
 
-  	for (j = first_frame_word; j <= last_frame_word; j++) {
-  	if (j == first_frame_word) {
-  	  first_frame_bit = (first_bit % 32);
-  	} else {
-  	  first_frame_bit = 0;
-  	}
-  	if (j == last_frame_word) {
-  	  last_frame_bit = (last_bit % 32);
-  	} else {
-  	  last_frame_bit = 31;
-  	}
+    for (j = first_frame_word; j <= last_frame_word; j++) {
+      if (j == first_frame_word) {
+        first_frame_bit = (first_bit % 32);
+      } else {
+        first_frame_bit = 0;
+      }
+      if (j == last_frame_word) {
+        last_frame_bit = (last_bit % 32);
+      } else {
+        last_frame_bit = 31;
+      }
+      num_bits = last_frame_bit + 1 - first_frame_bit;
+
+      // Bits [previous_bits_sent, previous_bits_sent + num_bits) of the constant
+      value_word = previous_bits_sent / 32;
+      value_bit = previous_bits_sent % 32;
+      aux_value = value[value_word] >> value_bit;
+      if (value_bit != 0 && value_bit + num_bits > 32) {
+        aux_value |= value[value_word + 1] << (32 - value_bit);
+      }
 
-  	aux_value = 0;
-  	frame_mask = 0;
-  	for (k = first_frame_bit; k <= last_frame_bit; k++) {
-  	  frame_mask |= (0x1 << k);
-  	  aux_value |= ((value[previous_bits_sent/32] >> (previous_bits_sent % 32)) & 1) << k;
-  	  previous_bits_sent++;
-  	}
+      if (num_bits == 32) {
+        frame_mask = 0xFFFFFFFF;
+      } else {
+        frame_mask = ((0x1u << num_bits) - 1) << first_frame_bit;
+      }
+      aux_value = (aux_value << first_frame_bit) & frame_mask;
 
-  	constant_t_frames[frame_address_position].value[j] = (constant_t_frames[frame_address_position].value[j] & (~frame_mask)) | aux_value;
-  	}
+      engine->constant_t_frames[frame_address_position].value[j] = (engine->constant_t_frames[frame_address_position].value[j] & (~frame_mask)) | aux_value;
+      previous_bits_sent += num_bits;
     }
+  }
 
 
   void change_partition_mux(virtual_architecture_t *virtual_architecture, int x, int y, int mux_number, int value) {
@@ -905,7 +1693,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
        virtual_architecture->partition[x][y].element.mux_definition[mux_number].value = value;
       }
 
-      // The constant already has that value
+      // The mux already has that value, the frames are not marked to be reconfigured
       if (same_value == 1 && virtual_architecture->partition[x][y].element.mux_definition[mux_number].initialized == 1) {
        return;
       }
@@ -923,20 +1711,20 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
       last_LUT = virtual_architecture->partition[x][y].element.last_LUT_in_frame[mux_number][i];
       LUTs_to_send = last_LUT + 1 - first_LUT;
       LUT_position = virtual_architecture->partition[x][y].element.LUT_position_in_frame[mux_number][i];
-      change_mux_frame_address(frame_address_position, first_LUT, last_LUT, value, LUT_position , num_inputs);
+      change_mux_frame_address(virtual_architecture->engine, frame_address_position, first_LUT, last_LUT, value, LUT_position , num_inputs);
       LUTs_sent += LUTs_to_send;
       i++;
     }
   }
 
-  static void change_mux_frame_address(uint32_t frame_address_position, int first_LUT, int last_LUT, int value, int LUT_position, int num_inputs) {
+  static void change_mux_frame_address(reconfiguration_engine_t *engine, uint32_t frame_address_position, int first_LUT, int last_LUT, int value, int LUT_position, int num_inputs) {
     uint32_t first_frame_word, first_frame_LUT, last_frame_word, last_frame_LUT, frame_mask;
     uint32_t aux_value;
     uint32_t j, k;
     
     
     
-    mux_frames_flags[frame_address_position] = RECONFIGURE_FRAME;
+    engine->mux_frames_flags[frame_address_position] = RECONFIGURE_FRAME;
     
     first_frame_word = first_LUT / 16;
     last_frame_word = last_LUT / 16;
@@ -970,7 +1758,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
         }
         LUT_position = (LUT_position + 1) % (((num_inputs - 2) / 3) + 1);
       }
-      mux_t_frames[frame_address_position].value[j] = (mux_t_frames[frame_address_position].value[j] & (~frame_mask)) | aux_value;
+      engine->mux_t_frames[frame_address_position].value[j] = (engine->mux_t_frames[frame_address_position].value[j] & (~frame_mask)) | aux_value;
     }
   }
 
@@ -987,7 +1775,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
        virtual_architecture->partition[x][y].element.FU_definition[FU_number].value = value;
       }
 
-      // The constant already has that value
+      // The FU already has that value, the frames are not marked to be reconfigured
       if (same_value == 1 && virtual_architecture->partition[x][y].element.FU_definition[FU_number].initialized == 1) {
        return;
       }
@@ -1003,7 +1791,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
       first_block = virtual_architecture->partition[x][y].element.first_FU_block_in_frame[FU_number][i];
       last_block = virtual_architecture->partition[x][y].element.last_FU_block_in_frame[FU_number][i];
       blocks_to_send = last_block + 1 - first_block;
-      change_FU_frame_address(frame_address_position, first_block, last_block, (int) value);
+      change_FU_frame_address(virtual_architecture->engine, frame_address_position, first_block, last_block, (int) value);
       i++;
       blocks_sent += blocks_to_send;
     }
@@ -1011,12 +1799,12 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
 
   #define BITS_PER_BLOCK 	5
   #define BLOCK_PER_WORD    (32 / BITS_PER_BLOCK)
-  static void change_FU_frame_address(uint32_t frame_address_position, int first_block, int last_block, int value) {
+  static void change_FU_frame_address(reconfiguration_engine_t *engine, uint32_t frame_address_position, int first_block, int last_block, int value) {
     uint32_t first_frame_word, first_frame_block, last_frame_word, last_frame_block, frame_mask;
     uint32_t aux_value;
     uint32_t j, k;
     
-    FU_frames_flags[frame_address_position] = RECONFIGURE_FRAME;
+    engine->FU_frames_flags[frame_address_position] = RECONFIGURE_FRAME;
     
     first_frame_word = first_block / BLOCK_PER_WORD;
     last_frame_word = last_block / BLOCK_PER_WORD;
@@ -1041,7 +1829,7 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
         frame_mask |= (0x1F << k*5);
         aux_value |= value << k*5;
       }
-      FU_t_frames[frame_address_position].value[j] = (FU_t_frames[frame_address_position].value[j] & (~frame_mask)) | aux_value;
+      engine->FU_t_frames[frame_address_position].value[j] = (engine->FU_t_frames[frame_address_position].value[j] & (~frame_mask)) | aux_value;
     }
   }
 
@@ -1155,72 +1943,119 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
   /*
   *
   */
-  void reconfigure_fine_grain() {
-    reconfigure_constants();
-    reconfigure_muxes();
-    reconfigure_FU();
+  void reconfigure_fine_grain(reconfiguration_engine_t *engine) {
+    // The fine-grain frames may be in any region read back in advance
+    invalidate_staging_buffers(engine, -1);
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
+    reconfigure_constants(engine);
+    reconfigure_muxes(engine);
+    reconfigure_FU(engine);
+    #if CONFIGURATION_SCRUBBING
+      // The golden images do not contain the fine-grain frames
+      if (engine->scrubber != NULL) {
+        refresh_golden_images(engine->scrubber);
+      }
+    #endif
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
   }
 
-  void reconfigure_constants() {
+  void reconfigure_constants(reconfiguration_engine_t *engine) {
     int i, j;
     uint32_t xfar;
-    enable_ICAP();
     for (i = 0; i < MAX_COLUMNS_CONSTANTS; i++) {
-      if (constant_frames_flags[i] == RECONFIGURE_FRAME) {
-        constant_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
-        while (ICAP[0] & 0x1) { }  // wait for ack (mandatory)
+      if (engine->constant_frames_flags[i] == RECONFIGURE_FRAME) {
+        engine->constant_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
+        #if SEARCH_IF_FINE_GRAIN_VALUE_HAS_CHANGED == 1
+          // The final image of the frame is the one already written in the FPGA
+          if (!frame_has_changed(engine->constant_t_frames[i].value, engine->constant_t_frames[i].written_value, &engine->constant_t_frames[i].written, WORDS_PER_CONSTANTS)) {
+            continue;
+          }
+        #endif
+        enable_ICAP(engine); // Only selected if a frame is written
+        while (ICAP[0] & 0x1) { reconfig_os_yield(); }  // wait for ack (mandatory)
         for (j = 0; j < WORDS_PER_CONSTANTS; j++) {
-          ICAP[j+1] = constant_t_frames[i].value[j];
+          ICAP[j+1] = engine->constant_t_frames[i].value[j];
         }
-        xfar = obtain_XFAR(CONST_TYPE, 1, constant_t_frames[i].frame_address);
+        xfar = obtain_XFAR(CONST_TYPE, 1, engine->constant_t_frames[i].frame_address);
         ICAP[0] = xfar; // send XFAR and start reconfiguration!
       }
     }
-    while (ICAP[0] != 0);
+    while (ICAP[0] != 0) { reconfig_os_yield(); }
   }
 
-  void reconfigure_muxes() {
+  void reconfigure_muxes(reconfiguration_engine_t *engine) {
     int i, j;
     uint32_t xfar;
-    enable_ICAP();
     for (i = 0; i < MAX_COLUMNS_MUX; i++) {
-      if (mux_frames_flags[i] == RECONFIGURE_FRAME) {
-        mux_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
-        while (ICAP[0] & 0x1) { }  // wait for ack (mandatory)
+      if (engine->mux_frames_flags[i] == RECONFIGURE_FRAME) {
+        engine->mux_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
+        #if SEARCH_IF_FINE_GRAIN_VALUE_HAS_CHANGED == 1
+          // The final image of the frame is the one already written in the FPGA
+          if (!frame_has_changed(engine->mux_t_frames[i].value, engine->mux_t_frames[i].written_value, &engine->mux_t_frames[i].written, WORDS_PER_MUX)) {
+            continue;
+          }
+        #endif
+        enable_ICAP(engine); // Only selected if a frame is written
+        while (ICAP[0] & 0x1) { reconfig_os_yield(); }  // wait for ack (mandatory)
         for (j = 0; j < WORDS_PER_MUX; j++) {
-          ICAP[j+1] = mux_t_frames[i].value[j];
+          ICAP[j+1] = engine->mux_t_frames[i].value[j];
         }
-        xfar = obtain_XFAR(MUX_TYPE, 1, mux_t_frames[i].frame_address);
+        xfar = obtain_XFAR(MUX_TYPE, 1, engine->mux_t_frames[i].frame_address);
         ICAP[0] = xfar; // send XFAR and start reconfiguration!
       }
     }
-    while (ICAP[0] != 0);
+    while (ICAP[0] != 0) { reconfig_os_yield(); }
   }
 
 
-  void reconfigure_FU() {
+  void reconfigure_FU(reconfiguration_engine_t *engine) {
     int i, j;
     uint32_t xfar;
-    enable_ICAP();
     for (i = 0; i < MAX_COLUMNS_FU; i++) {
-      if (FU_frames_flags[i] == RECONFIGURE_FRAME) {
-        FU_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
-        while (ICAP[0] & 0x1) { }  // wait for ack (mandatory)
+      if (engine->FU_frames_flags[i] == RECONFIGURE_FRAME) {
+        engine->FU_frames_flags[i] = DO_NOT_RECONFIGURE_FRAME;
+        #if SEARCH_IF_FINE_GRAIN_VALUE_HAS_CHANGED == 1
+          // The final image of the frame is the one already written in the FPGA
+          if (!frame_has_changed(engine->FU_t_frames[i].value, engine->FU_t_frames[i].written_value, &engine->FU_t_frames[i].written, WORDS_PER_FU)) {
+            continue;
+          }
+        #endif
+        enable_ICAP(engine); // Only selected if a frame is written
+        while (ICAP[0] & 0x1) { reconfig_os_yield(); }  // wait for ack (mandatory)
         for (j = 0; j < WORDS_PER_FU; j++) {
-          ICAP[j+1] = FU_t_frames[i].value[j];
+          ICAP[j+1] = engine->FU_t_frames[i].value[j];
         }
-        xfar = obtain_XFAR(FU_TYPE, 2, FU_t_frames[i].frame_address);
+        xfar = obtain_XFAR(FU_TYPE, 2, engine->FU_t_frames[i].frame_address);
         ICAP[0] = xfar; // send XFAR and start reconfiguration!
       }
     }
-    while (ICAP[0] != 0);
+    while (ICAP[0] != 0) { reconfig_os_yield(); }
   }
 
 
-  void load_fine_grain_PBS() {
+  /*
+  * Compares the image of a fine-grain frame with the image that was written the
+  * last time. If they are different the written image is updated as the frame
+  * is going to be reconfigured.
+  */
+  static int frame_has_changed(const uint32_t *value, uint32_t *written_value, int8_t *written, int num_words) {
+    int i, changed;
+
+    changed = (*written == 0);
+    for (i = 0; i < num_words; i++) {
+      if (written_value[i] != value[i]) {
+        written_value[i] = value[i];
+        changed = 1;
+      }
+    }
+    *written = 1;
+    return changed;
+  }
+
+  void load_fine_grain_PBS(reconfiguration_engine_t *engine) {
     load_constant_PBS();
     load_mux_PBS();
-    load_FU();
+    load_FU(engine);
   }
 
   #define OFFSET_MUX_PBS    16
@@ -1288,28 +2123,23 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
 
   // Frame:    1st  2nd
   //           <--><-->
-  #define A6 0x00FF00FF
-  #define A5 0x0F0F0F0F
+  #define A6 FU_CARRY
+  #define A5 FU_IN1_S1
   //      A4 (unused)
-  #define A3 0x33333333
-  #define A2 0x55555555
-  #define A1 0x0000FFFF
+  #define A3 FU_IN2_S1
+  #define A2 FU_IN1_S2
+  #define A1 FU_IN2_S2
 
   #define IN1_S1  A5  // north (1st stage)
   #define IN2_S1  A3  // west  (1st stage)
   #define IN1_S2 A2  // north (2nd stage)
   #define IN2_S2 A1  // west  (2nd stage)
-  #define S  A3  // sum   (mod 256)
-  #define S2 A5  // sum/2 (rounded down)
-  #define C  A6  // carry (overflow)
+  #define S  FU_SUM  // sum   (mod 256)
+  #define S2 FU_HALF_SUM  // sum/2 (rounded down)
+  #define C  FU_CARRY  // carry (overflow)
   #define FF 0xFFFFFFFF // all ones
 
-  #define ADD(a,b) (( /* O5: */ ((a)&(b)) & ~A6 ) | ( /* O6: */ ((a)^(b)) & A6 ))
-  #define SAT(noovf, ovf)  (( (noovf) & ~C ) | ( (ovf) & C ))
-  #define FUNC(a,b, noovf,ovf)  { ADD((a), (b)),  SAT((noovf), (ovf)) }
-
-
-  #define NUM_FU_FUNCTIONS 18
+  #define FUNC(a,b, noovf,ovf)  { FU_STAGE1((a), (b)),  FU_STAGE2((noovf), (ovf)) }
 
   //IN1_S1 --> first operand
   //IN2_S1 --> second operand
@@ -1340,31 +2170,85 @@ static void update_partition_location_info(virtual_architecture_t *virtual_archi
   #define OFFSET_FU_PBS    (256*4) //2 pow 8
   #define PE_SIZE			 8
   #define FU_MEM_BASE_ADDR (ICAP_MEM_BASEADDR + OFFSET_FU_PBS)
-  void load_FU() {
-    volatile uint32_t (*PE_ADDR)[PE_SIZE] = (volatile uint32_t (*)[PE_SIZE]) FU_MEM_BASE_ADDR;
+  /**
+   * The FU memory of the fine-grain reconfiguration engine is a table of slots of
+   * PE_SIZE words. The first NUM_FU_FUNCTIONS slots contain the predefined
+   * functions and the rest can be used by register_FU_function().
+   */
+  static void load_FU(reconfiguration_engine_t *engine) {
     int i;
-    for (i=0; i<NUM_FU_FUNCTIONS; i++) {
-      uint32_t f1_stage1, f2_stage1, f1_stage2, f2_stage2; //Estos son los frames 1 y 2.
-      
-      // Stage 1 (2 frames; ABOVE stage 2)
-      f1_stage1 = f2_stage1 = lut_functions[i][0];
-      f1_stage1 = f1_stage1 >> 16;    // frame 1
-      f2_stage1 = f2_stage1 & 0xFFFF; // frame 2
+    for (i = 0; i < MAX_FU_FUNCTIONS; i++) {
+      engine->FU_function_slot_used[i] = 0;
+    }
+    for (i = 0; i < NUM_FU_FUNCTIONS; i++) {
+      engine->FU_function_table[i][0] = lut_functions[i][0];
+      engine->FU_function_table[i][1] = lut_functions[i][1];
+      engine->FU_function_slot_used[i] = 1;
+      if (i < num_FU_slots()) {
+        write_FU_slot(i, lut_functions[i][0], lut_functions[i][1]);
+      }
+    }
+  }
 
+  static int num_FU_slots() {
+    int slots = (ICAP_MEM_HIGHADDR + 1 - FU_MEM_BASE_ADDR) / (PE_SIZE * sizeof(uint32_t));
+    if (slots > MAX_FU_FUNCTIONS) {
+      slots = MAX_FU_FUNCTIONS;
+    }
+    return slots;
+  }
 
-      // Stage 2 (2 frames; BELOW stage 1)
-      f1_stage2 = f2_stage2 = lut_functions[i][1];
-      f1_stage2 = f1_stage2 >> 16;    // frame 1
-      f2_stage2 = f2_stage2 & 0xFFFF; // frame 2
-      
-      for (int j=0; j<2; j++) {
-    	  PE_ADDR[i][j] = f1_stage2<<16 | f1_stage1;
-      }
-      for (int j=4; j<6; j++) {
-		  PE_ADDR[i][j] = f2_stage2<<16 | f2_stage1;
+  static void write_FU_slot(int slot, uint32_t stage1, uint32_t stage2) {
+    volatile uint32_t (*PE_ADDR)[PE_SIZE] = (volatile uint32_t (*)[PE_SIZE]) FU_MEM_BASE_ADDR;
+    uint32_t f1_stage1, f2_stage1, f1_stage2, f2_stage2; //Estos son los frames 1 y 2.
+    int j;
+
+    // Stage 1 (2 frames; ABOVE stage 2)
+    f1_stage1 = stage1 >> 16;    // frame 1
+    f2_stage1 = stage1 & 0xFFFF; // frame 2
+
+    // Stage 2 (2 frames; BELOW stage 1)
+    f1_stage2 = stage2 >> 16;    // frame 1
+    f2_stage2 = stage2 & 0xFFFF; // frame 2
+
+    for (j = 0; j < 2; j++) {
+      PE_ADDR[slot][j] = f1_stage2<<16 | f1_stage1;
+    }
+    for (j = 4; j < 6; j++) {
+      PE_ADDR[slot][j] = f2_stage2<<16 | f2_stage1;
+    }
+  }
+
+  int register_FU_function(reconfiguration_engine_t *engine, uint32_t stage1, uint32_t stage2) {
+    int i, free_slot = -1;
+
+    // The predefined functions always use the first slots
+    for (i = NUM_FU_FUNCTIONS; i < num_FU_slots(); i++) {
+      if (engine->FU_function_slot_used[i]) {
+        if (engine->FU_function_table[i][0] == stage1 && engine->FU_function_table[i][1] == stage2) {
+          return i;
+        }
+      } else if (free_slot == -1) {
+        free_slot = i;
       }
     }
-    
+    if (free_slot == -1) {
+      return -1;
+    }
+
+    engine->FU_function_table[free_slot][0] = stage1;
+    engine->FU_function_table[free_slot][1] = stage2;
+    engine->FU_function_slot_used[free_slot] = 1;
+    write_FU_slot(free_slot, stage1, stage2);
+    return free_slot;
+  }
+
+  int unregister_FU_function(reconfiguration_engine_t *engine, int function) {
+    if (function < NUM_FU_FUNCTIONS || function >= MAX_FU_FUNCTIONS || !engine->FU_function_slot_used[function]) {
+      return XST_FAILURE;
+    }
+    engine->FU_function_slot_used[function] = 0;
+    return XST_SUCCESS;
   }
 
 #endif
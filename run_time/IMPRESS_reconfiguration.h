@@ -4,27 +4,87 @@
 #include <stdint.h> 
 #include "xil_types.h"
 #include "IMPRESS_reconfiguration_parameters.h"
+#include "reconfig_pcap.h"
 
 #define MAX_WORDS_PER_CONSTANT          (((MAX_BITS_PER_CONSTANT - 1) / 32) + 1)
 #define PREDEFINED_NUM_COLUMNS          0
 #define PREDEFINED_OFFSET_COLUMN        0
 #define MAX_CHARS_PER_PBS               50
 
+// The reconfigurations are prepared (readback and combination with the PBS) in
+// NUM_STAGING_BUFFERS buffers placed from the RAM address given to
+// init_reconfiguration_engine(), so that one of them
+// can be prepared in advance while another one is written. Their size is
+// computed from the FPGA description. The PBS loaded from the SD card are kept
+// in a RAM cache placed after them.
+#ifndef NUM_STAGING_BUFFERS
+	#define NUM_STAGING_BUFFERS         2
+#endif
+#if NUM_STAGING_BUFFERS < 2
+	#error "NUM_STAGING_BUFFERS must be at least 2 to prepare a reconfiguration while another one is written"
+#endif
+#ifndef PBS_CACHE_SLOTS
+	#define PBS_CACHE_SLOTS             4
+#endif
+#ifndef PBS_CACHE_SLOT_BYTES
+	#define PBS_CACHE_SLOT_BYTES        0x00400000 // Maximum size of a PBS in the cache
+#endif
+#if PBS_CACHE_SLOTS < 2
+	#error "PBS_CACHE_SLOTS must be at least 2 to load a PBS while another one is written"
+#endif
+#define PBS_PREFETCH_STEP_BYTES         4096 // Bytes loaded from the SD card each time the PCAP is idle
+#define MAX_RESERVED_REGIONS            8 // Regions of the FPGA that the placement does not use
+
+// Each reconfiguration can be checked by reading back the frames written (see
+// set_reconfiguration_verify_mode()). If a frame is not equal the write is
+// repeated up to RECONFIGURATION_VERIFY_RETRIES times.
+#ifndef RECONFIGURATION_VERIFY_MODE
+	#define RECONFIGURATION_VERIFY_MODE     PCAP_VERIFY_OFF
+#endif
+#ifndef RECONFIGURATION_VERIFY_RETRIES
+	#define RECONFIGURATION_VERIFY_RETRIES  1
+#endif
+
+// If set to 1 the element transitions of each partition are recorded to predict
+// the next element (see IMPRESS_prefetcher.h)
+#ifndef PREDICTIVE_PREFETCH
+	#define PREDICTIVE_PREFETCH         0
+#endif
+
+// If set to 1 the frames written in each reconfiguration are kept as golden
+// images of a configuration scrubber (see IMPRESS_scrubber.h)
+#ifndef CONFIGURATION_SCRUBBING
+	#define CONFIGURATION_SCRUBBING     0
+#endif
+
 #if FINE_GRAIN
-	#if MAX_COLUMNS_CONSTANTS > 1
-		#define MAX_COLUMNS_CONSTANT_PER_ELEMENT 2
+	// Number of clock region rows that an element with fine-grain components can
+	// span. Each fine-grain component can be split in one frame per clock region
+	// row plus one more frame when it continues in the next column.
+	#ifndef MAX_CLOCK_ROWS_PER_ELEMENT
+		#define MAX_CLOCK_ROWS_PER_ELEMENT 1
+	#endif
+
+	#if MAX_COLUMNS_CONSTANTS > MAX_CLOCK_ROWS_PER_ELEMENT
+		#define MAX_COLUMNS_CONSTANT_PER_ELEMENT (MAX_CLOCK_ROWS_PER_ELEMENT + 1)
+	#elif MAX_COLUMNS_CONSTANTS > 0
+		#define MAX_COLUMNS_CONSTANT_PER_ELEMENT MAX_COLUMNS_CONSTANTS
 	#else
 		#define MAX_COLUMNS_CONSTANT_PER_ELEMENT 1
 	#endif
 
-	#if MAX_COLUMNS_MUX > 1
-		#define MAX_COLUMNS_MUX_PER_ELEMENT 2
+	#if MAX_COLUMNS_MUX > MAX_CLOCK_ROWS_PER_ELEMENT
+		#define MAX_COLUMNS_MUX_PER_ELEMENT (MAX_CLOCK_ROWS_PER_ELEMENT + 1)
+	#elif MAX_COLUMNS_MUX > 0
+		#define MAX_COLUMNS_MUX_PER_ELEMENT MAX_COLUMNS_MUX
 	#else
 		#define MAX_COLUMNS_MUX_PER_ELEMENT 1
 	#endif
 
-	#if MAX_COLUMNS_FU > 1
-		#define MAX_COLUMNS_FU_PER_ELEMENT 2
+	#if MAX_COLUMNS_FU > MAX_CLOCK_ROWS_PER_ELEMENT
+		#define MAX_COLUMNS_FU_PER_ELEMENT (MAX_CLOCK_ROWS_PER_ELEMENT + 1)
+	#elif MAX_COLUMNS_FU > 0
+		#define MAX_COLUMNS_FU_PER_ELEMENT MAX_COLUMNS_FU
 	#else
 		#define MAX_COLUMNS_FU_PER_ELEMENT 1
 	#endif
@@ -53,8 +113,8 @@
  * [eq_or_bigger] compares that the first operand is equal or smaller than the second
  * */
 
-// NOTE: more functions can be implemented however they are not important for mapping LLVM IR onto an overlay, therefore they are not included.
-// TODO: ver si poner mas funciones como mux por ejemplo o operaciones lógicas de 3 valores o de 2 con uno de sus operandos negados o smaller o bigger sin equal añadiendole el Cin
+// NOTE: more functions (mux, logic operations with 3 operands or with negated operands, smaller or
+// bigger without equal using Cin...) can be added on run-time with register_FU_function().
 typedef enum  {	    add,
 					add_sat,
 					subtract,
@@ -74,6 +134,27 @@ typedef enum  {	    add,
 					eq_or_bigger,
 					smaller_or_eq} FU_functions_t;
 
+#define NUM_FU_FUNCTIONS                18 // Predefined functions of FU_functions_t
+#define MAX_FU_FUNCTIONS                32 // FU functions that fit in the fine-grain engine memory (5-bit identifier)
+
+/**
+ * LUT inputs of the FU used to define the truth tables of new FU functions. Each
+ * FU function is defined by the contents of the LUTs of two stages. The 32-bit
+ * value of each stage contains the two 16-bit frames of the LUT (first frame in
+ * the upper half).
+ */
+#define FU_IN1_S1                       0x0F0F0F0F // first operand (north) of the 1st stage
+#define FU_IN2_S1                       0x33333333 // second operand (west) of the 1st stage
+#define FU_IN1_S2                       0x55555555 // first operand (north) of the 2nd stage
+#define FU_IN2_S2                       0x0000FFFF // second operand (west) of the 2nd stage
+#define FU_SUM                          0x33333333 // sum of the 1st stage (mod 256)
+#define FU_HALF_SUM                     0x0F0F0F0F // sum of the 1st stage divided by 2
+#define FU_CARRY                        0x00FF00FF // carry of the 1st stage (overflow)
+// The 1st stage is an adder of the result of functions a and b of the operands
+#define FU_STAGE1(a, b)                 ((((a) & (b)) & ~FU_CARRY) | (((a) ^ (b)) & FU_CARRY))
+// The 2nd stage selects between the result without overflow and with overflow
+#define FU_STAGE2(noovf, ovf)           (((noovf) & ~FU_CARRY) | ((ovf) & FU_CARRY))
+
 #if FINE_GRAIN
   typedef struct {
     int initialized;
@@ -113,24 +194,29 @@ typedef struct {
   #endif 
   char PBS_name[MAX_CHARS_PER_PBS]; // Contains the name of the PBS wich represents the element 
   int size[2]; //Width, Height
+  int PBS_origin[2]; // X, Y position (down-left corner) of the region where the PBS was extracted
+  int PBS_contiguous_frames; // 1 if each frame of the PBS contains all the rows of the element (PBS extracted from one clock region row or generated with the contiguous option)
+  int PBS_BRAM_contents; // 1 if the PBS ends with the initial contents of the BRAMs of the element (generated with the BRAM option). They are written after each reconfiguration from the PBS cache.
 } element_info_t;
 
 typedef struct {
   #if FINE_GRAIN
-    constant_t constants_definition[MAX_CONSTANTS]; // Fill the number of constants
-    mux_t mux_definition[MAX_MUXES]; // Fill the number of muxes
-	  FU_t FU_definition[MAX_FU];
-    int constant_frame_address_position[MAX_CONSTANTS][MAX_COLUMNS_CONSTANT_PER_ELEMENT];
-  	int first_bit_in_frame[MAX_CONSTANTS][MAX_COLUMNS_CONSTANT_PER_ELEMENT];
-  	int last_bit_in_frame[MAX_CONSTANTS][MAX_COLUMNS_CONSTANT_PER_ELEMENT];
-  	int mux_frame_address_position[MAX_MUXES][MAX_COLUMNS_MUX_PER_ELEMENT];
-  	int first_LUT_in_frame[MAX_MUXES][MAX_COLUMNS_MUX_PER_ELEMENT];
-  	int last_LUT_in_frame[MAX_MUXES][MAX_COLUMNS_MUX_PER_ELEMENT];
-  	int LUT_position_in_frame[MAX_MUXES][MAX_COLUMNS_MUX_PER_ELEMENT];
-  	int total_LUTs_in_mux[MAX_MUXES];
-  	int FU_frame_address_position[MAX_FU][MAX_COLUMNS_FU_PER_ELEMENT];
-  	int first_FU_block_in_frame[MAX_FU][MAX_COLUMNS_FU_PER_ELEMENT];
-  	int last_FU_block_in_frame[MAX_FU][MAX_COLUMNS_FU_PER_ELEMENT];
+    // The fine-grain bookkeeping is allocated by init_virtual_architecture() with the
+    // number of constants, muxes and FUs of the biggest element of elements[]
+    constant_t *constants_definition;
+    mux_t *mux_definition;
+    FU_t *FU_definition;
+    int (*constant_frame_address_position)[MAX_COLUMNS_CONSTANT_PER_ELEMENT];
+    int (*first_bit_in_frame)[MAX_COLUMNS_CONSTANT_PER_ELEMENT];
+    int (*last_bit_in_frame)[MAX_COLUMNS_CONSTANT_PER_ELEMENT];
+    int (*mux_frame_address_position)[MAX_COLUMNS_MUX_PER_ELEMENT];
+    int (*first_LUT_in_frame)[MAX_COLUMNS_MUX_PER_ELEMENT];
+    int (*last_LUT_in_frame)[MAX_COLUMNS_MUX_PER_ELEMENT];
+    int (*LUT_position_in_frame)[MAX_COLUMNS_MUX_PER_ELEMENT];
+    int *total_LUTs_in_mux;
+    int (*FU_frame_address_position)[MAX_COLUMNS_FU_PER_ELEMENT];
+    int (*first_FU_block_in_frame)[MAX_COLUMNS_FU_PER_ELEMENT];
+    int (*last_FU_block_in_frame)[MAX_COLUMNS_FU_PER_ELEMENT];
   #endif 
   element_info_t *element_info;
 } element_t;
@@ -142,17 +228,134 @@ typedef struct {
   int last_row;
 } location_info_t;
 
+#if FINE_GRAIN
+  #define WORDS_PER_CONSTANTS           13
+  #define WORDS_PER_MUX                 13
+  #define WORDS_PER_FU                  10
+
+  typedef struct {
+    uint32_t frame_address;
+    // Each frame is defined with 400 bits and therefore has 13 words
+    uint32_t value[WORDS_PER_CONSTANTS];
+    // Image of the frame the last time it was sent to the fine grain RE
+    uint32_t written_value[WORDS_PER_CONSTANTS];
+    int8_t written;
+  } frame_constant_t;
+
+  typedef struct {
+    uint32_t frame_address;
+    // Each frame has 50 four-bit blocks. For each block we need to define it with 2 bit
+    // therefore we need 4 words to send to the fine grain RE.
+    uint32_t value[WORDS_PER_MUX];
+    uint32_t written_value[WORDS_PER_MUX];
+    int8_t written;
+  } frame_mux_t;
+
+  typedef struct {
+    uint32_t frame_address;
+    uint32_t value[WORDS_PER_FU];
+    uint32_t written_value[WORDS_PER_FU];
+    int8_t written;
+  } frame_FU_t;
+#endif
+
+// PBS of an element stored in the RAM
+typedef struct {
+  int element_info; // -1 if the slot is empty
+  u32 *PBS_last_addr;
+  int8_t loaded; // 0 while the PBS is being loaded from the SD card
+  uint32_t last_use;
+} PBS_cache_slot_t;
+
+typedef struct relocation_index_entry relocation_index_entry_t;
+typedef struct configuration_scrubber configuration_scrubber_t;
+
+/**
+ * State of the reconfiguration of one FPGA: the PCAP instance, the PBS cache, the
+ * staging buffers and the image of the fine-grain frames. It is initialized with
+ * init_reconfiguration_engine() and shared by all the virtual architectures of
+ * the FPGA. The runtime does not keep any other state, so several engines (e.g.
+ * with different RAM regions) can be used from different tasks or cores as long
+ * as the accesses to the PCAP and to the SD card are serialized.
+ */
+typedef struct {
+  XDcfg xCAP_component;
+  // RAM used by the staging buffers and the PBS cache
+  u32 RAM_start;
+  u32 RAM_end;
+  PBS_cache_slot_t PBS_cache[PBS_CACHE_SLOTS];
+  int PBS_cache_loading_slot;
+  uint32_t PBS_cache_use_count;
+  u32 PBS_cache_base;
+  staging_buffer_t staging_buffers[NUM_STAGING_BUFFERS];
+  pblock staging_pblock[NUM_STAGING_BUFFERS]; // Region prepared in advance in each buffer
+  int staging_element[NUM_STAGING_BUFFERS];   // Element prepared in advance in each buffer (-1 if none)
+  uint32_t staging_last_use[NUM_STAGING_BUFFERS];
+  uint32_t staging_use_count;
+  int stacked_staging_buffer;                 // Buffer used by the stacked modules being reconfigured
+  // Readback check of the reconfigurations
+  u32 verify_mode;                            // PCAP_VERIFY_OFF, PCAP_VERIFY_FULL or PCAP_VERIFY_SAMPLED
+  uint32_t verify_count;                      // Reconfigurations checked (selects the sampled columns)
+  uint32_t verify_errors;                     // Checks that found frames that were not equal
+  // Configuration scrubber of the FPGA (NULL if it is not used)
+  configuration_scrubber_t *scrubber;
+  // Placement (see IMPRESS_placement.h)
+  pblock reserved_regions[MAX_RESERVED_REGIONS];
+  int num_reserved_regions;
+  relocation_index_entry_t *relocation_index;
+  int relocation_index_entries;
+  #if FINE_GRAIN
+    frame_constant_t constant_t_frames[MAX_COLUMNS_CONSTANTS];
+    int8_t constant_frames_flags[MAX_COLUMNS_CONSTANTS];
+    frame_mux_t mux_t_frames[MAX_COLUMNS_MUX];
+    int8_t mux_frames_flags[MAX_COLUMNS_MUX];
+    frame_FU_t FU_t_frames[MAX_COLUMNS_FU];
+    int8_t FU_frames_flags[MAX_COLUMNS_FU];
+    uint32_t FU_function_table[MAX_FU_FUNCTIONS][2];
+    int8_t FU_function_slot_used[MAX_FU_FUNCTIONS];
+  #endif
+} reconfiguration_engine_t;
+
+// State of an element captured with capture_partition_state(): the frames of
+// its pblock (with the values of the flip-flops in their INIT bits, the LUTRAMs
+// and the SRLs) and its BRAM contents, with contiguous frames so that it can be
+// restored in any partition where the element can be placed
+typedef struct {
+  int element_info;       // Element captured (-1 if the state is empty)
+  void *memory;
+  u32 *state_first_addr;
+  u32 *state_last_addr;
+  u32 *work_addr;         // BRAM frames of one clock region row during the capture and the restore
+} element_state_t;
+
+typedef struct predictive_prefetcher predictive_prefetcher_t;
+
 typedef struct {
   element_t element;
   // Position of the element (down-left corner) contains X and Y position respectively 
   int position[2]; //X, Y   
   location_info_t location_info;
+  // Set by clear_partition_BRAM() to erase the BRAM when the next element is reconfigured
+  u8 clear_BRAM_pending;
 } partition_t;
 
 typedef struct {
-  partition_t partition[MAX_WIDTH_VIRTUAL_ARCHITECTURE][MAX_HEIGHT_VIRTUAL_ARCHITECTURE]; 
+  // Matrix of partitions (partition[x][y]) allocated by init_virtual_architecture()
+  partition_t **partition; 
+  int width;
+  int height;
   // Position of the overlay (down-left corner)
   int position[2];
+  // Size of the fine-grain bookkeeping of each partition
+  int max_constants;
+  int max_muxes;
+  int max_FU;
+  // Memory that contains all the partitions and their bookkeeping
+  void *arena;
+  // Engine of the FPGA where the virtual architecture is placed
+  reconfiguration_engine_t *engine;
+  // Predictive prefetcher of the virtual architecture (NULL if it is not used)
+  predictive_prefetcher_t *prefetcher;
 } virtual_architecture_t;
 
 // This array need to be initializated by the user with the different elements that can be
@@ -165,12 +368,155 @@ extern element_info_t elements[NUM_ELEMENTS];
 /**
 *
 * Initializes all the components and variables needed to use multi-grain 
-* reconfiguration
+* reconfiguration in an FPGA: the PCAP, the staging buffers, the PBS cache and
+* the fine-grain reconfiguration engine.
+*
+* @param engine: engine to initialize
+* @param RAM_addr: first address of the RAM used to prepare the reconfigurations
+* and to keep the PBS (e.g. INITIAL_ADDR_RAM). engine->RAM_end contains the
+* first address that is not used.
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int init_reconfiguration_engine(reconfiguration_engine_t *engine, u32 RAM_addr);
+/****************************************************************************/
+/**
+*
+* Releases the memory allocated by an engine. The virtual architectures of the
+* engine cannot be used any more.
+*
+* @param engine: engine initialized with init_reconfiguration_engine()
+* @return   none
+*
+*****************************************************************************/
+void release_reconfiguration_engine(reconfiguration_engine_t *engine);
+/****************************************************************************/
+/**
+*
+* Finds the fastest PCAP clock settings that work in the board (see
+* PCAP_calibrate_clock()). The test frames are kept in the first staging
+* buffer, so it must be called before any reconfiguration is prepared. It
+* fails while a set of stacked modules is being reconfigured.
+*
+* @param engine:
+* @param column: FPGA column used for the test. It must not contain logic that
+*        is being used (e.g. a column of an empty partition)
+* @param clock_row: clock region row of the column
+* @return   XST_SUCCESS else XST_FAILURE
 *
+*****************************************************************************/
+int calibrate_PCAP_clock(reconfiguration_engine_t *engine, int column, int clock_row);
+/****************************************************************************/
+/**
+*
+* Selects the configuration port of the coarse-grain and medium-grain
+* reconfigurations: CAP_TRANSPORT_PCAP (the initial port) or
+* CAP_TRANSPORT_HWICAP if the design has an AXI HWICAP. The readbacks of the
+* staging buffers and their checks use the same port.
+*
+* @param engine:
+* @param transport: CAP_TRANSPORT_PCAP or CAP_TRANSPORT_HWICAP
+* @return   XST_SUCCESS else XST_FAILURE if the port is not available
+*
+*****************************************************************************/
+int set_reconfiguration_transport(reconfiguration_engine_t *engine, u32 transport);
+/****************************************************************************/
+/**
+*
+* Measures the bandwidth of a configuration port (see
+* CAP_benchmark_transport()). The test frames are kept in the first staging
+* buffer, so it must be called before any reconfiguration is prepared. It
+* fails while a set of stacked modules is being reconfigured.
+*
+* @param engine:
+* @param transport: port that is measured
+* @param first_column, last_column: FPGA columns used for the test. They must
+*        not contain logic that is being used (e.g. the columns of an empty partition)
+* @param clock_row: clock region row of the columns
+* @param result: returns the size of the transfers and their mean times
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int benchmark_reconfiguration_transport(reconfiguration_engine_t *engine, u32 transport, int first_column, int last_column, int clock_row, CAP_benchmark_t *result);
+/****************************************************************************/
+/**
+*
+* Selects how the reconfigurations are checked after they are written (see
+* verify_subclock_region_PBS()). PCAP_VERIFY_FULL reads back all the frames
+* written, which doubles the PCAP time of each reconfiguration.
+* PCAP_VERIFY_SAMPLED reads back one column of each clock region row, a
+* different one in each reconfiguration. The initial mode is
+* RECONFIGURATION_VERIFY_MODE.
+*
+* NOTE the elements that use LUTRAMs or SRLs change their frames while they
+* run, so the checks of their partitions would fail.
+*
+* @param engine:
+* @param mode: PCAP_VERIFY_OFF, PCAP_VERIFY_FULL or PCAP_VERIFY_SAMPLED
 * @return   none
 *
 *****************************************************************************/
-void init_virtual_architecture();
+void set_reconfiguration_verify_mode(reconfiguration_engine_t *engine, u32 mode);
+/****************************************************************************/
+/**
+*
+* Takes the PCAP of the engine and selects it as configuration interface, so
+* that other modules (e.g. the scrubber) can use the PCAP functions between
+* the reconfigurations. It must be released with unlock_PCAP().
+*
+* @param engine:
+* @return   none
+*
+*****************************************************************************/
+void lock_PCAP(reconfiguration_engine_t *engine);
+/****************************************************************************/
+/**
+*
+* Releases the PCAP taken with lock_PCAP()
+*
+* @param engine:
+* @return   none
+*
+*****************************************************************************/
+void unlock_PCAP(reconfiguration_engine_t *engine);
+/****************************************************************************/
+/**
+*
+* Discards the reconfigurations prepared in advance (their readback is not
+* valid when the FPGA has been written by other means)
+*
+* @param engine:
+* @return   none
+*
+*****************************************************************************/
+void discard_prepared_reconfigurations(reconfiguration_engine_t *engine);
+/****************************************************************************/
+/**
+*
+* Initializes a virtual architecture placed in the FPGA of an engine. The
+* partitions of the virtual architecture are allocated in one memory block 
+* whose size depends on the size of the matrix and on the biggest number of 
+* fine-grain components of the elements of elements[].
+*
+* @param virtual_architecture: virtual architecture to initialize
+* @param engine: engine initialized with init_reconfiguration_engine()
+* @param width: number of partitions in the x coordinate
+* @param height: number of partitions in the y coordinate
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int init_virtual_architecture(virtual_architecture_t *virtual_architecture, reconfiguration_engine_t *engine, int width, int height);
+/****************************************************************************/
+/**
+*
+* Releases the memory of the partitions of a virtual architecture
+*
+* @param virtual_architecture: virtual architecture initialized with 
+* init_virtual_architecture()
+* @return   none
+*
+*****************************************************************************/
+void release_virtual_architecture(virtual_architecture_t *virtual_architecture);
 /****************************************************************************/
 /**
 *
@@ -225,6 +571,142 @@ int change_partition_element(virtual_architecture_t *virtual_architecture, int x
 *           not be reconfigured correctly
 *
 *****************************************************************************/
+int change_partition_element_stacked_modules(virtual_architecture_t *virtual_architecture, int x, int y, int num_element, u8 first_module, u8 last_module);
+/****************************************************************************/
+/**
+*
+* Erases the contents of the BRAM of a partition. If it is deferred, the BRAM
+* is erased in the same PCAP transfer as the next reconfiguration of the
+* partition, so that a partition that is released does not need an extra
+* transfer.
+*
+* @param virtual_architecture:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @param deferred: if set to 1 the BRAM is erased when the next element is
+*        reconfigured in the partition, else it is erased now
+* @return   XST_SUCCESS else XST_FAILURE (the BRAM of a partition without
+*           element can only be erased deferred)
+*
+*****************************************************************************/
+int clear_partition_BRAM(virtual_architecture_t *virtual_architecture, int x, int y, int deferred);
+/****************************************************************************/
+/**
+*
+* Captures the state of the element of a partition (see
+* capture_subclock_region_state()) so that it can be restored later with
+* restore_partition_state(), e.g. after another element has used the
+* partition. The memory of the state is allocated.
+*
+* NOTE the element should be stopped (e.g. its clock disabled) while its state
+* is captured.
+*
+* @param virtual_architecture:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @param state: returns the state. It must be released with
+*        release_partition_state() before it is used again.
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int capture_partition_state(virtual_architecture_t *virtual_architecture, int x, int y, element_state_t *state);
+/****************************************************************************/
+/**
+*
+* Places the element of a captured state in a partition (the same partition or
+* another one with the same columns) and restores its state. The frames of the
+* state replace the PBS, so the SD card is not accessed. GRESTORE sets all the
+* flip-flops of the FPGA: the flip-flops of the rest of the FPGA return to the
+* values that they had when the restore started, so the other logic should be
+* stopped while it is performed (see restore_subclock_region_state()).
+*
+* @param virtual_architecture:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @param state: state captured with capture_partition_state() (it is kept, so
+*        it can be restored again)
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int restore_partition_state(virtual_architecture_t *virtual_architecture, int x, int y, element_state_t *state);
+/****************************************************************************/
+/**
+*
+* Releases the memory of a state captured with capture_partition_state()
+*
+* @param state:
+* @return   none
+*
+*****************************************************************************/
+void release_partition_state(element_state_t *state);
+/****************************************************************************/
+/**
+*
+* Starts loading the PBS of an element from the SD card to the RAM so that it
+* is already available when the element is reconfigured. The load continues
+* each time the PCAP waits for a transfer and each time prefetch_PBS_step() is
+* called. Only one PBS can be loaded at the same time.
+*
+* @param engine:
+* @param num_element: reconfigurable module position in elements variable
+*
+* @return  XST_SUCCESS if the PBS is loaded or being loaded, XST_FAILURE if 
+*          another PBS is being loaded or the PBS cannot be loaded
+*
+*****************************************************************************/
+int prefetch_element_PBS(reconfiguration_engine_t *engine, int num_element);
+/****************************************************************************/
+/**
+*
+* Loads the next block (PBS_PREFETCH_STEP_BYTES) of the PBS that is being 
+* prefetched. It can be called when the processor is idle.
+*
+* @param engine:
+* @return  1 if the PBS has not been loaded completely yet, else 0
+*
+*****************************************************************************/
+int prefetch_PBS_step(reconfiguration_engine_t *engine);
+/****************************************************************************/
+/**
+*
+* @param engine:
+* @param num_element: reconfigurable module position in elements variable
+*
+* @return  1 if the PBS of the element is completely loaded in the RAM, else 0
+*
+*****************************************************************************/
+int is_element_PBS_prefetched(reconfiguration_engine_t *engine, int num_element);
+/****************************************************************************/
+/**
+*
+* Prepares in advance the reconfiguration of an element in a partition: the
+* region is read back and combined with the PBS in a free staging buffer, so
+* that the next change_partition_element() of that partition only has to write
+* it. The preparation is discarded when an overlapping region or a fine-grain
+* component is reconfigured, or when its buffer is needed for another one.
+*
+* @param virtual_architecture:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @param num_element: reconfigurable module position in elements variable
+*
+* @return  XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int prepare_partition_element(virtual_architecture_t *virtual_architecture, int x, int y, int num_element);
+/****************************************************************************/
+/**
+*
+* @param virtual_architecture:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @param num_element: reconfigurable module position in elements variable
+*
+* @return  1 if the reconfiguration of the element in the partition has been
+*          prepared in advance and it is still valid, else 0
+*
+*****************************************************************************/
+int is_partition_element_prepared(virtual_architecture_t *virtual_architecture, int x, int y, int num_element);
 
 #if FINE_GRAIN
   /****************************************************************************/
@@ -250,7 +732,8 @@ int change_partition_element(virtual_architecture_t *virtual_architecture, int x
   * element of the virtual architecture.
   * IMPORTANT: this function only reconfigures the internal frames representation 
   * variables. The FPGA is not reconfigured until reconfigure_fine_grain() is 
-  * called. 
+  * called. If the component already has that value the call does not mark any
+  * frame to be reconfigured.
   *
   * @param virtual_architecture:  
   * @param x: x coordinate of the virtual architecture matrix 
@@ -263,7 +746,33 @@ int change_partition_element(virtual_architecture_t *virtual_architecture, int x
   * @return   none
   *
   *****************************************************************************/
-  void change_partition_constant(virtual_architecture_t *virtual_architecture, int x, int y, int constant_number, uint32_t value[MAX_WORDS_PER_CONSTANT]);
+  void change_partition_constant(virtual_architecture_t *virtual_architecture, int x, int y, int constant_number, const uint32_t value[MAX_WORDS_PER_CONSTANT]);
+  /****************************************************************************/
+  /**
+  *
+  * This function can be used to change the value of several consecutive
+  * fine-grain constants of an element of the virtual architecture in one call
+  * (e.g. a set of filter coefficients). Constants that already have the new
+  * value do not mark any frame and the frames shared by several constants are
+  * only reconfigured once when reconfigure_fine_grain() is called.
+  * IMPORTANT: this function only reconfigures the internal frames representation 
+  * variables. The FPGA is not reconfigured until reconfigure_fine_grain() is 
+  * called.
+  *
+  * @param virtual_architecture:  
+  * @param x: x coordinate of the virtual architecture matrix 
+  * @param y: y coordinate of the virtual architecture matrix 
+  * @param first_constant: position of the first constant to change as 
+  * represented in the element variable 
+  * @param num_constants: number of constants to change
+  * @param values: new values of the constants. Each constant uses 
+  *        MAX_WORDS_PER_CONSTANT words (value of constant first_constant + i
+  *        starts at values[i * MAX_WORDS_PER_CONSTANT]).
+  * @return   XST_SUCCESS else XST_FAILURE if the constants do not belong to 
+  *           the element
+  *
+  *****************************************************************************/
+  int change_partition_constant_bank(virtual_architecture_t *virtual_architecture, int x, int y, int first_constant, int num_constants, const uint32_t *values);
   /****************************************************************************/
   /**
   *
@@ -271,7 +780,8 @@ int change_partition_element(virtual_architecture_t *virtual_architecture, int x
   * element of the virtual architecture.
   * IMPORTANT: this function only reconfigures the internal frames representation 
   * variables. The FPGA is not reconfigured until reconfigure_fine_grain() is 
-  * called. 
+  * called. If the component already has that value the call does not mark any
+  * frame to be reconfigured.
   *
   * @param virtual_architecture:  
   * @param x: x coordinate of the virtual architecture matrix 
@@ -290,7 +800,8 @@ int change_partition_element(virtual_architecture_t *virtual_architecture, int x
   * element of the virtual architecture.
   * IMPORTANT: this function only reconfigures the internal frames representation 
   * variables. The FPGA is not reconfigured until reconfigure_fine_grain() is 
-  * called. 
+  * called. If the component already has that value the call does not mark any
+  * frame to be reconfigured.
   *
   * @param virtual_architecture:  
   * @param x: x coordinate of the virtual architecture matrix 
@@ -306,12 +817,44 @@ int change_partition_element(virtual_architecture_t *virtual_architecture, int x
   /**
   *
   * It starts the fine-grain reconfiguration of all the fine-grain components 
-  * that have been updated.
+  * that have been updated. Frames whose final value is equal to the value that
+  * was written the last time are not reconfigured.
   *
+  * @param engine:
   * @return   none
   *
   *****************************************************************************/
-  void reconfigure_fine_grain();
+  void reconfigure_fine_grain(reconfiguration_engine_t *engine);
+  /****************************************************************************/
+  /**
+  *
+  * Registers a new FU function in a free slot of the fine-grain reconfiguration
+  * engine memory. The returned identifier can be used as the value of
+  * change_partition_FU() in the same way as the functions of FU_functions_t.
+  * If a function with the same truth tables is already registered its identifier
+  * is returned.
+  *
+  * @param engine:
+  * @param stage1: contents of the LUTs of the first stage (see FU_STAGE1())
+  * @param stage2: contents of the LUTs of the second stage (see FU_STAGE2())
+  * @return   identifier of the new FU function or -1 if there are no free slots
+  *
+  *****************************************************************************/
+  int register_FU_function(reconfiguration_engine_t *engine, uint32_t stage1, uint32_t stage2);
+  /****************************************************************************/
+  /**
+  *
+  * Releases the slot of a FU function registered with register_FU_function().
+  * The predefined functions of FU_functions_t cannot be released.
+  * IMPORTANT: the function must not be used by any FU of the virtual
+  * architecture.
+  *
+  * @param engine:
+  * @param function: identifier returned by register_FU_function()
+  * @return   XST_SUCCESS else XST_FAILURE
+  *
+  *****************************************************************************/
+  int unregister_FU_function(reconfiguration_engine_t *engine, int function);
 #endif
 
 #endif
@@ -16,6 +16,7 @@
     #define MAX_COLUMNS_MUX                  0
     #define MAX_COLUMNS_FU                   1
     #define MAX_COLUMN_OFFSETS               2
+    #define MAX_CLOCK_ROWS_PER_ELEMENT       1 // Clock region rows that an element with fine-grain components can span
   #endif
 
 #endif
\ No newline at end of file
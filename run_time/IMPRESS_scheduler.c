@@ -0,0 +1,323 @@
+#include <stdint.h>
+#include "IMPRESS_scheduler.h"
+#include "series7.h"
+#include <xstatus.h>
+
+#define X_POS                               0
+#define Y_POS                               1
+#define WIDTH_POS                           0
+#define HEIGHT_POS                          1
+
+/* Function declarations*/
+static int request_goes_first(reconfiguration_request_t *a, reconfiguration_request_t *b);
+static int next_request(reconfiguration_scheduler_t *scheduler, int8_t excluded[MAX_SCHEDULED_REQUESTS]);
+static int is_request_pending(reconfiguration_scheduler_t *scheduler, int request);
+static int request_clock_region(reconfiguration_scheduler_t *scheduler, int request, int *clock_row, int *x0, int *xf);
+static int build_batch(reconfiguration_scheduler_t *scheduler, int head, int max_batch, int batch[MAX_SCHEDULED_REQUESTS]);
+static void load_request_PBS(reconfiguration_scheduler_t *scheduler, int element_info);
+static void remove_requests(reconfiguration_scheduler_t *scheduler, int8_t removed[MAX_SCHEDULED_REQUESTS]);
+#if FINE_GRAIN
+static void dispatch_fine_grain_reconfiguration(reconfiguration_scheduler_t *scheduler);
+#endif
+
+/* Function definitions*/
+void init_reconfiguration_scheduler(reconfiguration_scheduler_t *scheduler, virtual_architecture_t *virtual_architecture) {
+  scheduler->virtual_architecture = virtual_architecture;
+  scheduler->num_requests = 0;
+  scheduler->num_arrivals = 0;
+  scheduler->deadline_misses = 0;
+  #if FINE_GRAIN
+    scheduler->fine_grain_pending = 0;
+  #endif
+}
+
+int schedule_reconfiguration(reconfiguration_scheduler_t *scheduler, int x, int y, int element_info, int priority, XTime deadline) {
+  int i;
+
+  if (element_info < 0 || element_info >= NUM_ELEMENTS) {
+    return XST_FAILURE;
+  }
+
+  for (i = 0; i < scheduler->num_requests; i++) {
+    if (scheduler->requests[i].x == x && scheduler->requests[i].y == y) {
+      // Only the last element requested for a partition has to be reconfigured
+      scheduler->requests[i].element_info = element_info;
+      if (priority > scheduler->requests[i].priority) {
+        scheduler->requests[i].priority = priority;
+      }
+      if (scheduler->requests[i].deadline == NO_DEADLINE || (deadline != NO_DEADLINE && deadline < scheduler->requests[i].deadline)) {
+        scheduler->requests[i].deadline = deadline;
+      }
+      return XST_SUCCESS;
+    }
+  }
+
+  if (scheduler->num_requests >= MAX_SCHEDULED_REQUESTS) {
+    return XST_FAILURE;
+  }
+  scheduler->requests[scheduler->num_requests].x = x;
+  scheduler->requests[scheduler->num_requests].y = y;
+  scheduler->requests[scheduler->num_requests].element_info = element_info;
+  scheduler->requests[scheduler->num_requests].priority = priority;
+  scheduler->requests[scheduler->num_requests].deadline = deadline;
+  scheduler->requests[scheduler->num_requests].order = scheduler->num_arrivals++;
+  scheduler->num_requests++;
+  return XST_SUCCESS;
+}
+
+int dispatch_reconfigurations(reconfiguration_scheduler_t *scheduler, int max_requests) {
+  virtual_architecture_t *virtual_architecture = scheduler->virtual_architecture;
+  int8_t removed[MAX_SCHEDULED_REQUESTS];
+  int batch[MAX_SCHEDULED_REQUESTS];
+  int batch_size, head, next, request, i;
+  int dispatched = 0;
+  int result = XST_SUCCESS;
+  int status;
+  XTime now;
+
+  #if FINE_GRAIN
+    // The fine-grain write goes first when it does not change the interface
+    if (scheduler->fine_grain_pending && CAP_get_interface() == CAP_INTERFACE_ICAP) {
+      dispatch_fine_grain_reconfiguration(scheduler);
+    }
+  #endif
+  while (scheduler->num_requests > 0 && dispatched < max_requests) {
+    for (i = 0; i < scheduler->num_requests; i++) {
+      removed[i] = 0;
+    }
+    head = next_request(scheduler, removed);
+    batch_size = build_batch(scheduler, head, max_requests - dispatched, batch);
+    for (i = 0; i < batch_size; i++) {
+      removed[batch[i]] = 1;
+    }
+
+    for (i = 0; i < batch_size; i++) {
+      request = batch[i];
+      if (is_request_pending(scheduler, request)) {
+        load_request_PBS(scheduler, scheduler->requests[request].element_info);
+      }
+      // The next PBS is loaded while the PCAP reconfigures this one
+      if (i + 1 < batch_size) {
+        prefetch_element_PBS(virtual_architecture->engine, scheduler->requests[batch[i + 1]].element_info);
+      } else {
+        next = next_request(scheduler, removed);
+        if (next != -1) {
+          prefetch_element_PBS(virtual_architecture->engine, scheduler->requests[next].element_info);
+        }
+      }
+
+      if (batch_size == 1) {
+        status = change_partition_element(virtual_architecture, scheduler->requests[request].x, scheduler->requests[request].y, scheduler->requests[request].element_info);
+      } else {
+        status = change_partition_element_stacked_modules(virtual_architecture, scheduler->requests[request].x, scheduler->requests[request].y, scheduler->requests[request].element_info, i == 0, i == batch_size - 1);
+      }
+      if (status != XST_SUCCESS) {
+        result = XST_FAILURE;
+      }
+    }
+
+    XTime_GetTime(&now);
+    for (i = 0; i < batch_size; i++) {
+      request = batch[i];
+      if (scheduler->requests[request].deadline != NO_DEADLINE && now > scheduler->requests[request].deadline) {
+        scheduler->deadline_misses++;
+      }
+    }
+    remove_requests(scheduler, removed);
+    dispatched += batch_size;
+  }
+  #if FINE_GRAIN
+    if (scheduler->fine_grain_pending) {
+      dispatch_fine_grain_reconfiguration(scheduler);
+    }
+  #endif
+
+  return result;
+}
+
+#if FINE_GRAIN
+  void schedule_fine_grain_reconfiguration(reconfiguration_scheduler_t *scheduler) {
+    scheduler->fine_grain_pending = 1;
+  }
+#endif
+
+int prefetch_scheduled_reconfigurations(reconfiguration_scheduler_t *scheduler) {
+  virtual_architecture_t *virtual_architecture = scheduler->virtual_architecture;
+  reconfiguration_engine_t *engine = virtual_architecture->engine;
+  int8_t excluded[MAX_SCHEDULED_REQUESTS];
+  int batch[MAX_SCHEDULED_REQUESTS];
+  int request, i;
+
+  if (prefetch_PBS_step(engine)) {
+    return 1;
+  }
+  for (i = 0; i < scheduler->num_requests; i++) {
+    excluded[i] = 0;
+  }
+  // The PBS are loaded in the order in which the requests will be dispatched
+  while ((request = next_request(scheduler, excluded)) != -1) {
+    excluded[request] = 1;
+    if (!is_element_PBS_prefetched(engine, scheduler->requests[request].element_info)) {
+      if (prefetch_element_PBS(engine, scheduler->requests[request].element_info) != XST_SUCCESS) {
+        return 0;
+      }
+      return prefetch_PBS_step(engine);
+    }
+  }
+
+  // The reconfiguration of the next request is prepared so that
+  // dispatch_reconfigurations() only has to write it (stacked requests are
+  // combined when they are dispatched)
+  for (i = 0; i < scheduler->num_requests; i++) {
+    excluded[i] = 0;
+  }
+  request = next_request(scheduler, excluded);
+  if (request != -1 && is_request_pending(scheduler, request)
+      && build_batch(scheduler, request, MAX_SCHEDULED_REQUESTS, batch) == 1
+      && !is_partition_element_prepared(virtual_architecture, scheduler->requests[request].x, scheduler->requests[request].y, scheduler->requests[request].element_info)) {
+    prepare_partition_element(virtual_architecture, scheduler->requests[request].x, scheduler->requests[request].y, scheduler->requests[request].element_info);
+  }
+  return 0;
+}
+
+int pending_reconfigurations(reconfiguration_scheduler_t *scheduler) {
+  #if FINE_GRAIN
+    return scheduler->num_requests + scheduler->fine_grain_pending;
+  #else
+    return scheduler->num_requests;
+  #endif
+}
+
+void cancel_reconfigurations(reconfiguration_scheduler_t *scheduler) {
+  scheduler->num_requests = 0;
+  #if FINE_GRAIN
+    scheduler->fine_grain_pending = 0;
+  #endif
+}
+
+int missed_reconfiguration_deadlines(reconfiguration_scheduler_t *scheduler) {
+  return scheduler->deadline_misses;
+}
+
+/*
+* Requests with higher priority go first, then the ones with the earliest deadline
+* and then the oldest ones
+*/
+static int request_goes_first(reconfiguration_request_t *a, reconfiguration_request_t *b) {
+  if (a->priority != b->priority) {
+    return a->priority > b->priority;
+  }
+  if (a->deadline != b->deadline) {
+    if (a->deadline == NO_DEADLINE) {
+      return 0;
+    }
+    if (b->deadline == NO_DEADLINE) {
+      return 1;
+    }
+    return a->deadline < b->deadline;
+  }
+  return a->order < b->order;
+}
+
+/*
+* Returns the first request that is not excluded or -1
+*/
+static int next_request(reconfiguration_scheduler_t *scheduler, int8_t excluded[MAX_SCHEDULED_REQUESTS]) {
+  int i, next = -1;
+
+  for (i = 0; i < scheduler->num_requests; i++) {
+    if (!excluded[i] && (next == -1 || request_goes_first(&scheduler->requests[i], &scheduler->requests[next]))) {
+      next = i;
+    }
+  }
+  return next;
+}
+
+/*
+* Returns 1 if the partition does not contain the element of the request
+*/
+static int is_request_pending(reconfiguration_scheduler_t *scheduler, int request) {
+  return scheduler->virtual_architecture->partition[scheduler->requests[request].x][scheduler->requests[request].y].element.element_info != &elements[scheduler->requests[request].element_info];
+}
+
+/*
+* Returns 1 if the element of the request fits in one clock region row and in that
+* case the row and the first and last columns
+*/
+static int request_clock_region(reconfiguration_scheduler_t *scheduler, int request, int *clock_row, int *x0, int *xf) {
+  partition_t *partition;
+  element_info_t *element;
+  int y0, yf;
+
+  partition = &scheduler->virtual_architecture->partition[scheduler->requests[request].x][scheduler->requests[request].y];
+  element = &elements[scheduler->requests[request].element_info];
+  y0 = partition->position[Y_POS];
+  yf = y0 + element->size[HEIGHT_POS] - 1;
+  *clock_row = y0 / ROWS_PER_CLOCK_REGION;
+  *x0 = partition->position[X_POS];
+  *xf = *x0 + element->size[WIDTH_POS] - 1;
+  return (*clock_row == yf / ROWS_PER_CLOCK_REGION);
+}
+
+/*
+* Groups the head request with the pending requests of partitions stacked in the
+* same columns of the same clock region row. Requests whose partition already
+* contains the element are not grouped because they do not reconfigure anything.
+*/
+static int build_batch(reconfiguration_scheduler_t *scheduler, int head, int max_batch, int batch[MAX_SCHEDULED_REQUESTS]) {
+  int8_t excluded[MAX_SCHEDULED_REQUESTS];
+  int clock_row, x0, xf;
+  int request_clock_row, request_x0, request_xf;
+  int batch_size, request, i;
+
+  batch[0] = head;
+  batch_size = 1;
+  if (!is_request_pending(scheduler, head) || !request_clock_region(scheduler, head, &clock_row, &x0, &xf)) {
+    return batch_size;
+  }
+
+  for (i = 0; i < scheduler->num_requests; i++) {
+    excluded[i] = (i == head);
+  }
+  while (batch_size < max_batch && (request = next_request(scheduler, excluded)) != -1) {
+    excluded[request] = 1;
+    if (is_request_pending(scheduler, request)
+        && request_clock_region(scheduler, request, &request_clock_row, &request_x0, &request_xf)
+        && request_clock_row == clock_row && request_x0 == x0 && request_xf == xf) {
+      batch[batch_size++] = request;
+    }
+  }
+  return batch_size;
+}
+
+/*
+* Waits until the PBS of the element is in the RAM
+*/
+static void load_request_PBS(reconfiguration_scheduler_t *scheduler, int element_info) {
+  reconfiguration_engine_t *engine = scheduler->virtual_architecture->engine;
+
+  if (prefetch_element_PBS(engine, element_info) != XST_SUCCESS) {
+    // Another PBS is being loaded
+    while (prefetch_PBS_step(engine));
+    prefetch_element_PBS(engine, element_info);
+  }
+  while (!is_element_PBS_prefetched(engine, element_info) && prefetch_PBS_step(engine));
+}
+
+static void remove_requests(reconfiguration_scheduler_t *scheduler, int8_t removed[MAX_SCHEDULED_REQUESTS]) {
+  int i, j = 0;
+
+  for (i = 0; i < scheduler->num_requests; i++) {
+    if (!removed[i]) {
+      scheduler->requests[j++] = scheduler->requests[i];
+    }
+  }
+  scheduler->num_requests = j;
+}
+
+#if FINE_GRAIN
+  static void dispatch_fine_grain_reconfiguration(reconfiguration_scheduler_t *scheduler) {
+    scheduler->fine_grain_pending = 0;
+    reconfigure_fine_grain(scheduler->virtual_architecture->engine);
+  }
+#endif
@@ -0,0 +1,137 @@
+#ifndef IMPRESS_SCHEDULER
+#define IMPRESS_SCHEDULER
+
+#include "IMPRESS_reconfiguration.h"
+#include "xtime_l.h"
+
+#define MAX_SCHEDULED_REQUESTS          16
+#define NO_DEADLINE                     0
+
+typedef struct {
+  int x;
+  int y;
+  int element_info;
+  int priority;
+  XTime deadline;
+  uint32_t order; // Arrival order, used when priority and deadline are equal
+} reconfiguration_request_t;
+
+typedef struct {
+  virtual_architecture_t *virtual_architecture;
+  reconfiguration_request_t requests[MAX_SCHEDULED_REQUESTS];
+  int num_requests;
+  uint32_t num_arrivals;
+  int deadline_misses;
+  #if FINE_GRAIN
+    int fine_grain_pending; // 1 when the fine-grain frames changed have to be written
+  #endif
+} reconfiguration_scheduler_t;
+
+/****************************************************************************/
+/**
+*
+* Initializes an empty queue of reconfiguration requests for the partitions of
+* a virtual architecture
+*
+* @param scheduler: scheduler to initialize
+* @param virtual_architecture:
+* @return   none
+*
+*****************************************************************************/
+void init_reconfiguration_scheduler(reconfiguration_scheduler_t *scheduler, virtual_architecture_t *virtual_architecture);
+
+/****************************************************************************/
+/**
+*
+* Adds a request to reconfigure an element in a partition of the virtual
+* architecture to the queue of the scheduler. The requests are not executed
+* until dispatch_reconfigurations() is called. If there is already a pending
+* request for the same partition it is replaced by the new one (keeping the
+* highest priority and the earliest deadline of both).
+*
+* @param scheduler:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @param num_element: reconfigurable module position in elements variable
+* @param priority: requests with higher priority are executed first
+* @param deadline: XTime count when the reconfiguration should be finished
+* (NO_DEADLINE if it does not have a deadline). Requests with the same
+* priority are executed in deadline order.
+* @return   XST_SUCCESS else XST_FAILURE if the queue is full
+*
+*****************************************************************************/
+int schedule_reconfiguration(reconfiguration_scheduler_t *scheduler, int x, int y, int num_element, int priority, XTime deadline);
+/****************************************************************************/
+/**
+*
+* Executes the pending requests. The requests of partitions that are stacked
+* in the same columns of a clock region row are reconfigured together with
+* change_partition_element_stacked_modules() so that the clock region is read
+* back and written only once. The PBS of the next request is loaded from the
+* SD card while the PCAP is reconfiguring the previous one.
+*
+* @param scheduler:
+* @param max_requests: maximum number of requests executed in this call
+* @return   XST_SUCCESS else XST_FAILURE if any reconfiguration has failed
+* (the failed requests are removed from the queue)
+*
+*****************************************************************************/
+int dispatch_reconfigurations(reconfiguration_scheduler_t *scheduler, int max_requests);
+#if FINE_GRAIN
+  /****************************************************************************/
+  /**
+  *
+  * Requests the write of the fine-grain frames changed with
+  * change_partition_constant(), change_partition_mux() or change_partition_FU().
+  * It is executed by the next dispatch_reconfigurations() with
+  * reconfigure_fine_grain() before the PCAP requests if the ICAP is the
+  * interface selected, else after them. This way the mixed-grain updates of a
+  * period change the interface of the DEVCFG only once.
+  *
+  * @param scheduler:
+  * @return   none
+  *
+  *****************************************************************************/
+  void schedule_fine_grain_reconfiguration(reconfiguration_scheduler_t *scheduler);
+#endif
+/****************************************************************************/
+/**
+*
+* Loads in advance the PBS of the pending requests. It can be called when the
+* processor is idle; each call loads at most PBS_PREFETCH_STEP_BYTES. When all
+* of them are loaded, the reconfiguration of the next request is prepared with
+* prepare_partition_element().
+*
+* @param scheduler:
+* @return   1 if there are PBS of pending requests that are not loaded, else 0
+*
+*****************************************************************************/
+int prefetch_scheduled_reconfigurations(reconfiguration_scheduler_t *scheduler);
+/****************************************************************************/
+/**
+*
+* @param scheduler:
+* @return   number of pending requests (including the fine-grain write)
+*
+*****************************************************************************/
+int pending_reconfigurations(reconfiguration_scheduler_t *scheduler);
+/****************************************************************************/
+/**
+*
+* Removes all the pending requests
+*
+* @param scheduler:
+* @return   none
+*
+*****************************************************************************/
+void cancel_reconfigurations(reconfiguration_scheduler_t *scheduler);
+/****************************************************************************/
+/**
+*
+* @param scheduler:
+* @return   number of requests that have finished after their deadline
+*
+*****************************************************************************/
+int missed_reconfiguration_deadlines(reconfiguration_scheduler_t *scheduler);
+
+#endif
@@ -0,0 +1,281 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "IMPRESS_scrubber.h"
+#include "series7.h"
+#include "xc7z020.h"
+#include <xstatus.h>
+
+/* Function declarations*/
+static u32 column_frames(int y, int x);
+static u32 frame_offset(int y, int x0, int x);
+static void update_golden_frames(scrub_region_t *region, u32 *image, int x0, int xf);
+static int add_scrub_region(configuration_scrubber_t *scrubber, pblock *written, u32 *image, int num_words, int num_element);
+static void remove_scrub_region(configuration_scrubber_t *scrubber, int i);
+static void scrub_column(configuration_scrubber_t *scrubber, scrub_region_t *region, int x);
+
+/* Function definitions*/
+int init_configuration_scrubber(configuration_scrubber_t *scrubber, reconfiguration_engine_t *engine) {
+  u32 frames, max_frames;
+  int x, y;
+
+  max_frames = 0;
+  for (y = 0; y < MAX_ROWS; y++) {
+    for (x = 0; x < MAX_COLUMNS; x++) {
+      frames = column_frames(y, x);
+      if (frames > max_frames) {
+        max_frames = frames;
+      }
+    }
+  }
+  // The readback of a column is invalidated in the cache, so it does not share cache lines
+  scrubber->work_memory = malloc(PCAP_VERIFY_WORDS(max_frames) * sizeof(u32) + 64);
+  if (scrubber->work_memory == NULL) {
+    return XST_FAILURE;
+  }
+  scrubber->work_addr = (u32 *) (((u32) scrubber->work_memory + 31) & ~31);
+  memset(scrubber->excluded_element, 0, sizeof(scrubber->excluded_element));
+  scrubber->num_regions = 0;
+  scrubber->next_region = 0;
+  scrubber->next_column = 0;
+  scrubber->next_column_time = 0;
+  reset_scrub_statistics(scrubber);
+  scrubber->engine = engine;
+  engine->scrubber = scrubber;
+  return XST_SUCCESS;
+}
+
+void release_configuration_scrubber(configuration_scrubber_t *scrubber) {
+  if (scrubber->engine != NULL && scrubber->engine->scrubber == scrubber) {
+    scrubber->engine->scrubber = NULL;
+  }
+  while (scrubber->num_regions > 0) {
+    remove_scrub_region(scrubber, scrubber->num_regions - 1);
+  }
+  free(scrubber->work_memory);
+  scrubber->work_memory = NULL;
+  scrubber->work_addr = NULL;
+  scrubber->engine = NULL;
+}
+
+void exclude_element_from_scrubbing(configuration_scrubber_t *scrubber, int num_element) {
+  int i;
+
+  if (num_element < 0 || num_element >= NUM_ELEMENTS) {
+    return;
+  }
+  scrubber->excluded_element[num_element] = 1;
+  for (i = scrubber->num_regions - 1; i >= 0; i--) {
+    if (scrubber->regions[i].element_info == num_element) {
+      remove_scrub_region(scrubber, i);
+    }
+  }
+}
+
+void record_golden_image(configuration_scrubber_t *scrubber, staging_buffer_t *buffer, int num_element) {
+  pblock *written;
+  scrub_region_t *region;
+  int excluded, recorded;
+  int i, j, x0, xf;
+
+  excluded = (num_element < 0 || num_element >= NUM_ELEMENTS || scrubber->excluded_element[num_element]);
+  for (i = 0; i < buffer->num_regions; i++) {
+    written = &buffer->regions[i];
+    recorded = 0;
+    for (j = scrubber->num_regions - 1; j >= 0; j--) {
+      region = &scrubber->regions[j];
+      if (region->region.Y0 != written->Y0 || region->region.Xf < written->X0 || region->region.X0 > written->Xf) {
+        continue;
+      }
+      if (excluded) {
+        // The frames shared with the excluded element would be restored
+        remove_scrub_region(scrubber, j);
+        continue;
+      }
+      // The frames of the shared columns are the ones just written
+      x0 = region->region.X0 > written->X0 ? region->region.X0 : written->X0;
+      xf = region->region.Xf < written->Xf ? region->region.Xf : written->Xf;
+      update_golden_frames(region, buffer->region_addr[i] + frame_offset(written->Y0, written->X0, x0) * NUM_FRAME_WORDS, x0, xf);
+      if (region->region.X0 == written->X0 && region->region.Xf == written->Xf) {
+        region->element_info = num_element;
+        region->refresh_columns = 0;
+        recorded = 1;
+      }
+    }
+    if (!excluded && !recorded) {
+      if (add_scrub_region(scrubber, written, buffer->region_addr[i], buffer->region_addr[i + 1] - buffer->region_addr[i], num_element) != XST_SUCCESS) {
+        scrubber->statistics.untracked++;
+      }
+    }
+  }
+}
+
+void refresh_golden_images(configuration_scrubber_t *scrubber) {
+  int i;
+
+  for (i = 0; i < scrubber->num_regions; i++) {
+    scrubber->regions[i].refresh_columns = scrubber->regions[i].region.Xf - scrubber->regions[i].region.X0 + 1;
+  }
+}
+
+int configuration_scrub_step(configuration_scrubber_t *scrubber) {
+  scrub_region_t *region;
+  XTime start, end, wait;
+
+  if (scrubber->num_regions == 0) {
+    return 0;
+  }
+  XTime_GetTime(&start);
+  if (start < scrubber->next_column_time) {
+    return 0;
+  }
+
+  region = &scrubber->regions[scrubber->next_region];
+  scrub_column(scrubber, region, region->region.X0 + scrubber->next_column);
+  if (++scrubber->next_column > region->region.Xf - region->region.X0) {
+    scrubber->next_column = 0;
+    scrubber->next_region = (scrubber->next_region + 1) % scrubber->num_regions;
+  }
+
+  // Rate limit: the scrubber waits (100 - share) / share times the time it has used
+  XTime_GetTime(&end);
+  wait = (end - start) * (100 - SCRUB_PCAP_SHARE_PERCENT) / SCRUB_PCAP_SHARE_PERCENT;
+  if (wait < (XTime) SCRUB_MIN_INTERVAL_US * COUNTS_PER_SECOND / 1000000) {
+    wait = (XTime) SCRUB_MIN_INTERVAL_US * COUNTS_PER_SECOND / 1000000;
+  }
+  scrubber->next_column_time = end + wait;
+  return 1;
+}
+
+void get_scrub_statistics(configuration_scrubber_t *scrubber, scrub_statistics_t *statistics) {
+  *statistics = scrubber->statistics;
+}
+
+void reset_scrub_statistics(configuration_scrubber_t *scrubber) {
+  memset(&scrubber->statistics, 0, sizeof(scrub_statistics_t));
+}
+
+static u32 column_frames(int y, int x) {
+  return fpga[y][x][0] & 0xFFFF;
+}
+
+/*
+* Returns the frames of the columns x0 to x - 1 of a clock region row, i.e. the
+* position of the first frame of the column x in an image that starts at x0
+*/
+static u32 frame_offset(int y, int x0, int x) {
+  u32 frames = 0;
+
+  for (; x0 < x; x0++) {
+    frames += column_frames(y, x0);
+  }
+  return frames;
+}
+
+/*
+* Copies the frames of the columns x0 to xf (image starts at x0) to the golden
+* image of a region and updates their hashes
+*/
+static void update_golden_frames(scrub_region_t *region, u32 *image, int x0, int xf) {
+  u32 first_frame, num_frames, frame;
+
+  first_frame = frame_offset(region->region.Y0, region->region.X0, x0);
+  num_frames = frame_offset(region->region.Y0, x0, xf + 1);
+  memcpy(region->golden + first_frame * NUM_FRAME_WORDS, image, num_frames * NUM_FRAME_BYTES);
+  for (frame = first_frame; frame < first_frame + num_frames; frame++) {
+    region->hashes[frame] = PCAP_frame_hash(region->golden + frame * NUM_FRAME_WORDS);
+  }
+}
+
+static int add_scrub_region(configuration_scrubber_t *scrubber, pblock *written, u32 *image, int num_words, int num_element) {
+  scrub_region_t *region;
+
+  if (scrubber->num_regions >= SCRUB_MAX_REGIONS || num_words <= 0) {
+    return XST_FAILURE;
+  }
+  region = &scrubber->regions[scrubber->num_regions];
+  region->num_frames = num_words / NUM_FRAME_WORDS;
+  region->golden = malloc(region->num_frames * NUM_FRAME_BYTES);
+  region->hashes = malloc(region->num_frames * sizeof(u32));
+  if (region->golden == NULL || region->hashes == NULL) {
+    free(region->golden);
+    free(region->hashes);
+    return XST_FAILURE;
+  }
+  region->region = *written;
+  region->element_info = num_element;
+  region->refresh_columns = 0;
+  update_golden_frames(region, image, written->X0, written->Xf);
+  scrubber->num_regions++;
+  return XST_SUCCESS;
+}
+
+static void remove_scrub_region(configuration_scrubber_t *scrubber, int i) {
+  free(scrubber->regions[i].golden);
+  free(scrubber->regions[i].hashes);
+  scrubber->regions[i] = scrubber->regions[--scrubber->num_regions];
+  // The column being scrubbed may have moved, so the scrubber restarts from a region
+  if (scrubber->next_region >= i) {
+    scrubber->next_column = 0;
+    if (scrubber->next_region >= scrubber->num_regions) {
+      scrubber->next_region = 0;
+    }
+  }
+}
+
+/*
+* Reads back one column of a region and rewrites the frames whose hash is not
+* the hash of the golden frame. Consecutive frames are rewritten together.
+*/
+static void scrub_column(configuration_scrubber_t *scrubber, scrub_region_t *region, int x) {
+  reconfiguration_engine_t *engine = scrubber->engine;
+  u32 *readback_end = scrubber->work_addr;
+  u32 first_frame, num_frames, frame, last;
+  int y = region->region.Y0;
+  int repaired = 0;
+
+  num_frames = column_frames(y, x);
+  if (num_frames == 0) {
+    return;
+  }
+  first_frame = frame_offset(y, region->region.X0, x);
+
+  lock_PCAP(engine);
+  if (PCAP_RAM_read(&engine->xCAP_component, &readback_end, x, y, x, y) != XST_SUCCESS) {
+    unlock_PCAP(engine);
+    return;
+  }
+  scrubber->statistics.columns++;
+
+  if (region->refresh_columns > 0) {
+    region->refresh_columns--;
+    update_golden_frames(region, scrubber->work_addr, x, x);
+    unlock_PCAP(engine);
+    return;
+  }
+
+  frame = 0;
+  while (frame < num_frames) {
+    scrubber->statistics.frames_checked++;
+    if (PCAP_frame_hash(scrubber->work_addr + frame * NUM_FRAME_WORDS) == region->hashes[first_frame + frame]) {
+      frame++;
+      continue;
+    }
+    for (last = frame + 1; last < num_frames && PCAP_frame_hash(scrubber->work_addr + last * NUM_FRAME_WORDS) != region->hashes[first_frame + last]; last++) {
+      scrubber->statistics.frames_checked++;
+    }
+    scrubber->statistics.upsets += last - frame;
+    repaired = 1;
+    if (PCAP_RAM_write_column_frames(&engine->xCAP_component, region->golden + (first_frame + frame) * NUM_FRAME_WORDS, x, y, frame, last - frame) == XST_SUCCESS) {
+      scrubber->statistics.repairs += last - frame;
+    } else {
+      scrubber->statistics.repair_errors += last - frame;
+    }
+    frame = last;
+  }
+  // The regions read back in advance may contain the frames that were not equal
+  if (repaired) {
+    discard_prepared_reconfigurations(engine);
+  }
+  unlock_PCAP(engine);
+}
@@ -0,0 +1,151 @@
+#ifndef IMPRESS_SCRUBBER
+#define IMPRESS_SCRUBBER
+
+#include "IMPRESS_reconfiguration.h"
+#include "xtime_l.h"
+
+// The scrubber keeps a golden image of each clock region row written by the
+// reconfigurations (when CONFIGURATION_SCRUBBING is set to 1) and, while the
+// processor is idle, reads back one column at a time, compares each frame
+// with the hash of its golden frame and rewrites only the frames that have
+// changed. Only the CLB/IO/CLK frames are scrubbed (not the BRAM contents).
+#ifndef SCRUB_MAX_REGIONS
+  #define SCRUB_MAX_REGIONS             16 // Clock region rows with golden image
+#endif
+#ifndef SCRUB_PCAP_SHARE_PERCENT
+  #define SCRUB_PCAP_SHARE_PERCENT      5 // Maximum share of the time used by the scrubber
+#endif
+#ifndef SCRUB_MIN_INTERVAL_US
+  #define SCRUB_MIN_INTERVAL_US         1000 // Minimum time between two columns
+#endif
+
+typedef struct {
+  uint32_t columns;        // Columns read back
+  uint32_t frames_checked; // Frames compared with the golden image
+  uint32_t upsets;         // Frames that were not equal
+  uint32_t repairs;        // Frames rewritten
+  uint32_t repair_errors;  // Frames that could not be rewritten
+  uint32_t untracked;      // Clock region rows written without free golden image
+} scrub_statistics_t;
+
+// Golden image of the columns X0 to Xf of the clock region row Y0 (= Yf)
+typedef struct {
+  pblock region;
+  u32 *golden;          // Frames as they were written
+  u32 *hashes;          // PCAP_frame_hash() of each golden frame
+  int num_frames;
+  int element_info;     // Element whose reconfiguration wrote the image
+  int refresh_columns;  // Columns whose next readback replaces the golden image
+} scrub_region_t;
+
+struct configuration_scrubber {
+  reconfiguration_engine_t *engine;
+  scrub_region_t regions[SCRUB_MAX_REGIONS];
+  int num_regions;
+  int next_region;
+  int next_column;
+  int8_t excluded_element[NUM_ELEMENTS];
+  // Readback of one column (aligned to a cache line)
+  void *work_memory;
+  u32 *work_addr;
+  XTime next_column_time;
+  scrub_statistics_t statistics;
+};
+
+/****************************************************************************/
+/**
+*
+* Initializes the configuration scrubber of an engine. The clock region rows
+* are scrubbed once they have been written by a reconfiguration (the actual
+* configuration of the FPGA is not known before).
+*
+* @param scrubber: scrubber to initialize
+* @param engine: engine initialized with init_reconfiguration_engine()
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int init_configuration_scrubber(configuration_scrubber_t *scrubber, reconfiguration_engine_t *engine);
+/****************************************************************************/
+/**
+*
+* Releases the golden images of the scrubber and detaches it from its engine
+*
+* @param scrubber:
+* @return   none
+*
+*****************************************************************************/
+void release_configuration_scrubber(configuration_scrubber_t *scrubber);
+/****************************************************************************/
+/**
+*
+* Stops scrubbing the regions written by an element. The elements that use
+* LUTRAMs or SRLs must be excluded, because their frames change while they run
+* and the scrubber would restore their initial contents.
+*
+* @param scrubber:
+* @param num_element: reconfigurable module position in elements variable
+* @return   none
+*
+*****************************************************************************/
+void exclude_element_from_scrubbing(configuration_scrubber_t *scrubber, int num_element);
+/****************************************************************************/
+/**
+*
+* Keeps the frames of a staging buffer that has just been written as the
+* golden images of its clock region rows. The golden images of other regions
+* that share columns with them are updated. It is called by the engine after
+* each reconfiguration.
+*
+* @param scrubber:
+* @param buffer: staging buffer written with commit_subclock_region_PBS()
+* @param num_element: element reconfigured
+* @return   none
+*
+*****************************************************************************/
+void record_golden_image(configuration_scrubber_t *scrubber, staging_buffer_t *buffer, int num_element);
+/****************************************************************************/
+/**
+*
+* Makes the next readback of every column the new golden image. It is called
+* by the engine after the fine-grain reconfigurations, which change frames of
+* the regions without writing their golden images.
+*
+* @param scrubber:
+* @return   none
+*
+*****************************************************************************/
+void refresh_golden_images(configuration_scrubber_t *scrubber);
+/****************************************************************************/
+/**
+*
+* Scrubs the next column of the regions with golden image if the rate limit
+* allows it: the time until the next column is at least SCRUB_MIN_INTERVAL_US
+* and enough to keep the scrubber below SCRUB_PCAP_SHARE_PERCENT of the time.
+* It must be called when the processor is idle.
+*
+* @param scrubber:
+* @return   1 if a column has been scrubbed, else 0
+*
+*****************************************************************************/
+int configuration_scrub_step(configuration_scrubber_t *scrubber);
+/****************************************************************************/
+/**
+*
+* @param scrubber:
+* @param statistics: returns the upsets found and repaired by the scrubber
+* @return   none
+*
+*****************************************************************************/
+void get_scrub_statistics(configuration_scrubber_t *scrubber, scrub_statistics_t *statistics);
+/****************************************************************************/
+/**
+*
+* Sets to 0 the statistics of the scrubber
+*
+* @param scrubber:
+* @return   none
+*
+*****************************************************************************/
+void reset_scrub_statistics(configuration_scrubber_t *scrubber);
+
+#endif
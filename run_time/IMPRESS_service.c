@@ -0,0 +1,192 @@
+#include <stdint.h>
+#include <string.h>
+#include "IMPRESS_service.h"
+#include "IMPRESS_placement.h"
+#include "xil_mmu.h"
+#if CONFIGURATION_SCRUBBING
+#include "IMPRESS_scrubber.h"
+#endif
+#include <xstatus.h>
+
+#define ARG_X                               0
+#define ARG_Y                               1
+#define ARG_NUMBER                          2
+#define ARG_VALUE                           3
+
+#if FINE_GRAIN && ARG_VALUE + MAX_WORDS_PER_CONSTANT > COMMAND_RING_ARGS
+  #error "COMMAND_RING_ARGS is too small for the fine-grain constants"
+#endif
+
+/* Function declarations*/
+static int submit_command(command_ring_t *ring, uint32_t type, int x, int y, int number, uint32_t *ticket, ring_command_t *command);
+static int execute_command(virtual_architecture_t *virtual_architecture, ring_command_t *command);
+
+/* Function definitions*/
+command_ring_t *map_reconfiguration_ring() {
+  Xil_SetTlbAttributes(RECONFIGURATION_RING_ADDR, OCM_SHARED_NONCACHEABLE);
+  return (command_ring_t *) RECONFIGURATION_RING_ADDR;
+}
+
+int reconfiguration_service_step(command_ring_t *ring, virtual_architecture_t *virtual_architecture) {
+  ring_command_t command;
+
+  if (!command_ring_peek(ring, &command)) {
+    #if CONFIGURATION_SCRUBBING
+      if (!prefetch_PBS_step(virtual_architecture->engine) && virtual_architecture->engine->scrubber != NULL) {
+        configuration_scrub_step(virtual_architecture->engine->scrubber);
+      }
+    #else
+      prefetch_PBS_step(virtual_architecture->engine);
+    #endif
+    return 0;
+  }
+  command_ring_complete(ring, execute_command(virtual_architecture, &command));
+  return 1;
+}
+
+void reconfiguration_service_loop(command_ring_t *ring, virtual_architecture_t *virtual_architecture) {
+  while (1) {
+    reconfiguration_service_step(ring, virtual_architecture);
+  }
+}
+
+int submit_partition_element(command_ring_t *ring, int x, int y, int num_element, uint32_t *ticket) {
+  ring_command_t command;
+
+  return submit_command(ring, COMMAND_CHANGE_ELEMENT, x, y, num_element, ticket, &command);
+}
+
+int submit_partition_migration(command_ring_t *ring, int x, int y, int new_x, int new_y, uint32_t *ticket) {
+  ring_command_t command;
+
+  command.args[ARG_VALUE] = new_y;
+  return submit_command(ring, COMMAND_MIGRATE_ELEMENT, x, y, new_x, ticket, &command);
+}
+
+#if FINE_GRAIN
+  int submit_partition_constant(command_ring_t *ring, int x, int y, int constant_number, const uint32_t value[MAX_WORDS_PER_CONSTANT], uint32_t *ticket) {
+    ring_command_t command;
+
+    memcpy(&command.args[ARG_VALUE], value, MAX_WORDS_PER_CONSTANT * sizeof(uint32_t));
+    return submit_command(ring, COMMAND_CHANGE_CONSTANT, x, y, constant_number, ticket, &command);
+  }
+
+  int submit_partition_mux(command_ring_t *ring, int x, int y, int mux_number, int value, uint32_t *ticket) {
+    ring_command_t command;
+
+    command.args[ARG_VALUE] = value;
+    return submit_command(ring, COMMAND_CHANGE_MUX, x, y, mux_number, ticket, &command);
+  }
+
+  int submit_partition_FU(command_ring_t *ring, int x, int y, int FU_number, FU_functions_t value, uint32_t *ticket) {
+    ring_command_t command;
+
+    command.args[ARG_VALUE] = value;
+    return submit_command(ring, COMMAND_CHANGE_FU, x, y, FU_number, ticket, &command);
+  }
+
+  int submit_fine_grain_reconfiguration(command_ring_t *ring, uint32_t *ticket) {
+    ring_command_t command;
+
+    return submit_command(ring, COMMAND_RECONFIGURE_FINE_GRAIN, 0, 0, 0, ticket, &command);
+  }
+#endif
+
+int is_reconfiguration_done(command_ring_t *ring, uint32_t ticket, int *status) {
+  int32_t command_status;
+
+  if (!command_ring_is_done(ring, ticket, &command_status)) {
+    return 0;
+  }
+  if (status != NULL) {
+    *status = command_status;
+  }
+  return 1;
+}
+
+int wait_reconfiguration(command_ring_t *ring, uint32_t ticket) {
+  uint32_t retries = 0;
+  int status;
+
+  while (!is_reconfiguration_done(ring, ticket, &status)) {
+    if (RECONFIGURATION_COMMAND_TIMEOUT != 0xFFFFFFFF && ++retries >= RECONFIGURATION_COMMAND_TIMEOUT) {
+      return XST_FAILURE;
+    }
+  }
+  return status;
+}
+
+/*
+* Fills the common fields of the command (the arguments of each type are
+* already in command) and adds it to the ring
+*/
+static int submit_command(command_ring_t *ring, uint32_t type, int x, int y, int number, uint32_t *ticket, ring_command_t *command) {
+  command->type = type;
+  command->args[ARG_X] = x;
+  command->args[ARG_Y] = y;
+  command->args[ARG_NUMBER] = number;
+  if (!command_ring_push(ring, command, ticket)) {
+    return XST_FAILURE;
+  }
+  return XST_SUCCESS;
+}
+
+static int execute_command(virtual_architecture_t *virtual_architecture, ring_command_t *command) {
+  int x = command->args[ARG_X];
+  int y = command->args[ARG_Y];
+  int number = command->args[ARG_NUMBER];
+  int value = command->args[ARG_VALUE];
+#if FINE_GRAIN
+  element_info_t *element_info;
+#endif
+
+  // The commands come from the other core, so nothing is used before it is checked
+  if (command->type != COMMAND_RECONFIGURE_FINE_GRAIN
+      && (x < 0 || x >= virtual_architecture->width || y < 0 || y >= virtual_architecture->height)) {
+    return XST_FAILURE;
+  }
+#if FINE_GRAIN
+  if (command->type == COMMAND_CHANGE_CONSTANT || command->type == COMMAND_CHANGE_MUX || command->type == COMMAND_CHANGE_FU) {
+    element_info = virtual_architecture->partition[x][y].element.element_info;
+    if (element_info == NULL || number < 0) {
+      return XST_FAILURE;
+    }
+    if ((command->type == COMMAND_CHANGE_CONSTANT && number >= element_info->num_constants)
+        || (command->type == COMMAND_CHANGE_MUX && number >= element_info->num_muxes)
+        || (command->type == COMMAND_CHANGE_FU && (number >= element_info->num_FU || value < 0 || value >= MAX_FU_FUNCTIONS
+                                                   || !virtual_architecture->engine->FU_function_slot_used[value]))) {
+      return XST_FAILURE;
+    }
+  }
+#endif
+
+  switch (command->type) {
+    case COMMAND_CHANGE_ELEMENT:
+      // -1 invalidates the partition
+      if (number < -1 || number >= NUM_ELEMENTS) {
+        return XST_FAILURE;
+      }
+      return change_partition_element(virtual_architecture, x, y, number);
+    case COMMAND_MIGRATE_ELEMENT:
+      if (number < 0 || number >= virtual_architecture->width || value < 0 || value >= virtual_architecture->height) {
+        return XST_FAILURE;
+      }
+      return migrate_partition_element(virtual_architecture, x, y, number, value);
+#if FINE_GRAIN
+    case COMMAND_CHANGE_CONSTANT:
+      change_partition_constant(virtual_architecture, x, y, number, (const uint32_t *) &command->args[ARG_VALUE]);
+      return XST_SUCCESS;
+    case COMMAND_CHANGE_MUX:
+      change_partition_mux(virtual_architecture, x, y, number, value);
+      return XST_SUCCESS;
+    case COMMAND_CHANGE_FU:
+      change_partition_FU(virtual_architecture, x, y, number, value);
+      return XST_SUCCESS;
+    case COMMAND_RECONFIGURE_FINE_GRAIN:
+      reconfigure_fine_grain(virtual_architecture->engine);
+      return XST_SUCCESS;
+#endif
+    default:
+      return XST_FAILURE;
+  }
+}
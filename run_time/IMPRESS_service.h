@@ -0,0 +1,185 @@
+#ifndef IMPRESS_SERVICE
+#define IMPRESS_SERVICE
+
+#include "IMPRESS_reconfiguration.h"
+#include "IMPRESS_command_ring.h"
+
+// The reconfigurations can be executed by the second core of the Zynq. The
+// application core (core 0) submits the reconfigurations to a command ring
+// placed in the OCM and continues while core 1, which owns the virtual
+// architecture and the reconfiguration engine, executes them in
+// reconfiguration_service_loop(). Both cores must call
+// map_reconfiguration_ring() to get the ring.
+#ifndef RECONFIGURATION_RING_ADDR
+  #define RECONFIGURATION_RING_ADDR     0xFFFF0000 // OCM mapped at the high address
+#endif
+#define OCM_SHARED_NONCACHEABLE         0x14de2 // Shareable, non-cacheable 1 MB section
+
+#ifndef RECONFIGURATION_COMMAND_TIMEOUT
+  #define RECONFIGURATION_COMMAND_TIMEOUT 0xFFFFFFFF // Retries of wait_reconfiguration() (0xFFFFFFFF waits forever)
+#endif
+
+typedef enum {
+  COMMAND_CHANGE_ELEMENT,
+  COMMAND_CHANGE_CONSTANT,
+  COMMAND_CHANGE_MUX,
+  COMMAND_CHANGE_FU,
+  COMMAND_RECONFIGURE_FINE_GRAIN,
+  COMMAND_MIGRATE_ELEMENT
+} reconfiguration_command_type_t;
+
+/****************************************************************************/
+/**
+*
+* Makes the OCM section that contains the command ring shareable and
+* non-cacheable, so that both cores see the same contents. It must be called
+* by both cores before they use the ring.
+*
+* @return   command ring placed at RECONFIGURATION_RING_ADDR
+*
+*****************************************************************************/
+command_ring_t *map_reconfiguration_ring();
+/****************************************************************************/
+/**
+*
+* Executes one of the commands of the ring (the oldest one) in the virtual
+* architecture. If the ring is empty it continues the load of the PBS that are
+* being prefetched or, when there is nothing to load, it scrubs the next part of
+* the configuration (if the engine has a scrubber). It must only be called by
+* the core that owns the virtual architecture. A command with a partition,
+* element, constant, mux or FU out of range (or a fine-grain change in an empty
+* partition) is completed with XST_FAILURE without being executed.
+*
+* @param ring:
+* @param virtual_architecture:
+* @return   1 if a command has been executed else 0
+*
+*****************************************************************************/
+int reconfiguration_service_step(command_ring_t *ring, virtual_architecture_t *virtual_architecture);
+/****************************************************************************/
+/**
+*
+* Executes the commands of the ring forever. It is the main loop of the core
+* that reconfigures the FPGA.
+*
+* @param ring:
+* @param virtual_architecture:
+* @return   none
+*
+*****************************************************************************/
+void reconfiguration_service_loop(command_ring_t *ring, virtual_architecture_t *virtual_architecture);
+/****************************************************************************/
+/**
+*
+* Submits a change_partition_element() to the reconfiguration core.
+*
+* @param ring:
+* @param x: x coordinate of the virtual architecture matrix
+* @param y: y coordinate of the virtual architecture matrix
+* @param num_element: reconfigurable module position in elements variable
+* @param ticket: returns the identifier of the command (see
+*        is_reconfiguration_done())
+* @return   XST_SUCCESS else XST_FAILURE if the ring is full
+*
+*****************************************************************************/
+int submit_partition_element(command_ring_t *ring, int x, int y, int num_element, uint32_t *ticket);
+/****************************************************************************/
+/**
+*
+* Submits a migrate_partition_element() to the reconfiguration core.
+*
+* @param ring:
+* @param x, y: partition of the element
+* @param new_x, new_y: partition where the element is moved
+* @param ticket: returns the identifier of the command (see
+*        is_reconfiguration_done())
+* @return   XST_SUCCESS else XST_FAILURE if the ring is full
+*
+*****************************************************************************/
+int submit_partition_migration(command_ring_t *ring, int x, int y, int new_x, int new_y, uint32_t *ticket);
+#if FINE_GRAIN
+  /****************************************************************************/
+  /**
+  *
+  * Submits a change_partition_constant() to the reconfiguration core.
+  *
+  * @param ring:
+  * @param x: x coordinate of the virtual architecture matrix
+  * @param y: y coordinate of the virtual architecture matrix
+  * @param constant_number: position of the constant to change as represented
+  *        in the element variable
+  * @param value[MAX_WORDS_PER_CONSTANT]: new value of the constant
+  * @param ticket: returns the identifier of the command
+  * @return   XST_SUCCESS else XST_FAILURE if the ring is full
+  *
+  *****************************************************************************/
+  int submit_partition_constant(command_ring_t *ring, int x, int y, int constant_number, const uint32_t value[MAX_WORDS_PER_CONSTANT], uint32_t *ticket);
+  /****************************************************************************/
+  /**
+  *
+  * Submits a change_partition_mux() to the reconfiguration core.
+  *
+  * @param ring:
+  * @param x: x coordinate of the virtual architecture matrix
+  * @param y: y coordinate of the virtual architecture matrix
+  * @param mux_number: position of the multiplexor to change as represented in
+  *        the element variable
+  * @param value: input that will be selected
+  * @param ticket: returns the identifier of the command
+  * @return   XST_SUCCESS else XST_FAILURE if the ring is full
+  *
+  *****************************************************************************/
+  int submit_partition_mux(command_ring_t *ring, int x, int y, int mux_number, int value, uint32_t *ticket);
+  /****************************************************************************/
+  /**
+  *
+  * Submits a change_partition_FU() to the reconfiguration core.
+  *
+  * @param ring:
+  * @param x: x coordinate of the virtual architecture matrix
+  * @param y: y coordinate of the virtual architecture matrix
+  * @param FU_number: position of the FU to change as represented in the
+  *        element variable
+  * @param value: new functionality of the FU
+  * @param ticket: returns the identifier of the command
+  * @return   XST_SUCCESS else XST_FAILURE if the ring is full
+  *
+  *****************************************************************************/
+  int submit_partition_FU(command_ring_t *ring, int x, int y, int FU_number, FU_functions_t value, uint32_t *ticket);
+  /****************************************************************************/
+  /**
+  *
+  * Submits a reconfigure_fine_grain() to the reconfiguration core. The
+  * previous fine-grain changes submitted to the same ring are reconfigured.
+  *
+  * @param ring:
+  * @param ticket: returns the identifier of the command
+  * @return   XST_SUCCESS else XST_FAILURE if the ring is full
+  *
+  *****************************************************************************/
+  int submit_fine_grain_reconfiguration(command_ring_t *ring, uint32_t *ticket);
+#endif
+/****************************************************************************/
+/**
+*
+* @param ring:
+* @param ticket: identifier returned when the command was submitted
+* @param status: returns the result of the command (it can be NULL)
+* @return   1 if the reconfiguration core has executed the command else 0
+*
+*****************************************************************************/
+int is_reconfiguration_done(command_ring_t *ring, uint32_t ticket, int *status);
+/****************************************************************************/
+/**
+*
+* Waits until the reconfiguration core has executed a command.
+*
+* @param ring:
+* @param ticket: identifier returned when the command was submitted
+* @return   result of the command else XST_FAILURE if it has not been
+*           executed after RECONFIGURATION_COMMAND_TIMEOUT retries
+*
+*****************************************************************************/
+int wait_reconfiguration(command_ring_t *ring, uint32_t ticket);
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * reconfig_os.c
+ *
+ * Bare-metal and FreeRTOS implementations of the waits and locks used by the
+ * reconfiguration functions (see reconfig_os.h)
+ */
+
+
+/***************************** Include Files ********************************/
+#include "reconfig_os.h"
+#include "xparameters.h"
+#include "xstatus.h"
+#if RECONFIG_OS_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#endif
+
+
+/************************** Constant Definitions ****************************/
+#if RECONFIG_OS_FREERTOS
+#ifndef RECONFIG_OS_PCAP_TIMEOUT_TICKS
+#define RECONFIG_OS_PCAP_TIMEOUT_TICKS portMAX_DELAY // The status is checked again after each timeout
+#endif
+#endif
+
+
+/************************** Variable Definitions ****************************/
+#if RECONFIG_OS_FREERTOS
+static SemaphoreHandle_t PCAP_done = NULL;          // Given by the interrupt at the end of a transfer
+static volatile u32 PCAP_wait_mask;                 // Status bits of the transfer being waited for
+static SemaphoreHandle_t locks[RECONFIG_NUM_LOCKS]; // Created the first time that they are used
+#endif
+
+
+/************************** Function Prototypes *****************************/
+#if RECONFIG_OS_FREERTOS
+static int scheduler_running();
+static int install_PCAP_interrupt(XDcfg *InstancePtr);
+static void PCAP_interrupt_handler(void *CallBackRef);
+#endif
+
+
+/************************** Function Definitions ****************************/
+
+void reconfig_os_wait_PCAP(XDcfg *InstancePtr, u32 mask, void (*idle_callback)(void *), void *data)
+{
+    volatile u32 IntrStsReg;
+
+    IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
+#if RECONFIG_OS_FREERTOS
+    if (idle_callback == NULL && scheduler_running() && install_PCAP_interrupt(InstancePtr) == XST_SUCCESS)
+    {
+        PCAP_wait_mask = mask;
+        while ((IntrStsReg & mask) != mask)
+        {
+            // The interrupt disables the bits that are set, so only the missing ones are enabled
+            XDcfg_IntrEnable(InstancePtr, mask & ~IntrStsReg);
+            xSemaphoreTake(PCAP_done, RECONFIG_OS_PCAP_TIMEOUT_TICKS);
+            IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
+        }
+        XDcfg_IntrDisable(InstancePtr, mask);
+        return;
+    }
+#endif
+    while ((IntrStsReg & mask) != mask)
+    {
+        if (idle_callback != NULL)
+        {
+            idle_callback(data);
+            reconfig_os_yield();
+        }
+        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
+    }
+}
+
+void reconfig_os_yield()
+{
+#if RECONFIG_OS_FREERTOS
+    if (scheduler_running())
+    {
+        taskYIELD();
+    }
+#endif
+}
+
+void reconfig_os_lock(reconfig_lock_t lock)
+{
+#if RECONFIG_OS_FREERTOS
+    if (!scheduler_running())
+    {
+        return;
+    }
+    if (locks[lock] == NULL)
+    {
+        taskENTER_CRITICAL();
+        if (locks[lock] == NULL)
+        {
+            locks[lock] = xSemaphoreCreateRecursiveMutex();
+        }
+        taskEXIT_CRITICAL();
+    }
+    xSemaphoreTakeRecursive(locks[lock], portMAX_DELAY);
+#endif
+}
+
+void reconfig_os_unlock(reconfig_lock_t lock)
+{
+#if RECONFIG_OS_FREERTOS
+    if (!scheduler_running() || locks[lock] == NULL)
+    {
+        return;
+    }
+    xSemaphoreGiveRecursive(locks[lock]);
+#endif
+}
+
+#if RECONFIG_OS_FREERTOS
+/****************************************************************************/
+/**
+*
+* The FreeRTOS objects can only be used once the scheduler (and the interrupt
+* controller of the port) has been started
+*
+* @return   1 if the scheduler is running else 0
+*
+*****************************************************************************/
+static int scheduler_running()
+{
+    return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+/****************************************************************************/
+/**
+*
+* Connects the DEVCFG interrupt to PCAP_interrupt_handler() the first time
+* that a task waits for a transfer
+*
+* @param InstancePtr is a pointer to the PCAP instance
+*
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+static int install_PCAP_interrupt(XDcfg *InstancePtr)
+{
+    if (PCAP_done != NULL)
+    {
+        return XST_SUCCESS;
+    }
+
+    PCAP_done = xSemaphoreCreateBinary();
+    if (PCAP_done == NULL)
+    {
+        return XST_FAILURE;
+    }
+    XDcfg_IntrDisable(InstancePtr, XDCFG_IXR_ALL_MASK);
+    if (xPortInstallInterruptHandler(RECONFIG_OS_PCAP_INTR_ID, PCAP_interrupt_handler, InstancePtr) != pdPASS)
+    {
+        vSemaphoreDelete(PCAP_done);
+        PCAP_done = NULL;
+        return XST_FAILURE;
+    }
+    vPortEnableInterrupt(RECONFIG_OS_PCAP_INTR_ID);
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* DEVCFG interrupt handler. It disables the status bits that are already set
+* (they stay set until the waiting task clears them) and wakes the task when
+* all the bits it waits for are set.
+*
+* @param CallBackRef is a pointer to the PCAP instance
+*
+* @return   none
+*
+*****************************************************************************/
+static void PCAP_interrupt_handler(void *CallBackRef)
+{
+    XDcfg *InstancePtr = (XDcfg *) CallBackRef;
+    BaseType_t HigherPriorityTaskWoken = pdFALSE;
+    u32 IntrStsReg;
+
+    IntrStsReg = XDcfg_IntrGetStatus(InstancePtr) & PCAP_wait_mask;
+    XDcfg_IntrDisable(InstancePtr, IntrStsReg);
+    if (IntrStsReg == PCAP_wait_mask)
+    {
+        xSemaphoreGiveFromISR(PCAP_done, &HigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(HigherPriorityTaskWoken);
+}
+#endif
@@ -0,0 +1,95 @@
+/*
+ * reconfig_os.h
+ *
+ * Operating system services used by the reconfiguration functions: waits
+ * for the end of the PCAP transfers and the ICAP operations and locks of the
+ * shared configuration resources. When RECONFIG_OS_FREERTOS is set to 1 the
+ * waits block the calling task on a semaphore signalled by the DEVCFG
+ * interrupt, so that other tasks run during the reconfiguration. Otherwise
+ * (bare-metal) the waits poll the status registers and the locks are empty.
+ */
+
+#ifndef RECONFIG_OS_H
+#define RECONFIG_OS_H
+
+/***************************** Include Files ********************************/
+#include "xil_types.h"
+#include "xdevcfg.h"
+
+/************************** Constant Definitions ****************************/
+#ifndef RECONFIG_OS_FREERTOS
+#define RECONFIG_OS_FREERTOS 0
+#endif
+
+// DEVCFG interrupt (PCAP DMA)
+#ifndef RECONFIG_OS_PCAP_INTR_ID
+#define RECONFIG_OS_PCAP_INTR_ID XPAR_XDCFG_0_INTR
+#endif
+
+/**************************** Type Definitions ******************************/
+typedef enum
+{
+    RECONFIG_LOCK_PCAP, // DEVCFG DMA and PCAP/ICAP interface selection
+    RECONFIG_LOCK_SD,   // SD card file system
+    RECONFIG_NUM_LOCKS
+} reconfig_lock_t;
+
+/************************** Function Prototypes *****************************/
+
+/****************************************************************************/
+/**
+*
+* Waits until all the bits of mask are set in the interrupt status register of
+* the DEVCFG. If an idle callback is given it is called while the transfer is
+* in progress (under FreeRTOS the task yields after each call). Otherwise the
+* task blocks until the DEVCFG interrupt signals the end of the transfer.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param mask are the interrupt status bits to wait for
+* @param idle_callback is the function called while waiting or NULL
+* @param data is the argument passed to idle_callback
+*
+* @return   none
+*
+*****************************************************************************/
+void reconfig_os_wait_PCAP(XDcfg *InstancePtr, u32 mask, void (*idle_callback)(void *), void *data);
+
+/****************************************************************************/
+/**
+*
+* Lets other tasks run while the caller polls a device (e.g. the fine-grain
+* ICAP controller, which does not have an interrupt). It does nothing in
+* bare-metal.
+*
+* @return   none
+*
+*****************************************************************************/
+void reconfig_os_yield();
+
+/****************************************************************************/
+/**
+*
+* Takes one of the locks of the shared configuration resources. The locks are
+* recursive, so a task can take them again from nested functions. They are
+* empty in bare-metal and before the FreeRTOS scheduler starts.
+*
+* @param lock is the resource to lock
+*
+* @return   none
+*
+*****************************************************************************/
+void reconfig_os_lock(reconfig_lock_t lock);
+
+/****************************************************************************/
+/**
+*
+* Releases a lock taken with reconfig_os_lock()
+*
+* @param lock is the resource to unlock
+*
+* @return   none
+*
+*****************************************************************************/
+void reconfig_os_unlock(reconfig_lock_t lock);
+
+#endif /* RECONFIG_OS_H */
@@ -10,6 +10,7 @@
 
 /***************************** Include Files ********************************/
 #include "reconfig_pcap.h"
+#include "reconfig_os.h"
 #include "ff.h"
 #include "string.h"
 #include "xtime_l.h"
@@ -25,6 +26,12 @@
 /************************** Constant Definitions ****************************/
 #define READ_BLOCK_SIZE 512  // Block size in bytes when reading from file
 #define READ_FRAME_SIZE 256  // Buffer size to store configuration header and tail
+#define BRAM_CONTENT_FRAMES 128  // Frames of the contents of a BRAM column in a clock region
+#ifndef BRAM_ERASE_BLOCK_FRAMES
+#define BRAM_ERASE_BLOCK_FRAMES 32 // Frames of the zero block that is sent repeatedly to erase the BRAM
+#endif
+#define PBS_MERGE   0 // copy_clock_region_PBS() copies the PBS to the frames read back
+#define PBS_EXTRACT 1 // copy_clock_region_PBS() copies the frames read back to the PBS
 
 // SLCR registers
 #define SLCR_LOCK   0xF8000004        // SLCR Write Protection Lock
@@ -40,13 +47,132 @@
 #define PCAP_CLK_DIVISOR 0x0A       // PCAP clock divisor (6bits)
 #define PCAP_CLK_SOURCE 0x0         // PCAP clock source (0b00 -> IO PLL@1000Hz; 0b10 -> ARM PLL@1333Hz; 0b11 -> DDR PLL@1067Hz)
 
+// PLL frequencies used to order the clock settings tried by PCAP_calibrate_clock()
+#ifndef PCAP_IO_PLL_HZ
+#define PCAP_IO_PLL_HZ  1000000000
+#endif
+#ifndef PCAP_ARM_PLL_HZ
+#define PCAP_ARM_PLL_HZ 1333333333
+#endif
+#ifndef PCAP_DDR_PLL_HZ
+#define PCAP_DDR_PLL_HZ 1066666667
+#endif
+#ifndef PCAP_RATED_MAX_HZ
+#define PCAP_RATED_MAX_HZ 200000000       // Maximum PCAP clock in the data sheet of the device
+#endif
+#ifndef PCAP_CALIBRATION_MAX_HZ
+#define PCAP_CALIBRATION_MAX_HZ PCAP_RATED_MAX_HZ // Faster settings are not tried
+#endif
+#ifndef PCAP_CALIBRATION_OVERCLOCK
+#define PCAP_CALIBRATION_OVERCLOCK 0      // Set to 1 to try settings above the rated maximum
+#endif
+#if PCAP_CALIBRATION_MAX_HZ > PCAP_RATED_MAX_HZ && !PCAP_CALIBRATION_OVERCLOCK
+#error "PCAP_CALIBRATION_MAX_HZ is above PCAP_RATED_MAX_HZ, set PCAP_CALIBRATION_OVERCLOCK to 1 to allow it"
+#endif
+#ifndef PCAP_CALIBRATION_RUNS
+#define PCAP_CALIBRATION_RUNS 4           // Transfers that must be correct to accept a setting
+#endif
+#define PCAP_CALIBRATION_MAX_SETTINGS (3 * 0x3F)
+
+// Check of the writes with the configuration CRC
+#define PCAP_CRC_RESET    0 // The CRC is only reset (RCRC) and the writes are not checked
+#define PCAP_CRC_COMPUTED 1 // The CRC of the packets is computed while they are sent and checked by the device
+#define PCAP_CRC_DISABLED 2 // The constant of the bitstreams generated with the CRC disabled is written
+#ifndef PCAP_CRC_MODE
+#define PCAP_CRC_MODE PCAP_CRC_COMPUTED
+#endif
+#define PCAP_CRC_POLYNOMIAL 0x82F63B78 // CRC-32C (Castagnoli), reflected
+
+#ifndef CAP_BENCHMARK_RUNS
+#define CAP_BENCHMARK_RUNS 8 // Writes and readbacks measured by CAP_benchmark_transport()
+#endif
+
 //#define PCAP_TIMING // If defined, elapsed times will be computed
 #ifdef PCAP_TIMING
 #include "stdio.h" // Include printf(...) function
 #endif // #ifdef PCAP_TIMING
 
 
+/**************************** Type Definitions ******************************/
+// State of the configuration CRC of the packets sent to the PCAP
+typedef struct
+{
+    u32 crc;
+    u32 reg;        // Register written by the data words of the actual packet
+    u32 data_words; // Data words of the actual packet that have not been sent yet
+} PCAP_crc_t;
+
+
+/************************** Variable Definitions ****************************/
+// Settings of the PCAP clock and value written in the SLCR (0 if it is unknown)
+#ifdef PCAP_CLK_RW
+static u32 PCAP_clk_ctrl_read = PCAP_CLK_CTRL_VALUE(PCAP_CLK_SOURCE, PCAP_CLK_DIVISOR_READ);
+static u32 PCAP_clk_ctrl_write = PCAP_CLK_CTRL_VALUE(PCAP_CLK_SOURCE, PCAP_CLK_DIVISOR_WRITE);
+#else
+static u32 PCAP_clk_ctrl_read = PCAP_CLK_CTRL_VALUE(PCAP_CLK_SOURCE, PCAP_CLK_DIVISOR);
+static u32 PCAP_clk_ctrl_write = PCAP_CLK_CTRL_VALUE(PCAP_CLK_SOURCE, PCAP_CLK_DIVISOR);
+#endif // #ifdef PCAP_CLK_RW
+static u32 PCAP_clk_ctrl_current = 0;
+
+// Configuration port of the transfers, changed with the PCAP locked (see CAP_set_transport())
+static u32 CAP_transport = CAP_TRANSPORT_PCAP;
+// Interface selected in the DEVCFG and number of times that it has changed
+static u32 CAP_interface = CAP_INTERFACE_PCAP;
+static u32 CAP_interface_switches = 0;
+#ifdef XPAR_HWICAP_0_DEVICE_ID
+static XHwIcap HWICAP_component;
+#endif
+
+static void (*PCAP_idle_callback)(void *) = NULL; // Called while the PCAP transfers are in flight
+static void *PCAP_idle_callback_data = NULL;
+
+// Tables of the CRC: 4 bytes of data in each step (slicing-by-4) and the 5 bits of
+// the register address. They are filled by PCAP_Initialize().
+static u32 PCAP_crc_table[4][256];
+static u32 PCAP_crc_address_table[32];
+
+// Zero frames used to erase the BRAM contents (in the .bss, so they are already zero)
+static u32 BRAM_zero_frames[BRAM_ERASE_BLOCK_FRAMES * NUM_FRAME_WORDS] __attribute__ ((aligned (32)));
+
+// State of the incremental load of a PBS from the SD card
+static FATFS SD_load_fatfs;
+static FIL SD_load_file;
+static u32 *SD_load_addr_current;
+static int SD_load_state = SD_LOAD_IDLE;
+
+
+
 /************************** Function Prototypes *****************************/
+static void PCAP_wait_transfer(XDcfg *InstancePtr);
+static u32 load_bitstream(const char *file_name, u32 *addr_start, u32 *addr_limit);
+static u32 read_bitstream_file(const char *file_name, u32 *addr_start, u32 *addr_limit);
+static u32 write_bitstream_file(const char *file_name, u32 *addr_start, u32 TotalWords);
+static int open_bitstream_file(const char *file_name, u32 *addr_start, u32 *addr_limit);
+static int read_bitstream_blocks(u32 max_bytes, u32 **addr_end);
+static int PCAP_write_frames(XDcfg *InstancePtr, u32 *addr_start, u32 addr_end, u32 x0, u32 y0, u32 xf, u32 yf, u32 erase_bram);
+static int PCAP_read_frames(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf, u32 yf);
+static int PCAP_write_BRAM(XDcfg *InstancePtr, u32 *image, u32 x0, u32 y0, u32 xf, u32 yf);
+static int PCAP_write_BRAM_frames(XDcfg *InstancePtr, u32 **image, u32 x0, u32 y0, u32 xf, u32 yf, PCAP_crc_t *crc);
+static u32 BRAM_column_group(u32 y, u32 x, u32 xf, u32 *num_columns);
+static int PCAP_compare_frames(XDcfg *InstancePtr, u32 *image, u32 x0, u32 y, u32 xf, u32 *work_addr, int *bad_frame);
+static int PCAP_send(XDcfg *InstancePtr, u32 *addr, u32 TotalWords, PCAP_crc_t *crc);
+static int PCAP_receive(XDcfg *InstancePtr, u32 *WriteBuffer, u32 Index, u32 *addr, u32 TotalWords);
+static int CAP_set_transport(XDcfg *InstancePtr, u32 transport);
+static void PCAP_init_crc_tables();
+static void PCAP_crc_update(PCAP_crc_t *crc, const u32 *addr, u32 TotalWords);
+static u32 PCAP_crc_tail(u32 *WriteBuffer, u32 Index, PCAP_crc_t *crc);
+static int PCAP_check_crc(XDcfg *InstancePtr);
+static void PCAP_set_clock(u32 clk_ctrl);
+static u32 PCAP_clock_hz(u32 clk_ctrl);
+static int PCAP_clock_settings(u32 settings[PCAP_CALIBRATION_MAX_SETTINGS]);
+static int PCAP_test_read_clock(XDcfg *InstancePtr, u32 clk_ctrl, u32 *reference, u32 *reference_end, u32 *test, u32 x, u32 y);
+static int PCAP_test_write_clock(XDcfg *InstancePtr, u32 clk_ctrl, u32 *reference, u32 *reference_end, u32 *test, u32 x, u32 y);
+static int find_staging_region(staging_buffer_t *buffer, int y, int x0, int xf);
+static int readback_subclock_region(XDcfg *InstancePtr, staging_buffer_t *buffer, pblock pblock_list[], u32 num_pblocks);
+static int write_subclock_region(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *addr_start, const char *file_name, u32 *PBS_first_addr, u32 *PBS_last_addr, pblock pblock_list[], u32 num_pblocks, u32 erase_bram, u8 stacked_modules, u8 contiguous_frames);
+static void subclock_region_state_size(pblock pblock_list[], u32 num_pblocks, u32 *CLB_words, u32 *BRAM_words, u32 *work_words);
+static int copy_subclock_region_state(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *work_addr, u32 *state_addr, pblock pblock_list[], u32 num_pblocks, u32 block, int direction, u32 **state_end);
+
 
 /****************************************************************************/
 /**
@@ -60,6 +186,29 @@
 *
 *****************************************************************************/
 u32 load_bitstream_from_SD_to_RAM(const char *file_name, u32 *addr_start) 
+{
+    return load_bitstream(file_name, addr_start, NULL);
+}
+
+/*
+* Loads a PBS file from the SD card. If addr_limit is not NULL the file must fit
+* below it.
+*/
+static u32 load_bitstream(const char *file_name, u32 *addr_start, u32 *addr_limit)
+{
+    u32 addr_end;
+
+    reconfig_os_lock(RECONFIG_LOCK_SD);
+    addr_end = read_bitstream_file(file_name, addr_start, addr_limit);
+    reconfig_os_unlock(RECONFIG_LOCK_SD);
+
+    return addr_end;
+}
+
+/*
+* Body of load_bitstream(), called with the SD card locked
+*/
+static u32 read_bitstream_file(const char *file_name, u32 *addr_start, u32 *addr_limit)
 {
   // Local variables
     u32 Index;
@@ -76,6 +225,9 @@ u32 load_bitstream_from_SD_to_RAM(const char *file_name, u32 *addr_start)
     XTime_SetTime(0); // Initialize time count
 #endif // #ifdef PCAP_TIMING
 
+    // The file system cannot be shared with an incremental load
+    finish_bitstream_load_from_SD(NULL);
+
     // Mount FAT file system
     rc = f_mount (&fatfs, "", 1); //We open the default drive
     if(rc)
@@ -92,6 +244,15 @@ u32 load_bitstream_from_SD_to_RAM(const char *file_name, u32 *addr_start)
         return 0;
     }
 
+    // The whole file must fit in the RAM region
+    if (addr_limit != NULL && f_size(&file) > ((u32) addr_limit - (u32) addr_start))
+    {
+        xil_printf("ERROR: File %s does not fit in RAM\n", file_name);
+        f_close(&file);
+        f_mount(0, "", 0);
+        return 0;
+    }
+
     // Initialize variables
     Index = (u32)addr_start;
     buffer = addr_start;
@@ -153,6 +314,20 @@ u32 load_bitstream_from_SD_to_RAM(const char *file_name, u32 *addr_start)
 *
 *****************************************************************************/
 u32 load_bitstream_from_RAM_to_SD(const char *file_name, u32 *addr_start, u32 TotalWords)
+{
+    u32 addr_end;
+
+    reconfig_os_lock(RECONFIG_LOCK_SD);
+    addr_end = write_bitstream_file(file_name, addr_start, TotalWords);
+    reconfig_os_unlock(RECONFIG_LOCK_SD);
+
+    return addr_end;
+}
+
+/*
+* Body of load_bitstream_from_RAM_to_SD(), called with the SD card locked
+*/
+static u32 write_bitstream_file(const char *file_name, u32 *addr_start, u32 TotalWords)
 {
   // Local variables
 UINT bytes;        // Byte count (memory positions)
@@ -169,6 +344,9 @@ UINT bytes;        // Byte count (memory positions)
   XTime_SetTime(0); // Initialize time count
 #endif // #ifdef PCAP_TIMING
 
+  // The file system cannot be shared with an incremental load
+  finish_bitstream_load_from_SD(NULL);
+
   // Mount FAT file system
   rc = f_mount (&fatfs, "", 1); //We open the default drive
   if(rc)
@@ -226,6 +404,206 @@ UINT bytes;        // Byte count (memory positions)
   return 1;
 }
 
+/****************************************************************************/
+/**
+*
+* Starts loading a partial bitstream file from the external SD card to the
+* on-board RAM. The file is read in blocks with continue_bitstream_load_from_SD()
+* so that the load can be done while other work (e.g. a PCAP transfer) is in
+* progress. Only one incremental load can be in progress.
+*
+* @param file_name is the name of the PBS file stored in the SD card
+* @param addr_start is the initial position of the PBS in the RAM
+* @param addr_limit is the first position of the RAM that cannot be written
+*
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int start_bitstream_load_from_SD(const char *file_name, u32 *addr_start, u32 *addr_limit)
+{
+    int Status;
+
+    reconfig_os_lock(RECONFIG_LOCK_SD);
+    Status = open_bitstream_file(file_name, addr_start, addr_limit);
+    reconfig_os_unlock(RECONFIG_LOCK_SD);
+
+    return Status;
+}
+
+/*
+* Body of start_bitstream_load_from_SD(), called with the SD card locked
+*/
+static int open_bitstream_file(const char *file_name, u32 *addr_start, u32 *addr_limit)
+{
+    FRESULT rc;       // File management status
+
+    if (SD_load_state == SD_LOAD_IN_PROGRESS)
+    {
+        return XST_FAILURE;
+    }
+
+    // Mount FAT file system
+    rc = f_mount(&SD_load_fatfs, "", 1);
+    if(rc)
+    {
+        xil_printf("ERROR %02d: FAT file system not mounted\n", rc);
+        SD_load_state = SD_LOAD_ERROR;
+        return XST_FAILURE;
+    }
+
+    // Open input file
+    rc = f_open(&SD_load_file, file_name, FA_READ);
+    if(rc)
+    {
+        xil_printf("ERROR %02d: File %s not opened\n", rc, file_name);
+        f_mount(0, "", 0);
+        SD_load_state = SD_LOAD_ERROR;
+        return XST_FAILURE;
+    }
+
+    // The whole file must fit in the RAM region
+    if (f_size(&SD_load_file) > ((u32) addr_limit - (u32) addr_start))
+    {
+        xil_printf("ERROR: File %s does not fit in RAM\n", file_name);
+        f_close(&SD_load_file);
+        f_mount(0, "", 0);
+        SD_load_state = SD_LOAD_ERROR;
+        return XST_FAILURE;
+    }
+
+    SD_load_addr_current = addr_start;
+    SD_load_state = SD_LOAD_IN_PROGRESS;
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Continues the load started with start_bitstream_load_from_SD(). At most
+* max_bytes (rounded up to READ_BLOCK_SIZE) are read from the file and their
+* byte endianness is reordered.
+*
+* @param max_bytes is the maximum number of bytes read in this call
+* @param addr_end returns the final position of the PBS in the RAM when the load
+* finishes (it can be NULL)
+*
+* @return   SD_LOAD_IN_PROGRESS, SD_LOAD_DONE, SD_LOAD_ERROR or SD_LOAD_IDLE if
+* there is no load in progress
+*
+*****************************************************************************/
+int continue_bitstream_load_from_SD(u32 max_bytes, u32 **addr_end)
+{
+    int state;
+
+    reconfig_os_lock(RECONFIG_LOCK_SD);
+    state = read_bitstream_blocks(max_bytes, addr_end);
+    reconfig_os_unlock(RECONFIG_LOCK_SD);
+
+    return state;
+}
+
+/*
+* Body of continue_bitstream_load_from_SD(), called with the SD card locked
+*/
+static int read_bitstream_blocks(u32 max_bytes, u32 **addr_end)
+{
+    UINT bytes;       // Byte count (memory positions)
+    u32 read_bytes;   // Bytes read in this call
+    FRESULT rc;       // File management status
+    u32 *buffer;      // First word read in this call
+    int i;            // Loop variable
+
+    if (SD_load_state != SD_LOAD_IN_PROGRESS)
+    {
+        // The load may have been completed by finish_bitstream_load_from_SD()
+        if (SD_load_state == SD_LOAD_DONE && addr_end != NULL)
+        {
+            *addr_end = SD_load_addr_current;
+        }
+        return SD_load_state;
+    }
+
+    buffer = SD_load_addr_current;
+    read_bytes = 0;
+    do
+    {
+        // Read block from file
+        rc = f_read(&SD_load_file, SD_load_addr_current, READ_BLOCK_SIZE, &bytes);
+        if(rc)
+        {
+            xil_printf("ERROR %02d: PBS not read\n", rc);
+            abort_bitstream_load_from_SD();
+            SD_load_state = SD_LOAD_ERROR;
+            return SD_LOAD_ERROR;
+        }
+        read_bytes += bytes;
+        SD_load_addr_current += (bytes/sizeof(u32));
+    } while (read_bytes < max_bytes && !f_eof(&SD_load_file));
+
+    // Reorder wrong byte endianness
+    for(i = 0; i < (read_bytes/sizeof(u32)); i++)
+    {
+        buffer[i] = ((buffer[i] & 0xFF) << 24) + ((buffer[i] & 0xFF00) << 8) + ((buffer[i] & 0xFF0000) >> 8) + ((buffer[i] & 0xFF000000) >> 24);
+    }
+
+    if (f_eof(&SD_load_file))
+    {
+        f_close(&SD_load_file);
+        f_mount(0, "", 0);
+        SD_load_state = SD_LOAD_DONE;
+        if (addr_end != NULL)
+        {
+            *addr_end = SD_load_addr_current;
+        }
+    }
+
+    return SD_load_state;
+}
+
+/****************************************************************************/
+/**
+*
+* Completes the load started with start_bitstream_load_from_SD()
+*
+* @param addr_end returns the final position of the PBS in the RAM (it can be
+* NULL)
+*
+* @return   SD_LOAD_DONE, SD_LOAD_ERROR or SD_LOAD_IDLE if there was no load
+*
+*****************************************************************************/
+int finish_bitstream_load_from_SD(u32 **addr_end)
+{
+    int state;
+
+    do
+    {
+        state = continue_bitstream_load_from_SD(0xFFFFFFFF, addr_end);
+    } while (state == SD_LOAD_IN_PROGRESS);
+
+    return state;
+}
+
+/****************************************************************************/
+/**
+*
+* Cancels the load started with start_bitstream_load_from_SD()
+*
+* @return   none
+*
+*****************************************************************************/
+void abort_bitstream_load_from_SD()
+{
+    reconfig_os_lock(RECONFIG_LOCK_SD);
+    if (SD_load_state == SD_LOAD_IN_PROGRESS)
+    {
+        f_close(&SD_load_file);
+        f_mount(0, "", 0);
+    }
+    SD_load_state = SD_LOAD_IDLE;
+    reconfig_os_unlock(RECONFIG_LOCK_SD);
+}
+
 /****************************************************************************/
 /**
 *
@@ -260,9 +638,26 @@ int PCAP_Initialize(XDcfg *InstancePtr, u16 DeviceId)
         return XST_FAILURE;
     }
 
+#ifdef XPAR_HWICAP_0_DEVICE_ID
+    // The HWICAP reads the IDCODE through the ICAPE2 when it is initialized
+    XHwIcap_Config *HwIcapConfigPtr = XHwIcap_LookupConfig(XPAR_HWICAP_0_DEVICE_ID);
+    if (HwIcapConfigPtr == NULL)
+    {
+        return XST_FAILURE;
+    }
+    XDcfg_SelectIcapInterface(InstancePtr);
+    Status = XHwIcap_CfgInitialize(&HWICAP_component, HwIcapConfigPtr, HwIcapConfigPtr->BaseAddress);
+    if (Status != XST_SUCCESS)
+    {
+        return XST_FAILURE;
+    }
+#endif
+
     // Select PCAP interface for partial reconfiguration
     XDcfg_EnablePCAP(InstancePtr);
     XDcfg_SetControlRegister(InstancePtr, XDCFG_CTRL_PCAP_PR_MASK);
+    CAP_interface = CAP_INTERFACE_PCAP;
+    CAP_interface_switches = 0;
 
     // Clear the interrupt status bits
     //XDcfg_IntrDisable(InstancePtr, XDCFG_IXR_ALL_MASK);
@@ -275,12 +670,11 @@ int PCAP_Initialize(XDcfg *InstancePtr, u16 DeviceId)
         return XST_FAILURE;
     }
 
-#ifndef PCAP_CLK_RW
     // Change PCAP clock configuration
-    *(volatile u32*)(SLCR_UNLOCK) = SLCR_UNLOCK_VAL;
-    *(volatile u32*)(SLCR_PCAP_CLK_CTRL) = ((PCAP_CLK_DIVISOR & 0x3F) << 8) | ((PCAP_CLK_SOURCE & 0x3) << 4) | 0x1;
-    *(volatile u32*)(SLCR_LOCK) = SLCR_LOCK_VAL;
-#endif // #ifndef PCAP_CLK_RW
+    PCAP_clk_ctrl_current = 0;
+    PCAP_set_clock(PCAP_clk_ctrl_write);
+
+    PCAP_init_crc_tables();
 
     return XST_SUCCESS;
 }
@@ -288,335 +682,1537 @@ int PCAP_Initialize(XDcfg *InstancePtr, u16 DeviceId)
 /****************************************************************************/
 /**
 *
-* Writes PBS file using PCAP interface
+* Sets a function that is called while the PCAP waits for the end of a
+* transfer so that other work (e.g. loading the next PBS from the SD card with
+* continue_bitstream_load_from_SD()) overlaps with the reconfiguration. The
+* function must not use the PCAP and should return quickly.
 *
-* @param InstancePtr is a pointer to the PCAP instance.
-* @param addr_ini is a pointer to the frame that is to be written to the device
-* @param addr_end is the value of the last memory position of the PBS
-* @param x0, y0, xf, yf are the coordinates of the region to be reconfigured
+* @param callback is the function to be called or NULL
+* @param data is the argument passed to the callback
 *
-* @return   XST_SUCCESS else XST_FAILURE.
+* @return   none
 *
 *****************************************************************************/
-int PCAP_RAM_write(XDcfg *InstancePtr, u32 *addr_start, u32 addr_end, u32 x0, u32 y0, u32 xf, u32 yf, u32 erase_bram)
+void PCAP_set_idle_callback(void (*callback)(void *), void *data)
 {
-	u32 Index =0;
-	u32 Packet;
-    u32 Data;
-    u32 TotalWords;
-    int Status;
-    static u32 WriteBuffer[READ_FRAME_SIZE];
-    volatile u32 IntrStsReg = 0;
-
-#ifdef PCAP_TIMING
-    XTime time, transfer; // Elapsed time local variable
-    XTime_SetTime(0);     // Initialize time count
-#endif // #ifdef PCAP_TIMING
-
-    Xil_AssertNonvoid(InstancePtr != NULL);
-    Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
-    Xil_AssertNonvoid(addr_start != NULL);
-
-#ifdef PCAP_CLK_RW
-    // Change PCAP clock configuration
-    *(volatile u32*)(SLCR_UNLOCK) = SLCR_UNLOCK_VAL;
-    *(volatile u32*)(SLCR_PCAP_CLK_CTRL) = ((PCAP_CLK_DIVISOR_WRITE & 0x3F) << 8) | ((PCAP_CLK_SOURCE & 0x3) << 4) | 0x1;
-    *(volatile u32*)(SLCR_LOCK) = SLCR_LOCK_VAL;
-#endif // #ifdef PCAP_CLK_RW
+    PCAP_idle_callback = callback;
+    PCAP_idle_callback_data = data;
+}
 
-    // Bus Width, DUMMY and SYNC
-    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
-    WriteBuffer[Index++] = PCAP_BW_SYNC;
-    WriteBuffer[Index++] = PCAP_BW_DETECT;
-    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
-    WriteBuffer[Index++] = PCAP_SYNC_PACKET;
-    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
-    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+/****************************************************************************/
+/**
+*
+* Finds the fastest PCAP clock settings that read and write correctly a column
+* of the FPGA. The column is read back with the actual settings and then the
+* settings are tried from the fastest to the slowest (up to
+* PCAP_CALIBRATION_MAX_HZ, which cannot be above the rated maximum of the
+* device unless PCAP_CALIBRATION_OVERCLOCK is set to 1, since a setting that
+* passes a few runs may fail with other temperature or voltage): each read
+* setting must read back the same frames
+* and each write setting must write back the frames so that they are read
+* correctly with the actual read setting. Each setting is tried
+* PCAP_CALIBRATION_RUNS times. The frames are restored after a failed write.
+* If no faster setting works the actual settings are kept.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param x is the column used for the test. It must not contain logic that is
+* being used (e.g. the column of an empty partition)
+* @param y is the clock region row of the column
+* @param work_addr is a RAM buffer of PCAP_CALIBRATION_WORDS(frames of the
+* column) words
+*
+* @return   XST_SUCCESS else XST_FAILURE if the column cannot be read back
+*
+*****************************************************************************/
+int PCAP_calibrate_clock(XDcfg *InstancePtr, u32 x, u32 y, u32 *work_addr)
+{
+    u32 settings[PCAP_CALIBRATION_MAX_SETTINGS];
+    u32 *reference, *reference_end, *test;
+    u32 safe_read, safe_write;
+    int num_settings, i;
+    int Status;
 
-    // Reset CRC
-    Packet = PCAP_Type1Write(PCAP_CMD) | 1;
-    Data = PCAP_CMD_RCRC;
-    WriteBuffer[Index++] = Packet;
-    WriteBuffer[Index++] = Data;
-    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
-    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
 
-    // ID register
-    Packet = PCAP_Type1Write(PCAP_IDCODE) | 1;
-    Data = PCAP_IDCODE_NUMBER;
-    WriteBuffer[Index++] = Packet;
-    WriteBuffer[Index++] = Data;
+    safe_read = PCAP_clk_ctrl_read;
+    safe_write = PCAP_clk_ctrl_write;
+    reference = work_addr;
+    test = work_addr + PCAP_CALIBRATION_WORDS(fpga[y][x][0] & 0xFFFF) / 2;
 
-    // Repeat for each clock region
-    u32 *addr_send = addr_start;
-    int x, y;
-    for(y = y0; y <= yf; y++)
+    // Reference image of the column
+    reference_end = reference;
+    Status = PCAP_read_frames(InstancePtr, &reference_end, x, y, x, y);
+    if (Status != XST_SUCCESS)
     {
-        // Setup CMD register - write configuration
-        Packet = PCAP_Type1Write(PCAP_CMD) | 1;
-        Data = PCAP_CMD_WCFG;
-        WriteBuffer[Index++] = Packet;
-        WriteBuffer[Index++] = Data;
-        WriteBuffer[Index++] = PCAP_NOOP_PACKET;
-
-        // Setup FAR
-        Packet = PCAP_Type1Write(PCAP_FAR) | 1;
-        Data = PCAP_SetupFar7S((fpga[y][x0][0] & (0xFF << 24))>>24, PCAP_FAR_CLB_BLOCK, (fpga[y][x0][0] & (0xFF << 16))>>16, x0, 0);
-        WriteBuffer[Index++] = Packet;
-        WriteBuffer[Index++] = Data;
-        WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+        reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+        return XST_FAILURE;
+    }
 
-        // Setup Packet header
-        TotalWords = 0;
-        for(x = x0; x <= xf; x++)
+    num_settings = PCAP_clock_settings(settings);
+    for (i = 0; i < num_settings && PCAP_clock_hz(settings[i]) > PCAP_clock_hz(safe_read); i++)
+    {
+        if (PCAP_test_read_clock(InstancePtr, settings[i], reference, reference_end, test, x, y) == XST_SUCCESS)
         {
-            TotalWords += (fpga[y][x][0] & 0xFFFF) * NUM_FRAME_WORDS;
+            break;
         }
-        TotalWords += NUM_FRAME_WORDS;//We add a padding frame
+    }
+    PCAP_clk_ctrl_read = (i < num_settings && PCAP_clock_hz(settings[i]) > PCAP_clock_hz(safe_read)) ? settings[i] : safe_read;
 
-        if (TotalWords < PCAP_TYPE_1_PACKET_MAX_WORDS)
+    // The writes are checked with the read setting that has just been validated
+    for (i = 0; i < num_settings && PCAP_clock_hz(settings[i]) > PCAP_clock_hz(safe_write); i++)
+    {
+        if (PCAP_test_write_clock(InstancePtr, settings[i], reference, reference_end, test, x, y) == XST_SUCCESS)
         {
-            // Create Type 1 Packet
-            Packet = PCAP_Type1Write(PCAP_FDRI) | TotalWords;
-            WriteBuffer[Index++] = Packet;
+            break;
         }
-        else
-        {
-            // Create Type 2 Packet
-            Packet = PCAP_Type1Write(PCAP_FDRI);
-            WriteBuffer[Index++] = Packet;
+        // The column is restored with the previous setting
+        PCAP_write_frames(InstancePtr, reference, (u32) reference_end, x, y, x, y, PCAP_BRAM_DONOTHING);
+    }
+    PCAP_clk_ctrl_write = (i < num_settings && PCAP_clock_hz(settings[i]) > PCAP_clock_hz(safe_write)) ? settings[i] : safe_write;
 
-            Packet = PCAP_TYPE_2_WRITE | TotalWords;
-            WriteBuffer[Index++] = Packet;
-        }
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
 
-#ifdef PCAP_TIMING
-        XTime_GetTime(&time); // Get time count
-#endif // #ifdef PCAP_TIMING
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Returns the PCAP clock settings (value of the SLCR PCAP_CLK_CTRL register)
+* used by the reads and the writes
+*
+* @param read_clk_ctrl returns the setting of the reads
+* @param write_clk_ctrl returns the setting of the writes
+*
+* @return   none
+*
+*****************************************************************************/
+void PCAP_get_clock_settings(u32 *read_clk_ctrl, u32 *write_clk_ctrl)
+{
+    *read_clk_ctrl = PCAP_clk_ctrl_read;
+    *write_clk_ctrl = PCAP_clk_ctrl_write;
+}
+
+/****************************************************************************/
+/**
+*
+* Changes the PCAP clock settings used by the reads and the writes (e.g. to
+* restore the result of a previous calibration)
+*
+* @param read_clk_ctrl is the setting of the reads (see PCAP_CLK_CTRL_VALUE())
+* @param write_clk_ctrl is the setting of the writes
+*
+* @return   none
+*
+*****************************************************************************/
+void PCAP_set_clock_settings(u32 read_clk_ctrl, u32 write_clk_ctrl)
+{
+    PCAP_clk_ctrl_read = read_clk_ctrl;
+    PCAP_clk_ctrl_write = write_clk_ctrl;
+}
+
+/****************************************************************************/
+/**
+*
+* Writes the PCAP clock control register of the SLCR if its value changes
+*
+* @param clk_ctrl is the new value of the register
+*
+* @return   none
+*
+*****************************************************************************/
+static void PCAP_set_clock(u32 clk_ctrl)
+{
+    if (clk_ctrl == PCAP_clk_ctrl_current)
+    {
+        return;
+    }
+    *(volatile u32*)(SLCR_UNLOCK) = SLCR_UNLOCK_VAL;
+    *(volatile u32*)(SLCR_PCAP_CLK_CTRL) = clk_ctrl;
+    *(volatile u32*)(SLCR_LOCK) = SLCR_LOCK_VAL;
+    PCAP_clk_ctrl_current = clk_ctrl;
+}
+
+/****************************************************************************/
+/**
+*
+* @param clk_ctrl is a value of the PCAP clock control register
+*
+* @return   frequency of the PCAP clock in Hz
+*
+*****************************************************************************/
+static u32 PCAP_clock_hz(u32 clk_ctrl)
+{
+    u32 divisor = (clk_ctrl >> 8) & 0x3F;
+    u32 pll_hz;
+
+    switch ((clk_ctrl >> 4) & 0x3)
+    {
+        case 0x2:
+            pll_hz = PCAP_ARM_PLL_HZ;
+            break;
+        case 0x3:
+            pll_hz = PCAP_DDR_PLL_HZ;
+            break;
+        default:
+            pll_hz = PCAP_IO_PLL_HZ;
+            break;
+    }
+    return divisor == 0 ? 0 : pll_hz / divisor;
+}
+
+/****************************************************************************/
+/**
+*
+* Lists the clock settings up to PCAP_CALIBRATION_MAX_HZ from the fastest to
+* the slowest
+*
+* @param settings returns the values of the PCAP clock control register
+*
+* @return   number of settings
+*
+*****************************************************************************/
+static int PCAP_clock_settings(u32 settings[PCAP_CALIBRATION_MAX_SETTINGS])
+{
+    const u32 sources[3] = {0x0, 0x2, 0x3}; // IO PLL, ARM PLL and DDR PLL
+    u32 setting, divisor;
+    int num_settings = 0;
+    int i, j;
+
+    for (i = 0; i < 3; i++)
+    {
+        for (divisor = 1; divisor <= 0x3F; divisor++)
+        {
+            setting = PCAP_CLK_CTRL_VALUE(sources[i], divisor);
+            if (PCAP_clock_hz(setting) > PCAP_CALIBRATION_MAX_HZ)
+            {
+                continue;
+            }
+            // Insertion in frequency order
+            for (j = num_settings; j > 0 && PCAP_clock_hz(settings[j - 1]) < PCAP_clock_hz(setting); j--)
+            {
+                settings[j] = settings[j - 1];
+            }
+            settings[j] = setting;
+            num_settings++;
+        }
+    }
+    return num_settings;
+}
+
+/****************************************************************************/
+/**
+*
+* Reads back the test column PCAP_CALIBRATION_RUNS times with a clock setting
+* and compares it with the reference image
+*
+* @return   XST_SUCCESS if all the readbacks are correct else XST_FAILURE
+*
+*****************************************************************************/
+static int PCAP_test_read_clock(XDcfg *InstancePtr, u32 clk_ctrl, u32 *reference, u32 *reference_end, u32 *test, u32 x, u32 y)
+{
+    u32 saved_clk_ctrl = PCAP_clk_ctrl_read;
+    u32 *test_end;
+    int Status = XST_SUCCESS;
+    int run;
+
+    PCAP_clk_ctrl_read = clk_ctrl;
+    for (run = 0; run < PCAP_CALIBRATION_RUNS && Status == XST_SUCCESS; run++)
+    {
+        test_end = test;
+        if (PCAP_read_frames(InstancePtr, &test_end, x, y, x, y) != XST_SUCCESS
+            || test_end - test != reference_end - reference
+            || memcmp(test, reference, (reference_end - reference) * sizeof(u32)) != 0)
+        {
+            Status = XST_FAILURE;
+        }
+    }
+    PCAP_clk_ctrl_read = saved_clk_ctrl;
+
+    return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Writes the reference image in the test column PCAP_CALIBRATION_RUNS times
+* with a clock setting and checks it by reading it back with the read setting
+*
+* @return   XST_SUCCESS if all the writes are correct else XST_FAILURE
+*
+*****************************************************************************/
+static int PCAP_test_write_clock(XDcfg *InstancePtr, u32 clk_ctrl, u32 *reference, u32 *reference_end, u32 *test, u32 x, u32 y)
+{
+    u32 saved_clk_ctrl = PCAP_clk_ctrl_write;
+    u32 *test_end;
+    int Status = XST_SUCCESS;
+    int run;
+
+    PCAP_clk_ctrl_write = clk_ctrl;
+    for (run = 0; run < PCAP_CALIBRATION_RUNS && Status == XST_SUCCESS; run++)
+    {
+        test_end = test;
+        if (PCAP_write_frames(InstancePtr, reference, (u32) reference_end, x, y, x, y, PCAP_BRAM_DONOTHING) != XST_SUCCESS
+            || PCAP_read_frames(InstancePtr, &test_end, x, y, x, y) != XST_SUCCESS
+            || test_end - test != reference_end - reference
+            || memcmp(test, reference, (reference_end - reference) * sizeof(u32)) != 0)
+        {
+            Status = XST_FAILURE;
+        }
+    }
+    PCAP_clk_ctrl_write = saved_clk_ctrl;
+
+    return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* @param transport is a configuration port
+*
+* @return   1 if the port can be used in this design else 0
+*
+*****************************************************************************/
+int CAP_transport_available(u32 transport)
+{
+#ifdef XPAR_HWICAP_0_DEVICE_ID
+    if (transport == CAP_TRANSPORT_HWICAP)
+    {
+        return HWICAP_component.IsReady == XIL_COMPONENT_IS_READY;
+    }
+#endif
+    return transport == CAP_TRANSPORT_PCAP;
+}
+
+/****************************************************************************/
+/**
+*
+* Selects the interface of the DEVCFG that drives the configuration: the PCAP
+* or the ICAPE2 (used by the fine-grain engine and the AXI HWICAP). The
+* selection is kept, so the DEVCFG is only written when it changes.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param interface is CAP_INTERFACE_PCAP or CAP_INTERFACE_ICAP
+*
+* @return   none
+*
+*****************************************************************************/
+void CAP_select_interface(XDcfg *InstancePtr, u32 interface)
+{
+    if (interface == CAP_interface)
+    {
+        return;
+    }
+    if (interface == CAP_INTERFACE_ICAP)
+    {
+        XDcfg_SelectIcapInterface(InstancePtr);
+    }
+    else
+    {
+        XDcfg_SelectPcapInterface(InstancePtr);
+    }
+    CAP_interface = interface;
+    CAP_interface_switches++;
+}
+
+/****************************************************************************/
+/**
+*
+* @return   interface of the DEVCFG that drives the configuration
+*
+*****************************************************************************/
+u32 CAP_get_interface()
+{
+    return CAP_interface;
+}
+
+/****************************************************************************/
+/**
+*
+* @return   number of times that the interface of the DEVCFG has changed
+*
+*****************************************************************************/
+u32 CAP_get_interface_switches()
+{
+    return CAP_interface_switches;
+}
+
+/****************************************************************************/
+/**
+*
+* Selects the configuration port of the next transfers. The interface of the
+* DEVCFG is selected by the transfers, so a port can be selected for a while
+* without changing it. It must be called with the PCAP locked.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param transport is the configuration port
+*
+* @return   XST_SUCCESS else XST_FAILURE if the port is not available
+*
+*****************************************************************************/
+static int CAP_set_transport(XDcfg *InstancePtr, u32 transport)
+{
+    if (transport == CAP_transport)
+    {
+        return XST_SUCCESS;
+    }
+    if (!CAP_transport_available(transport))
+    {
+        return XST_FAILURE;
+    }
+    CAP_transport = transport;
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Measures the bandwidth of a configuration port with the columns x0 to xf of
+* a clock region row. The reference image is read back through the PCAP and
+* then it is written and read back CAP_BENCHMARK_RUNS times through the port.
+* Each readback is compared with the reference image. If a transfer fails the
+* columns are restored through the PCAP.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param transport is the configuration port that is measured
+* @param x0, y, xf are the test columns and their clock region row
+* @param work_addr is a RAM buffer of CAP_BENCHMARK_WORDS(frames of the
+* columns) words
+* @param result returns the size of the transfers and their mean times
+*
+* @return   XST_SUCCESS else XST_FAILURE
+*
+*****************************************************************************/
+int CAP_benchmark_transport(XDcfg *InstancePtr, u32 transport, u32 x0, u32 y, u32 xf, u32 *work_addr, CAP_benchmark_t *result)
+{
+    u32 *reference, *reference_end, *test, *test_end;
+    XTime start, end, write_time, read_time;
+    u32 frames, x;
+    int run;
+    int Status;
+
+    frames = 0;
+    for (x = x0; x <= xf; x++)
+    {
+        frames += fpga[y][x][0] & 0xFFFF;
+    }
+    reference = work_addr;
+    test = work_addr + CAP_BENCHMARK_WORDS(frames) / 2;
+
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
+
+    reference_end = reference;
+    Status = PCAP_read_frames(InstancePtr, &reference_end, x0, y, xf, y);
+    if (Status != XST_SUCCESS || CAP_set_transport(InstancePtr, transport) != XST_SUCCESS)
+    {
+        reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+        return XST_FAILURE;
+    }
+
+    write_time = 0;
+    read_time = 0;
+    for (run = 0; run < CAP_BENCHMARK_RUNS && Status == XST_SUCCESS; run++)
+    {
+        XTime_GetTime(&start);
+        Status = PCAP_write_frames(InstancePtr, reference, (u32) reference_end, x0, y, xf, y, PCAP_BRAM_DONOTHING);
+        XTime_GetTime(&end);
+        write_time += end - start;
+        if (Status != XST_SUCCESS)
+        {
+            break;
+        }
+
+        test_end = test;
+        XTime_GetTime(&start);
+        Status = PCAP_read_frames(InstancePtr, &test_end, x0, y, xf, y);
+        XTime_GetTime(&end);
+        read_time += end - start;
+        if (Status == XST_SUCCESS
+            && (test_end - test != reference_end - reference
+            || memcmp(test, reference, (reference_end - reference) * sizeof(u32)) != 0))
+        {
+            Status = XST_FAILURE;
+        }
+    }
+    CAP_set_transport(InstancePtr, CAP_TRANSPORT_PCAP);
+    if (Status != XST_SUCCESS)
+    {
+        PCAP_write_frames(InstancePtr, reference, (u32) reference_end, x0, y, xf, y, PCAP_BRAM_DONOTHING);
+    }
+
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+    result->bytes = (reference_end - reference) * sizeof(u32);
+    result->write_us = (u32) (write_time * 1000000 / COUNTS_PER_SECOND / CAP_BENCHMARK_RUNS);
+    result->read_us = (u32) (read_time * 1000000 / COUNTS_PER_SECOND / CAP_BENCHMARK_RUNS);
+
+    return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Waits until the DMA and the PCAP finish the transfer. The idle callback is
+* called while the transfer is in progress.
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+*
+* @return   none
+*
+*****************************************************************************/
+static void PCAP_wait_transfer(XDcfg *InstancePtr)
+{
+    // Wait for IXR_DMA_DONE
+    reconfig_os_wait_PCAP(InstancePtr, XDCFG_IXR_DMA_DONE_MASK, PCAP_idle_callback, PCAP_idle_callback_data);
+    // Wait for IXR_D_P_DONE
+    reconfig_os_wait_PCAP(InstancePtr, XDCFG_IXR_DMA_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK, NULL, NULL);
+}
+
+/****************************************************************************/
+/**
+*
+* Writes PBS file using PCAP interface
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param addr_ini is a pointer to the frame that is to be written to the device
+* @param addr_end is the value of the last memory position of the PBS
+* @param x0, y0, xf, yf are the coordinates of the region to be reconfigured
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_RAM_write(XDcfg *InstancePtr, u32 *addr_start, u32 addr_end, u32 x0, u32 y0, u32 xf, u32 yf, u32 erase_bram)
+{
+    return CAP_RAM_write(InstancePtr, CAP_TRANSPORT_PCAP, addr_start, addr_end, x0, y0, xf, yf, erase_bram);
+}
+
+/****************************************************************************/
+/**
+*
+* Writes PBS file like PCAP_RAM_write() through the selected configuration port
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param transport is the configuration port (CAP_TRANSPORT_PCAP or CAP_TRANSPORT_HWICAP)
+* @param addr_ini is a pointer to the frame that is to be written to the device
+* @param addr_end is the value of the last memory position of the PBS
+* @param x0, y0, xf, yf are the coordinates of the region to be reconfigured
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int CAP_RAM_write(XDcfg *InstancePtr, u32 transport, u32 *addr_start, u32 addr_end, u32 x0, u32 y0, u32 xf, u32 yf, u32 erase_bram)
+{
+    int Status;
+
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
+    Status = CAP_set_transport(InstancePtr, transport);
+    if (Status == XST_SUCCESS)
+    {
+        Status = PCAP_write_frames(InstancePtr, addr_start, addr_end, x0, y0, xf, yf, erase_bram);
+        CAP_set_transport(InstancePtr, CAP_TRANSPORT_PCAP);
+    }
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+    return Status;
+}
+
+/*
+* Body of PCAP_RAM_write(), called with the PCAP locked
+*/
+static int PCAP_write_frames(XDcfg *InstancePtr, u32 *addr_start, u32 addr_end, u32 x0, u32 y0, u32 xf, u32 yf, u32 erase_bram)
+{
+	u32 Index =0;
+	u32 Packet;
+    u32 Data;
+    u32 TotalWords;
+    int Status;
+    u32 WriteBuffer[READ_FRAME_SIZE]; // Header and tail, kept in the stack so that the function is reentrant
+    PCAP_crc_t crc = {0, 0, 0};
+
+#ifdef PCAP_TIMING
+    XTime time, transfer; // Elapsed time local variable
+    XTime_SetTime(0);     // Initialize time count
+#endif // #ifdef PCAP_TIMING
+
+    Xil_AssertNonvoid(InstancePtr != NULL);
+    Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+    Xil_AssertNonvoid(addr_start != NULL);
+
+    // Change PCAP clock configuration
+    PCAP_set_clock(PCAP_clk_ctrl_write);
+
+    // Bus Width, DUMMY and SYNC
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_BW_SYNC;
+    WriteBuffer[Index++] = PCAP_BW_DETECT;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_SYNC_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+    // Reset CRC
+    Packet = PCAP_Type1Write(PCAP_CMD) | 1;
+    Data = PCAP_CMD_RCRC;
+    WriteBuffer[Index++] = Packet;
+    WriteBuffer[Index++] = Data;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+    // ID register
+    Packet = PCAP_Type1Write(PCAP_IDCODE) | 1;
+    Data = PCAP_IDCODE_NUMBER;
+    WriteBuffer[Index++] = Packet;
+    WriteBuffer[Index++] = Data;
+
+    // Repeat for each clock region
+    u32 *addr_send = addr_start;
+    int x, y;
+    for(y = y0; y <= yf; y++)
+    {
+        // Setup CMD register - write configuration
+        Packet = PCAP_Type1Write(PCAP_CMD) | 1;
+        Data = PCAP_CMD_WCFG;
+        WriteBuffer[Index++] = Packet;
+        WriteBuffer[Index++] = Data;
+        WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+        // Setup FAR
+        Packet = PCAP_Type1Write(PCAP_FAR) | 1;
+        Data = PCAP_SetupFar7S((fpga[y][x0][0] & (0xFF << 24))>>24, PCAP_FAR_CLB_BLOCK, (fpga[y][x0][0] & (0xFF << 16))>>16, x0, 0);
+        WriteBuffer[Index++] = Packet;
+        WriteBuffer[Index++] = Data;
+        WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+        // Setup Packet header
+        TotalWords = 0;
+        for(x = x0; x <= xf; x++)
+        {
+            TotalWords += (fpga[y][x][0] & 0xFFFF) * NUM_FRAME_WORDS;
+        }
+        TotalWords += NUM_FRAME_WORDS;//We add a padding frame
+
+        if (TotalWords < PCAP_TYPE_1_PACKET_MAX_WORDS)
+        {
+            // Create Type 1 Packet
+            Packet = PCAP_Type1Write(PCAP_FDRI) | TotalWords;
+            WriteBuffer[Index++] = Packet;
+        }
+        else
+        {
+            // Create Type 2 Packet
+            Packet = PCAP_Type1Write(PCAP_FDRI);
+            WriteBuffer[Index++] = Packet;
+
+            Packet = PCAP_TYPE_2_WRITE | TotalWords;
+            WriteBuffer[Index++] = Packet;
+        }
+
+#ifdef PCAP_TIMING
+        XTime_GetTime(&time); // Get time count
+#endif // #ifdef PCAP_TIMING
+
+        // Write header data.
+        Status = PCAP_send(InstancePtr, WriteBuffer, Index, &crc);
+        if (Status != XST_SUCCESS)
+        {
+            return XST_FAILURE;
+        }
+
+#ifdef PCAP_TIMING
+        XTime_GetTime(&transfer); // Get time count
+        printf("Write header elapsed time:        %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
+        printf("PCAP Bandwidth:                   %12.3f MB/s\n", ((float)Index*4)/((float)(transfer-time)*1000000/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)));
+        XTime_GetTime(&time); // Get time count
+#endif // #ifdef PCAP_TIMING
+
+        // Write the frame data. The CRC is computed while the DMA sends it
+        Status = PCAP_send(InstancePtr, addr_send, TotalWords, &crc);
+        if (Status != XST_SUCCESS)
+        {
+            return XST_FAILURE;
+        }
+
+#ifdef PCAP_TIMING
+        XTime_GetTime(&transfer); // Get time count
+        printf("Write frame data elapsed time:    %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
+        printf("PCAP Bandwidth:                   %12.3f MB/s\n", ((float)TotalWords*4)/((float)(transfer-time)*1000000/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)));
+#endif // #ifdef PCAP_TIMING
+
+        // Reset command buffer index
+        Index = 0;
+
+        // Increment initial address
+        addr_send = (u32*) ((u32) addr_send + (TotalWords  * BYTES_PER_WORD_OF_FRAME));
+
+        // Security check. We add a padding frame to the addr end
+        if((u32)addr_send > (addr_end + NUM_FRAME_WORDS*BYTES_PER_WORD_OF_FRAME))
+        {
+        	return XST_FAILURE;
+        }
+    }
+
+    // Erase BRAM contents if required
+    if (erase_bram == PCAP_BRAM_ERASE)
+    {
+        Status = PCAP_write_BRAM_frames(InstancePtr, NULL, x0, y0, xf, yf, &crc);
+        if (Status != XST_SUCCESS)
+        {
+            return XST_FAILURE;
+        }
+    }
+
+    // Add CRC
+    Index = PCAP_crc_tail(WriteBuffer, Index, &crc);
+
+    // DESYNC
+    Packet = (PCAP_Type1Write(PCAP_CMD) | 1);
+    Data = PCAP_CMD_DESYNCH;
+    WriteBuffer[Index++] = Packet;
+    WriteBuffer[Index++] = Data;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+
+#ifdef PCAP_TIMING
+    XTime_GetTime(&time); // Get time count
+#endif // #ifdef PCAP_TIMING
+
+    // Write the frame data.
+    Status = PCAP_send(InstancePtr, WriteBuffer, Index, NULL);
+    if (Status != XST_SUCCESS)
+    {
+        return XST_FAILURE;
+    }
+
+#ifdef PCAP_TIMING
+    XTime_GetTime(&transfer); // Get time count
+    printf("Write tail elapsed time:          %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
+    printf("PCAP Bandwidth:                   %12.3f MB/s\n", ((float)Index*4)/((float)(transfer-time)*1000000/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)));
+#endif // #ifdef PCAP_TIMING
+
+    // Check that the device has received the same CRC
+    if (PCAP_check_crc(InstancePtr) != XST_SUCCESS)
+    {
+        return XST_FAILURE;
+    }
+
+#ifdef PCAP_TIMING
+    XTime_GetTime(&time); // Get time count
+    printf("PCAP_DeviceWritePBS elapsed time: %12.3f us (%10.0f cycles @ %7.3f MHz)\n", ((float)time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)time, (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
+#endif // #ifdef PCAP_TIMING
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Erases the BRAM contents of a region using PCAP interface
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param x0, y0, xf, yf are the coordinates of the region (y in clock region rows)
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_BRAM_erase(XDcfg *InstancePtr, u32 x0, u32 y0, u32 xf, u32 yf)
+{
+    return PCAP_write_BRAM(InstancePtr, NULL, x0, y0, xf, yf);
+}
+
+/****************************************************************************/
+/**
+*
+* Writes the BRAM contents of a region using PCAP interface
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param addr_start is a pointer to the first BRAM content frame to be written
+* @param addr_end is the value of the last memory position of the frames
+* @param x0, y0, xf, yf are the coordinates of the region (y in clock region rows)
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_RAM_write_BRAM(XDcfg *InstancePtr, u32 *addr_start, u32 addr_end, u32 x0, u32 y0, u32 xf, u32 yf)
+{
+    Xil_AssertNonvoid(addr_start != NULL);
+
+    if (addr_end - (u32) addr_start != PCAP_BRAM_content_frames(x0, y0, xf, yf) * NUM_FRAME_BYTES)
+    {
+        return XST_FAILURE;
+    }
+    return PCAP_write_BRAM(InstancePtr, addr_start, x0, y0, xf, yf);
+}
+
+/*
+* Common part of PCAP_BRAM_erase() and PCAP_RAM_write_BRAM(): the BRAM content
+* frames of the region are written with zeros if image is NULL
+*/
+static int PCAP_write_BRAM(XDcfg *InstancePtr, u32 *image, u32 x0, u32 y0, u32 xf, u32 yf)
+{
+    u32 Index = 0;
+    int Status;
+    u32 WriteBuffer[16];
+    PCAP_crc_t crc = {0, 0, 0};
+
+    Xil_AssertNonvoid(InstancePtr != NULL);
+    Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
+
+    // Change PCAP clock configuration
+    PCAP_set_clock(PCAP_clk_ctrl_write);
+
+    // Bus Width, DUMMY and SYNC
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_BW_SYNC;
+    WriteBuffer[Index++] = PCAP_BW_DETECT;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_SYNC_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+    // Reset CRC
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+    WriteBuffer[Index++] = PCAP_CMD_RCRC;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+    // ID register
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_IDCODE) | 1;
+    WriteBuffer[Index++] = PCAP_IDCODE_NUMBER;
+
+    Status = PCAP_send(InstancePtr, WriteBuffer, Index, &crc);
+    if (Status == XST_SUCCESS)
+    {
+        Status = PCAP_write_BRAM_frames(InstancePtr, image != NULL ? &image : NULL, x0, y0, xf, yf, &crc);
+    }
+
+    // Add CRC and DESYNC (it is also sent after an error so that the PCAP is left idle)
+    Index = PCAP_crc_tail(WriteBuffer, 0, &crc);
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+    WriteBuffer[Index++] = PCAP_CMD_DESYNCH;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    if (PCAP_send(InstancePtr, WriteBuffer, Index, NULL) != XST_SUCCESS || PCAP_check_crc(InstancePtr) != XST_SUCCESS)
+    {
+        Status = XST_FAILURE;
+    }
+
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+    return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Writes the BRAM content frames of a region. The BRAM columns of a clock
+* region row whose frame addresses are consecutive are written with one FDRI
+* packet. If image is NULL the contents are erased and the data is sent by
+* repeating the same static block of zero frames. The configuration must be
+* synchronized.
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param image points to the first frame to be written (in the order of
+* PCAP_RAM_read_BRAM()) and returns the frame after the last one written, or
+* NULL to erase the contents
+* @param x0, y0, xf, yf are the coordinates of the region (y in clock region rows)
+* @param crc is the CRC of the packets sent since the last RCRC
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+static int PCAP_write_BRAM_frames(XDcfg *InstancePtr, u32 **image, u32 x0, u32 y0, u32 xf, u32 yf, PCAP_crc_t *crc)
+{
+    u32 Index;
+    u32 WriteBuffer[16];
+    u32 TotalWords, BlockWords;
+    u32 first_column, num_columns, major;
+    u32 x, y;
+    int Status;
+
+    // Repeat for each clock region
+    for (y = y0; y <= yf; y++)
+    {
+        x = x0;
+        while (x <= xf)
+        {
+            // Check if the column is a BRAM column
+            if (((fpga_bram[y][x] & 0xFFFF0000)>>16) != BRAM_CONTENT)
+            {
+                x++;
+                continue;
+            }
+
+            // The BRAM columns whose frames follow this one are written in the same packet
+            first_column = x;
+            major = fpga_bram[y][x] & 0xFFFF;
+            x = BRAM_column_group(y, x, xf, &num_columns);
+
+            Index = 0;
+            // Setup CMD register - write configuration
+            WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+            WriteBuffer[Index++] = PCAP_CMD_WCFG;
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+            // Setup FAR
+            WriteBuffer[Index++] = PCAP_Type1Write(PCAP_FAR) | 1;
+            WriteBuffer[Index++] = PCAP_SetupFar7S((fpga[y][first_column][0] & (0xFF << 24))>>24, PCAP_FAR_BRAM_BLOCK, (fpga[y][first_column][0] & (0xFF << 16))>>16, major, 0);
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+            // Setup Packet header. We add a padding frame so that the last frame is written
+            TotalWords = (num_columns * BRAM_CONTENT_FRAMES + 1) * NUM_FRAME_WORDS;
+            if (TotalWords < PCAP_TYPE_1_PACKET_MAX_WORDS)
+            {
+                // Create Type 1 Packet
+                WriteBuffer[Index++] = PCAP_Type1Write(PCAP_FDRI) | TotalWords;
+            }
+            else
+            {
+                // Create Type 2 Packet
+                WriteBuffer[Index++] = PCAP_Type1Write(PCAP_FDRI);
+                WriteBuffer[Index++] = PCAP_TYPE_2_WRITE | TotalWords;
+            }
+
+            Status = PCAP_send(InstancePtr, WriteBuffer, Index, crc);
+            if (Status != XST_SUCCESS)
+            {
+                return XST_FAILURE;
+            }
+
+            if (image != NULL)
+            {
+                // Only the padding frame is taken from the zero block
+                Status = PCAP_send(InstancePtr, *image, TotalWords - NUM_FRAME_WORDS, crc);
+                if (Status != XST_SUCCESS)
+                {
+                    return XST_FAILURE;
+                }
+                *image += TotalWords - NUM_FRAME_WORDS;
+                TotalWords = NUM_FRAME_WORDS;
+            }
+
+            // Write the frame data.
+            while (TotalWords > 0)
+            {
+                BlockWords = TotalWords < BRAM_ERASE_BLOCK_FRAMES * NUM_FRAME_WORDS ? TotalWords : BRAM_ERASE_BLOCK_FRAMES * NUM_FRAME_WORDS;
+                Status = PCAP_send(InstancePtr, BRAM_zero_frames, BlockWords, crc);
+                if (Status != XST_SUCCESS)
+                {
+                    return XST_FAILURE;
+                }
+                TotalWords -= BlockWords;
+            }
+        }
+    }
+
+    return XST_SUCCESS;
+}
+
+/*
+* Counts the BRAM columns from the BRAM column x whose frame addresses follow
+* the frames of x in the clock region row y. Returns the column after the last
+* one counted.
+*/
+static u32 BRAM_column_group(u32 y, u32 x, u32 xf, u32 *num_columns)
+{
+    u32 major = fpga_bram[y][x] & 0xFFFF;
+
+    *num_columns = 1;
+    for (x++; x <= xf; x++)
+    {
+        if (((fpga_bram[y][x] & 0xFFFF0000)>>16) != BRAM_CONTENT)
+        {
+            continue;
+        }
+        if ((fpga_bram[y][x] & 0xFFFF) != major + *num_columns)
+        {
+            break;
+        }
+        (*num_columns)++;
+    }
+    return x;
+}
+
+/****************************************************************************/
+/**
+*
+* Returns the number of BRAM content frames of a region, i.e. the size of the
+* frames read by PCAP_RAM_read_BRAM()
+*
+* @param x0, y0, xf, yf are the coordinates of the region (y in clock region rows)
+*
+* @return   number of frames
+*
+*****************************************************************************/
+u32 PCAP_BRAM_content_frames(u32 x0, u32 y0, u32 xf, u32 yf)
+{
+    u32 frames = 0;
+    u32 x, y;
+
+    for (y = y0; y <= yf; y++)
+    {
+        for (x = x0; x <= xf; x++)
+        {
+            if (((fpga_bram[y][x] & 0xFFFF0000)>>16) == BRAM_CONTENT)
+            {
+                frames += BRAM_CONTENT_FRAMES;
+            }
+        }
+    }
+    return frames;
+}
+
+/****************************************************************************/
+/**
+*
+* Reads the BRAM contents of a region using PCAP interface. For each clock
+* region row the BRAM content frames of its BRAM columns are stored one after
+* the other, and the columns whose frame addresses are consecutive are read
+* with one FDRO packet.
+*
+* NOTE the BRAMs must not be accessed by the design while they are read back.
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param addr_start is a pointer to the memory address that will store the
+* frames read (aligned to a cache line). It returns the address after the last
+* frame. One pad frame more is written above the frames.
+* @param x0, y0, xf, yf are the coordinates of the region (y in clock region rows)
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_RAM_read_BRAM(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf, u32 yf)
+{
+    u32 WriteBuffer[32];
+    u32 Index;
+    u32 TotalWords;
+    u32 first_column, num_columns, major;
+    u32 x, y;
+    int Status = XST_SUCCESS;
+
+    Xil_AssertNonvoid(InstancePtr != NULL);
+    Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+    Xil_AssertNonvoid(*addr_start != NULL);
+
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
+
+    // Change PCAP clock configuration
+    PCAP_set_clock(PCAP_clk_ctrl_read);
+
+    for (y = y0; y <= yf && Status == XST_SUCCESS; y++)
+    {
+        x = x0;
+        while (x <= xf && Status == XST_SUCCESS)
+        {
+            if (((fpga_bram[y][x] & 0xFFFF0000)>>16) != BRAM_CONTENT)
+            {
+                x++;
+                continue;
+            }
+            first_column = x;
+            major = fpga_bram[y][x] & 0xFFFF;
+            x = BRAM_column_group(y, x, xf, &num_columns);
+
+            Index = 0;
+            // Bus Width, DUMMY and SYNC
+            WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+            WriteBuffer[Index++] = PCAP_BW_SYNC;
+            WriteBuffer[Index++] = PCAP_BW_DETECT;
+            WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+            WriteBuffer[Index++] = PCAP_SYNC_PACKET;
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+            // Reset CRC
+            WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+            WriteBuffer[Index++] = PCAP_CMD_RCRC;
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+            // Read configuration from the first BRAM content frame of the group
+            WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+            WriteBuffer[Index++] = PCAP_CMD_RCFG;
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+            WriteBuffer[Index++] = PCAP_Type1Write(PCAP_FAR) | 1;
+            WriteBuffer[Index++] = PCAP_SetupFar7S((fpga[y][first_column][0] & (0xFF << 24))>>24, PCAP_FAR_BRAM_BLOCK, (fpga[y][first_column][0] & (0xFF << 16))>>16, major, 0);
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+            // The NULL frame is also read
+            TotalWords = (num_columns * BRAM_CONTENT_FRAMES + 1) * NUM_FRAME_WORDS;
+            if (TotalWords < PCAP_TYPE_1_PACKET_MAX_WORDS)
+            {
+                WriteBuffer[Index++] = PCAP_Type1Read(PCAP_FDRO) | TotalWords;
+            }
+            else
+            {
+                WriteBuffer[Index++] = PCAP_Type1Read(PCAP_FDRO);
+                WriteBuffer[Index++] = PCAP_TYPE_2_READ | TotalWords;
+            }
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+            WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+            // Send the packets (and the DESYNC) and read the frames
+            Status = PCAP_receive(InstancePtr, WriteBuffer, Index, *addr_start, TotalWords);
+            if (Status == XST_SUCCESS)
+            {
+                // Erase NULL frame
+                memmove(*addr_start, *addr_start + NUM_FRAME_WORDS, (TotalWords - NUM_FRAME_WORDS) * BYTES_PER_WORD_OF_FRAME);
+                *addr_start += TotalWords - NUM_FRAME_WORDS;
+            }
+        }
+    }
+
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+    return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Sends a command to the CMD register of the configuration, e.g. GCAPTURE
+* (the values of the flip-flops are copied to their INIT bits in the
+* configuration frames) or GRESTORE (the flip-flops are set to their INIT bits)
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param command is the value of the CMD register (PCAP_CMD_GCAPTURE or
+* PCAP_CMD_GRESTORE)
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_send_command(XDcfg *InstancePtr, u32 command)
+{
+    u32 Index = 0;
+    int Status;
+    u32 WriteBuffer[16];
+
+    Xil_AssertNonvoid(InstancePtr != NULL);
+    Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
+
+    // Change PCAP clock configuration
+    PCAP_set_clock(PCAP_clk_ctrl_write);
+
+    // Bus Width, DUMMY and SYNC
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_BW_SYNC;
+    WriteBuffer[Index++] = PCAP_BW_DETECT;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_SYNC_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+    // Command
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+    WriteBuffer[Index++] = command;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+    // DESYNC
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+    WriteBuffer[Index++] = PCAP_CMD_DESYNCH;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+
+    Status = PCAP_send(InstancePtr, WriteBuffer, Index, NULL);
+
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+    return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Writes some consecutive frames of one column using PCAP interface. The pad
+* frame that pushes the last frame out of the frame buffer is taken from the
+* zero block of the BRAM erase, so only num_frames frames are read from RAM.
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param addr_start is a pointer to the first frame to be written
+* @param x, y are the column and the clock region row
+* @param first_frame is the minor address of the first frame in the column
+* @param num_frames is the number of frames
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_RAM_write_column_frames(XDcfg *InstancePtr, u32 *addr_start, u32 x, u32 y, u32 first_frame, u32 num_frames)
+{
+    u32 Index = 0;
+    int Status;
+    u32 WriteBuffer[24];
+    u32 TotalWords;
+    PCAP_crc_t crc = {0, 0, 0};
 
-        // Write header data.
-        Xil_DCacheFlushRange(WriteBuffer, Index*4);
-        Status = XDcfg_Transfer(InstancePtr, WriteBuffer, Index, (u8*) XDCFG_DMA_INVALID_ADDRESS, 0, XDCFG_NON_SECURE_PCAP_WRITE);
-        if (Status != XST_SUCCESS)
-        {
-            return XST_FAILURE;
-        }
-        // Poll IXR_DMA_DONE
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-        while ((IntrStsReg & XDCFG_IXR_DMA_DONE_MASK) != XDCFG_IXR_DMA_DONE_MASK)
-        {
-            IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-        }
-        // Poll IXR_D_P_DONE
-        while ((IntrStsReg & XDCFG_IXR_D_P_DONE_MASK) != XDCFG_IXR_D_P_DONE_MASK)
-        {
-            IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-        }
+    Xil_AssertNonvoid(InstancePtr != NULL);
+    Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+    Xil_AssertNonvoid(addr_start != NULL);
 
-#ifdef PCAP_TIMING
-        XTime_GetTime(&transfer); // Get time count
-        printf("Write header elapsed time:        %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-        printf("PCAP Bandwidth:                   %12.3f MB/s\n", ((float)Index*4)/((float)(transfer-time)*1000000/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)));
-#endif // #ifdef PCAP_TIMING
+    if (num_frames == 0 || first_frame + num_frames > (fpga[y][x][0] & 0xFFFF))
+    {
+        return XST_FAILURE;
+    }
 
-        // Clear the interrupt status bits
-        XDcfg_IntrClear(InstancePtr, (XDCFG_IXR_PCFG_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK | XDCFG_IXR_DMA_DONE_MASK));
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
 
-#ifdef PCAP_TIMING
-        XTime_GetTime(&time); // Get time count
-#endif // #ifdef PCAP_TIMING
+    // Change PCAP clock configuration
+    PCAP_set_clock(PCAP_clk_ctrl_write);
 
-        // Write the frame data.
-        Xil_DCacheFlushRange(addr_send, TotalWords*4);
-        Status = XDcfg_Transfer(InstancePtr, addr_send, TotalWords, (u8*) XDCFG_DMA_INVALID_ADDRESS, 0, XDCFG_NON_SECURE_PCAP_WRITE);
-        if (Status != XST_SUCCESS)
+    // Bus Width, DUMMY and SYNC
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_BW_SYNC;
+    WriteBuffer[Index++] = PCAP_BW_DETECT;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_SYNC_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+    // Reset CRC
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+    WriteBuffer[Index++] = PCAP_CMD_RCRC;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+    // ID register
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_IDCODE) | 1;
+    WriteBuffer[Index++] = PCAP_IDCODE_NUMBER;
+
+    // Write configuration from the first frame
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+    WriteBuffer[Index++] = PCAP_CMD_WCFG;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_FAR) | 1;
+    WriteBuffer[Index++] = PCAP_SetupFar7S((fpga[y][x][0] & (0xFF << 24))>>24, PCAP_FAR_CLB_BLOCK, (fpga[y][x][0] & (0xFF << 16))>>16, x, first_frame);
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+
+    TotalWords = (num_frames + 1) * NUM_FRAME_WORDS;
+    if (TotalWords < PCAP_TYPE_1_PACKET_MAX_WORDS)
+    {
+        WriteBuffer[Index++] = PCAP_Type1Write(PCAP_FDRI) | TotalWords;
+    }
+    else
+    {
+        WriteBuffer[Index++] = PCAP_Type1Write(PCAP_FDRI);
+        WriteBuffer[Index++] = PCAP_TYPE_2_WRITE | TotalWords;
+    }
+
+    Status = PCAP_send(InstancePtr, WriteBuffer, Index, &crc);
+    if (Status == XST_SUCCESS)
+    {
+        Status = PCAP_send(InstancePtr, addr_start, num_frames * NUM_FRAME_WORDS, &crc);
+    }
+    if (Status == XST_SUCCESS)
+    {
+        Status = PCAP_send(InstancePtr, BRAM_zero_frames, NUM_FRAME_WORDS, &crc);
+    }
+
+    // Add CRC and DESYNC (it is also sent after an error so that the PCAP is left idle)
+    Index = PCAP_crc_tail(WriteBuffer, 0, &crc);
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+    WriteBuffer[Index++] = PCAP_CMD_DESYNCH;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    if (PCAP_send(InstancePtr, WriteBuffer, Index, NULL) != XST_SUCCESS || PCAP_check_crc(InstancePtr) != XST_SUCCESS)
+    {
+        Status = XST_FAILURE;
+    }
+
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+    return Status;
+}
+
+/****************************************************************************/
+/**
+*
+* Sends words from the RAM to the configuration port and waits until they have
+* been written. The interface of the port is selected if it is not the actual
+* one. The CRC of the words is computed while the DMA sends them.
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param addr is the first word to send
+* @param TotalWords is the number of words to send
+* @param crc is the CRC of the packets sent before (NULL if it is not needed)
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+static int PCAP_send(XDcfg *InstancePtr, u32 *addr, u32 TotalWords, PCAP_crc_t *crc)
+{
+    int Status;
+
+    // The HWICAP writes the ICAPE2
+    CAP_select_interface(InstancePtr, CAP_transport == CAP_TRANSPORT_HWICAP ? CAP_INTERFACE_ICAP : CAP_INTERFACE_PCAP);
+
+#ifdef XPAR_HWICAP_0_DEVICE_ID
+    if (CAP_transport == CAP_TRANSPORT_HWICAP)
+    {
+        // The processor fills the FIFO of the HWICAP, so nothing can overlap the write
+        if (crc != NULL)
         {
-            return XST_FAILURE;
+            PCAP_crc_update(crc, addr, TotalWords);
         }
-        // Poll IXR_DMA_DONE
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-        while ((IntrStsReg & XDCFG_IXR_DMA_DONE_MASK) != XDCFG_IXR_DMA_DONE_MASK)
+        Status = XHwIcap_DeviceWrite(&HWICAP_component, addr, TotalWords);
+        return Status == XST_SUCCESS ? XST_SUCCESS : XST_FAILURE;
+    }
+#endif
+
+    Xil_DCacheFlushRange(addr, TotalWords*4);
+    Status = XDcfg_Transfer(InstancePtr, addr, TotalWords, (u8*) XDCFG_DMA_INVALID_ADDRESS, 0, XDCFG_NON_SECURE_PCAP_WRITE);
+    if (Status != XST_SUCCESS)
+    {
+        return XST_FAILURE;
+    }
+    if (crc != NULL)
+    {
+        PCAP_crc_update(crc, addr, TotalWords);
+    }
+    // Poll IXR_DMA_DONE and IXR_D_P_DONE
+    PCAP_wait_transfer(InstancePtr);
+
+    // Clear the interrupt status bits
+    XDcfg_IntrClear(InstancePtr, (XDCFG_IXR_PCFG_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK | XDCFG_IXR_DMA_DONE_MASK));
+
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Sends the packets of a read and receives the words read from the
+* configuration port. The DESYNC is added to the packets: the PCAP receives it
+* before the DMA reads the words and the HWICAP after them, because the
+* processor cannot send it until the read FIFO has been emptied.
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param WriteBuffer is the buffer of the packets. It must have 4 free words.
+* @param Index is the number of words of the packets
+* @param addr is the first word of the RAM that receives the words read
+* @param TotalWords is the number of words to read
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+static int PCAP_receive(XDcfg *InstancePtr, u32 *WriteBuffer, u32 Index, u32 *addr, u32 TotalWords)
+{
+    u32 Desync[4] = {PCAP_Type1Write(PCAP_CMD) | 1, PCAP_CMD_DESYNCH, PCAP_DUMMY_PACKET, PCAP_DUMMY_PACKET};
+    int Status;
+
+#ifdef XPAR_HWICAP_0_DEVICE_ID
+    if (CAP_transport == CAP_TRANSPORT_HWICAP)
+    {
+        Status = PCAP_send(InstancePtr, WriteBuffer, Index, NULL);
+        if (Status == XST_SUCCESS)
         {
-            IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
+            Status = XHwIcap_DeviceRead(&HWICAP_component, addr, TotalWords);
         }
-        // Poll IXR_D_P_DONE
-        while ((IntrStsReg & XDCFG_IXR_D_P_DONE_MASK) != XDCFG_IXR_D_P_DONE_MASK)
+        // It is also sent after an error so that the ICAP is left idle
+        if (PCAP_send(InstancePtr, Desync, 4, NULL) != XST_SUCCESS)
         {
-            IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
+            Status = XST_FAILURE;
         }
+        return Status == XST_SUCCESS ? XST_SUCCESS : XST_FAILURE;
+    }
+#endif
 
-#ifdef PCAP_TIMING
-        XTime_GetTime(&transfer); // Get time count
-        printf("Write frame data elapsed time:    %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-        printf("PCAP Bandwidth:                   %12.3f MB/s\n", ((float)TotalWords*4)/((float)(transfer-time)*1000000/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)));
-#endif // #ifdef PCAP_TIMING
+    memcpy(WriteBuffer + Index, Desync, sizeof(Desync));
+    Status = PCAP_send(InstancePtr, WriteBuffer, Index + 4, NULL);
+    if (Status != XST_SUCCESS)
+    {
+        return XST_FAILURE;
+    }
+
+    Status = XDcfg_Transfer(InstancePtr, (u32*) XDCFG_DMA_INVALID_ADDRESS, TotalWords, addr, TotalWords, XDCFG_NON_SECURE_PCAP_WRITE);
+    Xil_DCacheInvalidateRange(addr, TotalWords*4);
+    if (Status != XST_SUCCESS)
+    {
+        return XST_FAILURE;
+    }
+    // Poll IXR_DMA_DONE and IXR_D_P_DONE
+    PCAP_wait_transfer(InstancePtr);
 
-        // Clear the interrupt status bits
-        XDcfg_IntrClear(InstancePtr, (XDCFG_IXR_PCFG_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK | XDCFG_IXR_DMA_DONE_MASK));
+    // Clear the interrupt status bits
+    XDcfg_IntrClear(InstancePtr, (XDCFG_IXR_PCFG_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK | XDCFG_IXR_DMA_DONE_MASK));
 
-        // Reset command buffer index
-        Index = 0;
+    return XST_SUCCESS;
+}
 
-        // Increment initial address
-        addr_send = (u32*) ((u32) addr_send + (TotalWords  * BYTES_PER_WORD_OF_FRAME));
+/****************************************************************************/
+/**
+*
+* Fills the tables of the configuration CRC. The 7-series devices compute a
+* CRC-32C of the 37 bits of each register write (32 data bits and 5 address
+* bits, from the LSB). ARMv7 has no CRC instructions, so the data words are
+* processed with 4 tables of 256 entries and the address with a table of 32.
+*
+* @return   none
+*
+*****************************************************************************/
+static void PCAP_init_crc_tables()
+{
+    u32 crc;
+    int i, bit;
 
-        // Security check. We add a padding frame to the addr end
-        if((u32)addr_send > (addr_end + NUM_FRAME_WORDS*BYTES_PER_WORD_OF_FRAME))
+    for (i = 0; i < 256; i++)
+    {
+        crc = i;
+        for (bit = 0; bit < 8; bit++)
         {
-        	return XST_FAILURE;
+            crc = (crc & 1) ? (crc >> 1) ^ PCAP_CRC_POLYNOMIAL : crc >> 1;
+        }
+        PCAP_crc_table[0][i] = crc;
+    }
+    for (i = 0; i < 256; i++)
+    {
+        PCAP_crc_table[1][i] = (PCAP_crc_table[0][i] >> 8) ^ PCAP_crc_table[0][PCAP_crc_table[0][i] & 0xFF];
+        PCAP_crc_table[2][i] = (PCAP_crc_table[1][i] >> 8) ^ PCAP_crc_table[0][PCAP_crc_table[1][i] & 0xFF];
+        PCAP_crc_table[3][i] = (PCAP_crc_table[2][i] >> 8) ^ PCAP_crc_table[0][PCAP_crc_table[2][i] & 0xFF];
+    }
+    for (i = 0; i < 32; i++)
+    {
+        crc = i;
+        for (bit = 0; bit < 5; bit++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ PCAP_CRC_POLYNOMIAL : crc >> 1;
         }
+        PCAP_crc_address_table[i] = crc;
     }
+}
 
-    // Erase BRAM contents if required
-    if (erase_bram == PCAP_BRAM_ERASE) {
-        u32 null_frame[128*NUM_FRAME_WORDS];
-        for (Index = 0; Index < 128; Index++) null_frame[Index] = 0;
-        Index = 0;
-        // Repeat for each clock region
-        for (y = y0; y <= yf; y++)
+/****************************************************************************/
+/**
+*
+* Adds to the CRC the register writes of some words sent to the PCAP. The
+* packet headers are decoded to know the register of the data words, so the
+* data of a packet can be sent in several transfers. The writes to the CRC
+* register are not included and the RCRC command resets the CRC.
+*
+* @param crc is the CRC of the words sent before
+* @param addr is the first word sent
+* @param TotalWords is the number of words
+*
+* @return   none
+*
+*****************************************************************************/
+static void PCAP_crc_update(PCAP_crc_t *crc, const u32 *addr, u32 TotalWords)
+{
+#if PCAP_CRC_MODE == PCAP_CRC_COMPUTED
+    u32 value = crc->crc;
+    u32 word;
+    u32 i;
+
+    for (i = 0; i < TotalWords; i++)
+    {
+        word = addr[i];
+        if (crc->data_words > 0)
         {
-            // Repeat for each column
-            for (x = x0; x <= xf; x++)
+            crc->data_words--;
+            if (crc->reg == PCAP_CRC)
             {
-                // Check if the column is a BRAM column
-                if (((fpga_bram[y][x] & 0xFFFF0000)>>16) == BRAM_CONTENT) {
-                    // Setup CMD register - write configuration
-                    Packet = PCAP_Type1Write(PCAP_CMD) | 1;
-                    Data = PCAP_CMD_WCFG;
-                    WriteBuffer[Index++] = Packet;
-                    WriteBuffer[Index++] = Data;
-                    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
-
-                    // Setup FAR
-                    Packet = PCAP_Type1Write(PCAP_FAR) | 1;
-                    Data = PCAP_SetupFar7S((fpga[y][x][0] & (0xFF << 24))>>24, PCAP_FAR_BRAM_BLOCK, (fpga[y][x][0] & (0xFF << 16))>>16, fpga_bram[y][x] & 0xFFFF, 0);
-                    WriteBuffer[Index++] = Packet;
-                    WriteBuffer[Index++] = Data;
-                    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
-
-                    // Setup Packet header
-                    TotalWords = 128 * NUM_FRAME_WORDS;
-                    if (TotalWords < PCAP_TYPE_1_PACKET_MAX_WORDS)
-                    {
-                        // Create Type 1 Packet
-                        Packet = PCAP_Type1Write(PCAP_FDRI) | TotalWords;
-                        WriteBuffer[Index++] = Packet;
-                    }
-                    else
-                    {
-                        // Create Type 2 Packet
-                        Packet = PCAP_Type1Write(PCAP_FDRI);
-                        WriteBuffer[Index++] = Packet;
-
-                        Packet = PCAP_TYPE_2_WRITE | TotalWords;
-                        WriteBuffer[Index++] = Packet;
-                    }
-
-                    // Write header data.
-                    Xil_DCacheFlushRange(WriteBuffer, Index*4);
-                    Status = XDcfg_Transfer(InstancePtr, WriteBuffer, Index, (u8*) XDCFG_DMA_INVALID_ADDRESS, 0, XDCFG_NON_SECURE_PCAP_WRITE);
-                    if (Status != XST_SUCCESS)
-                    {
-                        return XST_FAILURE;
-                    }
-                    // Poll IXR_DMA_DONE
-                    IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-                    while ((IntrStsReg & XDCFG_IXR_DMA_DONE_MASK) != XDCFG_IXR_DMA_DONE_MASK)
-                    {
-                        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-                    }
-                    // Poll IXR_D_P_DONE
-                    while ((IntrStsReg & XDCFG_IXR_D_P_DONE_MASK) != XDCFG_IXR_D_P_DONE_MASK)
-                    {
-                        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-                    }
-
-                    // Clear the interrupt status bits
-                    XDcfg_IntrClear(InstancePtr, (XDCFG_IXR_PCFG_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK | XDCFG_IXR_DMA_DONE_MASK));
-
-                    // Write the frame data.
-                    Xil_DCacheFlushRange(null_frame, TotalWords*4);
-                    Status = XDcfg_Transfer(InstancePtr, null_frame, TotalWords, (u8*) XDCFG_DMA_INVALID_ADDRESS, 0, XDCFG_NON_SECURE_PCAP_WRITE);
-                    if (Status != XST_SUCCESS)
-                    {
-                        return XST_FAILURE;
-                    }
-                    // Poll IXR_DMA_DONE
-                    IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-                    while ((IntrStsReg & XDCFG_IXR_DMA_DONE_MASK) != XDCFG_IXR_DMA_DONE_MASK)
-                    {
-                        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-                    }
-                    // Poll IXR_D_P_DONE
-                    while ((IntrStsReg & XDCFG_IXR_D_P_DONE_MASK) != XDCFG_IXR_D_P_DONE_MASK)
-                    {
-                        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-                    }
-
-                    // Clear the interrupt status bits
-                    XDcfg_IntrClear(InstancePtr, (XDCFG_IXR_PCFG_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK | XDCFG_IXR_DMA_DONE_MASK));
-
-                    // Reset command buffer index
-                    Index = 0;
-                }
+                continue;
+            }
+            value ^= word;
+            value = PCAP_crc_table[3][value & 0xFF] ^ PCAP_crc_table[2][(value >> 8) & 0xFF]
+                  ^ PCAP_crc_table[1][(value >> 16) & 0xFF] ^ PCAP_crc_table[0][value >> 24];
+            value = (value >> 5) ^ PCAP_crc_address_table[(value ^ crc->reg) & 0x1F];
+            if (crc->reg == PCAP_CMD && word == PCAP_CMD_RCRC)
+            {
+                value = 0;
             }
         }
+        else if ((word >> PCAP_TYPE_SHIFT) == PCAP_TYPE_1)
+        {
+            crc->reg = (word >> PCAP_REGISTER_SHIFT) & PCAP_REGISTER_MASK;
+            crc->data_words = ((word >> PCAP_OP_SHIFT) & PCAP_OP_MASK) == PCAP_OP_WRITE ? word & PCAP_WORD_COUNT_MASK_TYPE_1 : 0;
+        }
+        else if ((word >> PCAP_TYPE_SHIFT) == PCAP_TYPE_2)
+        {
+            // It continues the register of the previous Type 1 packet
+            crc->data_words = ((word >> PCAP_OP_SHIFT) & PCAP_OP_MASK) == PCAP_OP_WRITE ? word & PCAP_WORD_COUNT_MASK_TYPE_2 : 0;
+        }
     }
+    crc->crc = value;
+#endif
+}
 
-    // Add CRC
-    Packet = PCAP_Type1Write(PCAP_CMD) | 1;
-    Data = PCAP_CMD_RCRC;
-    WriteBuffer[Index++] = Packet;
-    WriteBuffer[Index++] = Data;
+/****************************************************************************/
+/**
+*
+* Adds the CRC check at the end of a write (see PCAP_CRC_MODE)
+*
+* @param WriteBuffer is the buffer of the tail
+* @param Index is the first free position of the buffer
+* @param crc is the CRC of the packets sent since the last RCRC
+*
+* @return   first free position of the buffer
+*
+*****************************************************************************/
+static u32 PCAP_crc_tail(u32 *WriteBuffer, u32 Index, PCAP_crc_t *crc)
+{
+#if PCAP_CRC_MODE == PCAP_CRC_COMPUTED
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CRC) | 1;
+    WriteBuffer[Index++] = crc->crc;
+#elif PCAP_CRC_MODE == PCAP_CRC_DISABLED
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CRC) | 1;
+    WriteBuffer[Index++] = PCAP_DISABLED_AUTO_CRC;
+#else
+    WriteBuffer[Index++] = PCAP_Type1Write(PCAP_CMD) | 1;
+    WriteBuffer[Index++] = PCAP_CMD_RCRC;
+#endif
     WriteBuffer[Index++] = PCAP_NOOP_PACKET;
     WriteBuffer[Index++] = PCAP_NOOP_PACKET;
 
-    // DESYNC
-    Packet = (PCAP_Type1Write(PCAP_CMD) | 1);
-    Data = PCAP_CMD_DESYNCH;
-    WriteBuffer[Index++] = Packet;
-    WriteBuffer[Index++] = Data;
+    return Index;
+}
+
+/****************************************************************************/
+/**
+*
+* Reads the STAT register of the configuration to know if the device has
+* found a CRC error in the last write. The configuration must be desynchronized.
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+*
+* @return   XST_SUCCESS else XST_FAILURE if the CRC was not equal or the
+* register cannot be read.
+*
+*****************************************************************************/
+static int PCAP_check_crc(XDcfg *InstancePtr)
+{
+#if PCAP_CRC_MODE == PCAP_CRC_COMPUTED
+    static u32 StatReg[8] __attribute__ ((aligned (32))); // One cache line, written by the DMA
+    u32 WriteBuffer[16];
+    u32 Index = 0;
+    int Status;
+
+    // Bus Width, DUMMY and SYNC
     WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_BW_SYNC;
+    WriteBuffer[Index++] = PCAP_BW_DETECT;
     WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
+    WriteBuffer[Index++] = PCAP_SYNC_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
 
-#ifdef PCAP_TIMING
-    XTime_GetTime(&time); // Get time count
-#endif // #ifdef PCAP_TIMING
+    // Read STAT (the DESYNC is added by PCAP_receive())
+    WriteBuffer[Index++] = PCAP_Type1Read(PCAP_STAT) | 1;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
+    WriteBuffer[Index++] = PCAP_NOOP_PACKET;
 
-    // Write the frame data.
-    Xil_DCacheFlushRange(WriteBuffer, Index*4);
-    Status = XDcfg_Transfer(InstancePtr, WriteBuffer, Index, (u8*) XDCFG_DMA_INVALID_ADDRESS, 0, XDCFG_NON_SECURE_PCAP_WRITE);
+    Status = PCAP_receive(InstancePtr, WriteBuffer, Index, StatReg, 1);
     if (Status != XST_SUCCESS)
     {
         return XST_FAILURE;
     }
-    // Poll IXR_DMA_DONE
-    IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-    while ((IntrStsReg & XDCFG_IXR_DMA_DONE_MASK) != XDCFG_IXR_DMA_DONE_MASK)
-    {
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-    }
-    // Poll IXR_D_P_DONE
-    while ((IntrStsReg & XDCFG_IXR_D_P_DONE_MASK) != XDCFG_IXR_D_P_DONE_MASK)
-    {
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-    }
-
-#ifdef PCAP_TIMING
-    XTime_GetTime(&transfer); // Get time count
-    printf("Write tail elapsed time:          %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-    printf("PCAP Bandwidth:                   %12.3f MB/s\n", ((float)Index*4)/((float)(transfer-time)*1000000/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)));
-#endif // #ifdef PCAP_TIMING
-
-    // Clear the interrupt status bits
-    XDcfg_IntrClear(InstancePtr, (XDCFG_IXR_PCFG_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK | XDCFG_IXR_DMA_DONE_MASK));
-
-#ifdef PCAP_TIMING
-    XTime_GetTime(&time); // Get time count
-    printf("PCAP_DeviceWritePBS elapsed time: %12.3f us (%10.0f cycles @ %7.3f MHz)\n", ((float)time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)time, (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-#endif // #ifdef PCAP_TIMING
 
+    return (StatReg[0] & PCAP_STAT_CRC_ERROR_MASK) ? XST_FAILURE : XST_SUCCESS;
+#else
     return XST_SUCCESS;
+#endif
 }
 
 /****************************************************************************/
@@ -626,20 +2222,56 @@ int PCAP_RAM_write(XDcfg *InstancePtr, u32 *addr_start, u32 addr_end, u32 x0, u3
 *
 * @param InstancePtr is a pointer to the PCAP instance.
 * @param addr_ini is a pointer to the memory addres that will store data read from the device
-* @param TotalWords is total amount of words that the PCAP has to read
-* @param x0, y0, xf, yf are the coordinates of the region to be reconfigured
+* @param TotalWords is total amount of words that the PCAP has to read
+* @param x0, y0, xf, yf are the coordinates of the region to be reconfigured
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_RAM_read(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf, u32 yf)
+{
+    return CAP_RAM_read(InstancePtr, CAP_TRANSPORT_PCAP, addr_start, x0, y0, xf, yf);
+}
+
+/****************************************************************************/
+/**
+*
+* Reads PBS file like PCAP_RAM_read() through the selected configuration port
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param transport is the configuration port (CAP_TRANSPORT_PCAP or CAP_TRANSPORT_HWICAP)
+* @param addr_ini is a pointer to the memory addres that will store data read from the device
+* @param x0, y0, xf, yf are the coordinates of the region to be read
 *
 * @return   XST_SUCCESS else XST_FAILURE.
 *
 *****************************************************************************/
-int PCAP_RAM_read(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf, u32 yf)
+int CAP_RAM_read(XDcfg *InstancePtr, u32 transport, u32 **addr_start, u32 x0, u32 y0, u32 xf, u32 yf)
+{
+    int Status;
+
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
+    Status = CAP_set_transport(InstancePtr, transport);
+    if (Status == XST_SUCCESS)
+    {
+        Status = PCAP_read_frames(InstancePtr, addr_start, x0, y0, xf, yf);
+        CAP_set_transport(InstancePtr, CAP_TRANSPORT_PCAP);
+    }
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+    return Status;
+}
+
+/*
+* Body of PCAP_RAM_read(), called with the PCAP locked
+*/
+static int PCAP_read_frames(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf, u32 yf)
 {
     u32 Packet;
     u32 Data;
     int Status;
-    static u32 WriteBuffer[READ_FRAME_SIZE];
+    u32 WriteBuffer[READ_FRAME_SIZE]; // Header and tail, kept in the stack so that the function is reentrant
     u32 Index = 0;
-    volatile u32 IntrStsReg = 0;
     u32 TotalWords = 0;
 
 #ifdef PCAP_TIMING
@@ -651,12 +2283,8 @@ int PCAP_RAM_read(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf,
     Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
     Xil_AssertNonvoid(*addr_start != NULL);
 
-#ifdef PCAP_CLK_RW
     // Change PCAP clock configuration
-    *(volatile u32*)(SLCR_UNLOCK) = SLCR_UNLOCK_VAL;
-    *(volatile u32*)(SLCR_PCAP_CLK_CTRL) = ((PCAP_CLK_DIVISOR_READ & 0x3F) << 8) | ((PCAP_CLK_SOURCE & 0x3) << 4) | 0x1;
-    *(volatile u32*)(SLCR_LOCK) = SLCR_LOCK_VAL;
-#endif // #ifdef PCAP_CLK_RW
+    PCAP_set_clock(PCAP_clk_ctrl_read);
 
     // Repeat for each clock region
     int x, y;
@@ -716,101 +2344,656 @@ int PCAP_RAM_read(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf,
         WriteBuffer[Index++] = PCAP_NOOP_PACKET;
         WriteBuffer[Index++] = PCAP_NOOP_PACKET;
 
-        // DESYNC
-        Packet = (PCAP_Type1Write(PCAP_CMD) | 1);
-        Data = PCAP_CMD_DESYNCH;
-        WriteBuffer[Index++] = Packet;
-        WriteBuffer[Index++] = Data;
-        WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
-        WriteBuffer[Index++] = PCAP_DUMMY_PACKET;
-
-        /* 2 explicit DMA transfers */
-
 #ifdef PCAP_TIMING
         XTime_GetTime(&time); // Get time count
 #endif // #ifdef PCAP_TIMING
 
-        Xil_DCacheFlushRange(WriteBuffer, Index*4);
-        Status = XDcfg_Transfer(InstancePtr, WriteBuffer, Index, (u32*) XDCFG_DMA_INVALID_ADDRESS, 0, XDCFG_NON_SECURE_PCAP_WRITE);
-        //Status = XDcfg_Transfer(InstancePtr, WriteBuffer, Index, (u8*) XDCFG_DMA_INVALID_ADDRESS, 0, XDCFG_NON_SECURE_PCAP_WRITE);
+        // Send the packets (and the DESYNC) and read the frames
+        Status = PCAP_receive(InstancePtr, WriteBuffer, Index, *addr_start, TotalWords);
         if (Status != XST_SUCCESS)
         {
-        return XST_FAILURE;
-        }
-        // Poll IXR_DMA_DONE
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-        while ((IntrStsReg & XDCFG_IXR_DMA_DONE_MASK) != XDCFG_IXR_DMA_DONE_MASK)
-        {
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-        }
-        // Poll IXR_D_P_DONE
-        while ((IntrStsReg & XDCFG_IXR_D_P_DONE_MASK) != XDCFG_IXR_D_P_DONE_MASK)
-        {
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
+            return XST_FAILURE;
         }
 
 #ifdef PCAP_TIMING
         XTime_GetTime(&transfer); // Get time count
-        printf("DMA write transfer elapsed time:  %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-        printf("PCAP Bandwidth:                   %12.3f MB/s\n", ((float)Index*4)/((float)(transfer-time)*1000000/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)));
-        XTime_GetTime(&time); // Get time count
+        printf("Read transfer elapsed time:       %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
+        printf("PCAP Bandwidth:                   %12.3f MB/s\n", ((float)TotalWords*4)/((float)(transfer-time)*1000000/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)));
+#endif // #ifdef PCAP_TIMING
+
+        // Erase NULL frame
+        memmove(*addr_start, *addr_start+NUM_FRAME_WORDS, (TotalWords-NUM_FRAME_WORDS)*BYTES_PER_WORD_OF_FRAME);
+        // Reset command buffer index
+        Index = 0;
+        // Increment initial address
+        *addr_start = (u32*) ((u32) *addr_start + (TotalWords- (u32) NUM_FRAME_WORDS) * BYTES_PER_WORD_OF_FRAME);
+    }
+
+#ifdef PCAP_TIMING
+    XTime_GetTime(&time); // Get time count
+    printf("PCAP_DeviceReadPBS elapsed time:  %12.3f us (%10.0f cycles @ %7.3f MHz)\n", ((float)time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)time, (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
 #endif // #ifdef PCAP_TIMING
 
-        // Clear the interrupt status bits
-        XDcfg_IntrClear(InstancePtr, (XDCFG_IXR_PCFG_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK | XDCFG_IXR_DMA_DONE_MASK));
+    return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Calculates a word-wise hash of a configuration frame (FNV-1a on words with a
+* shift so that the high bits of each word also change the low bits)
+*
+* @param frame_addr is the first word of the frame
+*
+* @return   hash of the frame
+*
+*****************************************************************************/
+u32 PCAP_frame_hash(const u32 *frame_addr)
+{
+    u32 hash = 0x811C9DC5;
+    int i;
+
+    for (i = 0; i < NUM_FRAME_WORDS; i++)
+    {
+        hash = (hash ^ frame_addr[i]) * 0x01000193;
+        hash ^= hash >> 15;
+    }
+    return hash;
+}
+
+/****************************************************************************/
+/**
+*
+* Reads back the columns x0 to xf of a clock region row and compares them
+* frame by frame with the image that was written
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param image is the first frame of the column x0 in the image
+* @param x0, xf are the first and last columns
+* @param y is the clock region row
+* @param work_addr is a RAM buffer of PCAP_VERIFY_WORDS(frames) words
+* @param bad_frame returns the first frame that is not equal or -1
+*
+* @return   XST_SUCCESS if all the frames are equal else XST_FAILURE
+*
+*****************************************************************************/
+int PCAP_verify_frames(XDcfg *InstancePtr, u32 *image, u32 x0, u32 y, u32 xf, u32 *work_addr, int *bad_frame)
+{
+    int Status;
+
+    reconfig_os_lock(RECONFIG_LOCK_PCAP);
+    Status = PCAP_compare_frames(InstancePtr, image, x0, y, xf, work_addr, bad_frame);
+    reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+    return Status;
+}
+
+/*
+* Body of PCAP_verify_frames(), called with the PCAP locked
+*/
+static int PCAP_compare_frames(XDcfg *InstancePtr, u32 *image, u32 x0, u32 y, u32 xf, u32 *work_addr, int *bad_frame)
+{
+    u32 *readback_end = work_addr;
+    int num_frames, frame;
+
+    if (bad_frame != NULL)
+    {
+        *bad_frame = -1;
+    }
+    if (PCAP_read_frames(InstancePtr, &readback_end, x0, y, xf, y) != XST_SUCCESS)
+    {
+        return XST_FAILURE;
+    }
+
+    // Both images are in the RAM, so the words are compared directly (the hashes are only used by the scrubber)
+    num_frames = (readback_end - work_addr) / NUM_FRAME_WORDS;
+    for (frame = 0; frame < num_frames; frame++)
+    {
+        if (memcmp(work_addr + frame * NUM_FRAME_WORDS, image + frame * NUM_FRAME_WORDS, NUM_FRAME_BYTES) != 0)
+        {
+            if (bad_frame != NULL)
+            {
+                *bad_frame = frame;
+            }
+            return XST_FAILURE;
+        }
+    }
+    return XST_SUCCESS;
+}
+
+
+/****************************************************************************/
+/**
+*
+* Copies the rows of a pblock between the frames of one clock region row and a
+* PBS. When a new PBS is merged the words of the rows that are not used by the
+* pblock and the clock word of the frames read back are kept. The PBS contains,
+* for each frame, the words of the used rows without the clock word.
+*
+* @param frames_addr: first frame read back from the clock region row
+* @param PBS_addr: first word of the PBS of this clock region row
+* @param frame_stride_bytes: bytes between the first word of two consecutive
+* frames in the PBS
+* @param y: clock region row
+* @param x0, xf: first and last columns of the pblock
+* @param first_words_not_used, last_words_not_used: words of the frame below and
+* above the pblock
+* @param block: PCAP_FAR_CLB_BLOCK (frames read with PCAP_RAM_read()) or
+* PCAP_FAR_BRAM_BLOCK (frames read with PCAP_RAM_read_BRAM())
+* @param direction: PBS_MERGE copies the PBS to the frames and PBS_EXTRACT the
+* frames to the PBS
+* @param num_frames: returns the number of frames of the clock region row
+*
+* @return address of the next frame read back or NULL if the pblock position in
+* the clock region row is not valid
+*
+*****************************************************************************/
+static u32 *copy_clock_region_PBS(u32 *frames_addr, u32 *PBS_addr, int frame_stride_bytes, int y, int x0, int xf, int first_words_not_used, int last_words_not_used, u32 block, int direction, int *num_frames)
+{
+	int words_per_half_clock_region_without_clock;
+	int first_half_first_unused_words, first_half_words_to_move, last_half_first_unused_words, last_half_words_to_move;
+	int column_frames, merged_frames;
+	int x, frame;
+
+	words_per_half_clock_region_without_clock = (NUM_FRAME_WORDS - CLOCK_WORDS) / 2;
+
+	if(first_words_not_used < words_per_half_clock_region_without_clock && last_words_not_used < words_per_half_clock_region_without_clock) {
+		// The region crosses the middle of the clock region
+		first_half_first_unused_words = first_words_not_used;
+		first_half_words_to_move = words_per_half_clock_region_without_clock - first_words_not_used;
+		last_half_first_unused_words = 0;
+		last_half_words_to_move = words_per_half_clock_region_without_clock - last_words_not_used;
+	} else if(first_words_not_used >= words_per_half_clock_region_without_clock && last_words_not_used < words_per_half_clock_region_without_clock) {
+		// Region on the top half of the clock region
+		first_half_first_unused_words = 0;
+		first_half_words_to_move = 0;
+		last_half_first_unused_words = first_words_not_used - words_per_half_clock_region_without_clock;
+		last_half_words_to_move = words_per_half_clock_region_without_clock - last_words_not_used - last_half_first_unused_words;
+	} else if(first_words_not_used < words_per_half_clock_region_without_clock && last_words_not_used >= words_per_half_clock_region_without_clock) {
+		// Region on the bottom half of the clock region
+		first_half_first_unused_words = first_words_not_used;
+		first_half_words_to_move = 2*words_per_half_clock_region_without_clock - first_words_not_used - last_words_not_used;
+		last_half_first_unused_words = 0;
+		last_half_words_to_move = 0;
+	} else {
+		//The other cases are not possible
+		return NULL;
+	}
+
+	*num_frames = 0;
+	for(x = x0; x <= xf; x++) {
+		if (block == PCAP_FAR_BRAM_BLOCK) {
+			// The BRAM content frames have the rows of the BRAMs in the same words as the CLB frames
+			column_frames = ((fpga_bram[y][x] & 0xFFFF0000)>>16) == BRAM_CONTENT ? BRAM_CONTENT_FRAMES : 0;
+			merged_frames = column_frames;
+		} else {
+			column_frames = fpga[y][x][0] & 0xFFFF;
+			merged_frames = column_frames;
+			// Only the interconnect frames of the clock and configuration columns are merged
+			if (fpga[y][x][1] == CLK_TYPE || fpga[y][x][1] == CFG_TYPE) {
+				merged_frames = FRAMES_CLK_INTERCONNECT;
+			}
+		}
+		for(frame = 0; frame < column_frames; frame++) {
+			if (direction == PBS_EXTRACT) {
+				if (first_half_words_to_move > 0) {
+					memcpy(PBS_addr, frames_addr + first_half_first_unused_words, first_half_words_to_move * BYTES_PER_WORD_OF_FRAME);
+				}
+				if (last_half_words_to_move > 0) {
+					memcpy(PBS_addr + first_half_words_to_move, frames_addr + words_per_half_clock_region_without_clock + CLOCK_WORDS + last_half_first_unused_words, last_half_words_to_move * BYTES_PER_WORD_OF_FRAME);
+				}
+			} else if (frame < merged_frames) {
+				if (first_half_words_to_move > 0) {
+					memmove(frames_addr + first_half_first_unused_words, PBS_addr, first_half_words_to_move * BYTES_PER_WORD_OF_FRAME);
+				}
+				if (last_half_words_to_move > 0) {
+					memmove(frames_addr + words_per_half_clock_region_without_clock + CLOCK_WORDS + last_half_first_unused_words, PBS_addr + first_half_words_to_move, last_half_words_to_move * BYTES_PER_WORD_OF_FRAME);
+				}
+			}
+			PBS_addr = (u32*) ((u32) PBS_addr + frame_stride_bytes);
+			frames_addr = (u32*) ((u32) frames_addr + NUM_FRAME_BYTES);
+		}
+		*num_frames += column_frames;
+	}
+
+	return frames_addr;
+}
+
+
+
+/****************************************************************************/
+/**
+*
+* Initializes a staging buffer: a RAM region used to read back a region of the
+* FPGA and to combine it with a new PBS before it is written.
+*
+* @param buffer: staging buffer to initialize
+* @param addr_start: first word of the buffer
+* @param addr_limit: first word after the buffer (NULL if it is not checked)
+*
+* @return none
+*
+*****************************************************************************/
+void init_staging_buffer(staging_buffer_t *buffer, u32 *addr_start, u32 *addr_limit) {
+	buffer->addr_start = addr_start;
+	buffer->addr_limit = addr_limit;
+	buffer->readback_last_addr = addr_start;
+	buffer->region_addr[0] = addr_start;
+	buffer->num_regions = 0;
+	buffer->merged = 0;
+	buffer->transport = CAP_TRANSPORT_PCAP;
+}
+
+/****************************************************************************/
+/**
+*
+* Calculates from the FPGA description the size of a staging buffer big enough
+* to reconfigure any pblock of a given size: the readback of the widest set of
+* consecutive columns of every clock region row that it spans (plus the NULL
+* frame read with them) and a PBS of the same size, which is loaded above the
+* readback when it is not stored in the RAM.
+*
+* @param width: number of columns of the pblock
+* @param clock_rows: number of clock region rows that the pblock spans
+*
+* @return size of the buffer in bytes
+*
+*****************************************************************************/
+u32 staging_buffer_bytes(int width, int clock_rows) {
+	int x, y, frames, max_frames;
+
+	if (width > MAX_COLUMNS) {
+		width = MAX_COLUMNS;
+	}
+	max_frames = 0;
+	for (y = 0; y < MAX_ROWS; y++) {
+		frames = 0;
+		for (x = 0; x < MAX_COLUMNS; x++) {
+			frames += fpga[y][x][0] & 0xFFFF;
+			if (x >= width) {
+				frames -= fpga[y][x - width][0] & 0xFFFF;
+			}
+			if (x >= width - 1 && frames > max_frames) {
+				max_frames = frames;
+			}
+		}
+	}
+	return 2 * clock_rows * (max_frames + 1) * NUM_FRAME_BYTES;
+}
+
+/****************************************************************************/
+/**
+*
+* @param buffer, other: staging buffers
+*
+* @return 1 if any clock region row read back in one buffer shares frames with
+* a clock region row read back in the other one, else 0. When one of them is
+* written the readback of the other one is not valid any more.
+*
+*****************************************************************************/
+int staging_buffers_overlap(staging_buffer_t *buffer, staging_buffer_t *other) {
+	int i, j;
+
+	for (i = 0; i < buffer->num_regions; i++) {
+		for (j = 0; j < other->num_regions; j++) {
+			if (buffer->regions[i].Y0 == other->regions[j].Y0
+				&& buffer->regions[i].X0 <= other->regions[j].Xf && other->regions[j].X0 <= buffer->regions[i].Xf) {
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/*
+* Returns the clock region row of the buffer with the columns x0 to xf in the
+* clock region row y or -1
+*/
+static int find_staging_region(staging_buffer_t *buffer, int y, int x0, int xf) {
+	int i;
+
+	for (i = 0; i < buffer->num_regions; i++) {
+		if (buffer->regions[i].Y0 == y && buffer->regions[i].X0 == x0 && buffer->regions[i].Xf == xf) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+* Reads back all the clock region rows of the pblocks into the buffer. Each clock
+* region row is read back only once even if several pblocks use it.
+*/
+static int readback_subclock_region(XDcfg *InstancePtr, staging_buffer_t *buffer, pblock pblock_list[], u32 num_pblocks) {
+	int initial_clock_region_row, final_clock_region_row;
+	int i, x, y;
+	int x0, y0, xf, yf;
+	u32 readback_bytes;
+	int status;
+
+	buffer->readback_last_addr = buffer->addr_start;
+	buffer->num_regions = 0;
+	buffer->merged = 0;
+	for (i = 0; i < num_pblocks; i++) {
+		x0 = pblock_list[i].X0;
+		y0 = pblock_list[i].Y0;
+		xf = pblock_list[i].Xf;
+		yf = pblock_list[i].Yf;
+
+		initial_clock_region_row = (int) y0 / (int) ROWS_PER_CLOCK_REGION;
+		final_clock_region_row = (int) yf / (int) ROWS_PER_CLOCK_REGION;
+
+		for(y = initial_clock_region_row; y <= final_clock_region_row; y++) {
+		  if (find_staging_region(buffer, y, x0, xf) != -1) {
+			continue;
+		  }
+		  if (buffer->num_regions >= MAX_RECONFIGURABLE_CLOCK_REGIONS) {
+			return XST_FAILURE;
+		  }
+		  // The NULL frame is also read
+		  readback_bytes = NUM_FRAME_BYTES;
+		  for (x = x0; x <= xf; x++) {
+			readback_bytes += (fpga[y][x][0] & 0xFFFF) * NUM_FRAME_BYTES;
+		  }
+		  if (buffer->addr_limit != NULL && readback_bytes > (u32) buffer->addr_limit - (u32) buffer->readback_last_addr) {
+			return XST_FAILURE;
+		  }
+		  buffer->regions[buffer->num_regions].X0 = x0;
+		  buffer->regions[buffer->num_regions].Y0 = y;
+		  buffer->regions[buffer->num_regions].Xf = xf;
+		  buffer->regions[buffer->num_regions].Yf = y;
+		  buffer->region_addr[buffer->num_regions++] = buffer->readback_last_addr;
+		  //We read the actual content on the FPGA and save it on the RAM memory
+		  status = CAP_RAM_read(InstancePtr, buffer->transport, &buffer->readback_last_addr, x0, y, xf, y);
+		  if (status != XST_SUCCESS) {
+			return XST_FAILURE;
+		  }
+		  buffer->region_addr[buffer->num_regions] = buffer->readback_last_addr;
+		}
+	}
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Reads back a region defined as an array of rectangular pblocks into a staging
+* buffer. It can then be combined with new PBS with
+* prepare_subclock_region_PBS() setting stacked_modules to 2 or 3.
+*
+* @param InstancePtr: is a pointer to the PCAP instance.
+* @param buffer: staging buffer initialized with init_staging_buffer()
+* @param pblock_list[] array with the pblock that will be reconfigured
+* @param num_pblocks total number of pblocks in the array.
+*
+* @return XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int read_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, pblock pblock_list[], u32 num_pblocks) {
+	Xil_AssertNonvoid(InstancePtr != NULL);
+	Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+	Xil_AssertNonvoid(buffer != NULL);
+	Xil_AssertNonvoid(num_pblocks);
+
+	return readback_subclock_region(InstancePtr, buffer, pblock_list, num_pblocks);
+}
+
+/****************************************************************************/
+/**
+*
+* Prepares the write of a bitstream in a region defined as an array of
+* rectangular pblocks: the region is read back into a staging buffer and it is
+* combined with the new PBS. The FPGA is not written until
+* commit_subclock_region_PBS() is called, so the next reconfiguration can be
+* prepared in another buffer before the actual one is written (as long as they
+* do not share frames, see staging_buffers_overlap()).
+*
+* @param InstancePtr: is a pointer to the PCAP instance.
+* @param buffer: staging buffer initialized with init_staging_buffer()
+* @param file_name: name of the bitstream file located in the SD. If it is NULL
+* the PBS is already in the RAM between PBS_first_addr and PBS_last_addr (it is
+* not modified).
+* @param PBS_first_addr, PBS_last_addr: PBS in the RAM when file_name is NULL
+* @param pblock_list[] array with the pblock where the bitstream will be
+* reconfigured
+* @param num_pblocks total number of pblocks in the array.
+* @param stacked_modules: if set to 0 or 1 the region is read back. If set to 2
+* or 3 the PBS is combined with the region read back in the buffer by a previous
+* call (modules stacked in the same columns). See write_subclock_region_PBS().
+* @param contiguous_frames: see write_subclock_region_PBS()
+*
+* @return XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int prepare_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, const char *file_name, u32 *PBS_first_addr, u32 *PBS_last_addr, pblock pblock_list[], u32 num_pblocks, u8 stacked_modules, u8 contiguous_frames) {
+	int initial_clock_region_row, final_clock_region_row;
+	int first_rows_not_used, first_words_not_used, last_rows_not_used, last_words_not_used;
+	int clock_region_words, rows_merged, frame_stride_bytes, pblock_frame_bytes;
+	int num_frames, region;
+	int i, y; //iterable for variables
+	int x0, y0, xf, yf;
+	u32 *new_PBS_first_addr, *new_PBS_last_addr;
+	u32 *pblock_PBS_first_addr, *new_PBS_clock_region_addr;
+	int status;
+
+	Xil_AssertNonvoid(InstancePtr != NULL);
+	Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+	Xil_AssertNonvoid(buffer != NULL);
+	Xil_AssertNonvoid(file_name != NULL || PBS_first_addr != NULL);
+	Xil_AssertNonvoid(num_pblocks);
+	Xil_AssertNonvoid(stacked_modules <= 3);
+
+	//The first thing we do is copying the previous PBS of all the pblocks into the RAM memory
+	if (stacked_modules <= 1){
+		status = readback_subclock_region(InstancePtr, buffer, pblock_list, num_pblocks);
+		if (status != XST_SUCCESS) {
+			return XST_FAILURE;
+		}
+	} else if (buffer->num_regions == 0) {
+		return XST_FAILURE;
+	}
+	buffer->merged = 0;
+
+	if (file_name != NULL) {
+		new_PBS_first_addr = buffer->readback_last_addr;
+		//Now we copy the new PBS above the address of the previous PBS
+		new_PBS_last_addr = (u32*) load_bitstream(file_name, buffer->readback_last_addr, buffer->addr_limit);
+		if (new_PBS_last_addr == 0) {
+			return XST_FAILURE;
+		}
+	} else {
+		//The new PBS is already in the RAM
+		new_PBS_first_addr = PBS_first_addr;
+		new_PBS_last_addr = PBS_last_addr;
+	}
+
+	/**
+	* Now we combine the previous bitstream and the new bitstream. The PBS that we are going to
+	* reconfigure does not contain the clock word. Therefore the clock word must not be changed.
+	* This means that there may be vertical clock lines that do not have any load, thus creating
+	* net antennas that can increase the radiation emited by the FPGA. In the future it could
+	* be helpful to control the vertical clock lines enabling and disabling them on run-time
+	*/
+
+	for (i = 0; i < num_pblocks; i++) {
+		x0 = pblock_list[i].X0;
+		y0 = pblock_list[i].Y0;
+		xf = pblock_list[i].Xf;
+		yf = pblock_list[i].Yf;
+
+		initial_clock_region_row = (int) y0 / (int) ROWS_PER_CLOCK_REGION;
+		final_clock_region_row = (int) yf / (int) ROWS_PER_CLOCK_REGION;
+
+		/**
+		* If the frames of the PBS are contiguous each frame contains all the rows of the pblock.
+		* When the pblock crosses a clock region row the rows below the clock region boundary
+		* are merged in the lower clock region row and the rest in the upper one, so we jump
+		* from frame to frame with the whole pblock height.
+		*/
+		pblock_PBS_first_addr = new_PBS_first_addr;
+		pblock_frame_bytes = (yf - y0 + 1) * WORDS_PER_ROW_IN_CLOCK_REGION * BYTES_PER_WORD_OF_FRAME;
+		rows_merged = 0;
+
+		for(y = initial_clock_region_row; y <= final_clock_region_row; y++) {
+		  first_words_not_used = 0;
+		  last_words_not_used = 0;
+		  if(y == initial_clock_region_row) {
+			first_rows_not_used = y0 - (initial_clock_region_row * ROWS_PER_CLOCK_REGION);
+			first_words_not_used = first_rows_not_used * WORDS_PER_ROW_IN_CLOCK_REGION;
+		  }
+		  if(y == final_clock_region_row) {
+			last_rows_not_used = (((final_clock_region_row + 1) * ROWS_PER_CLOCK_REGION) - 1) - yf;
+			last_words_not_used = last_rows_not_used * WORDS_PER_ROW_IN_CLOCK_REGION;
+		  }
+		  clock_region_words = NUM_FRAME_WORDS - CLOCK_WORDS - first_words_not_used - last_words_not_used;
 
+		  if (contiguous_frames) {
+			  frame_stride_bytes = pblock_frame_bytes;
+			  new_PBS_clock_region_addr = (u32*) ((u32) pblock_PBS_first_addr + rows_merged * WORDS_PER_ROW_IN_CLOCK_REGION * BYTES_PER_WORD_OF_FRAME);
+		  } else {
+			  frame_stride_bytes = clock_region_words * BYTES_PER_WORD_OF_FRAME;
+			  new_PBS_clock_region_addr = new_PBS_first_addr;
+		  }
 
+		  //The clock region row must have been read back with the same columns
+		  region = find_staging_region(buffer, y, x0, xf);
+		  if (region == -1) {
+			  return XST_FAILURE;
+		  }
 
+		  /**
+		  * We move the contents of the new PBS to the readback in order to compose it with
+		  * the previous bitstream.
+		  */
+		  if (copy_clock_region_PBS(buffer->region_addr[region], new_PBS_clock_region_addr, frame_stride_bytes, y, x0, xf, first_words_not_used, last_words_not_used, PCAP_FAR_CLB_BLOCK, PBS_MERGE, &num_frames) != buffer->region_addr[region + 1]) {
+			  return XST_FAILURE;
+		  }
 
-        Status = XDcfg_Transfer(InstancePtr, (u32*) XDCFG_DMA_INVALID_ADDRESS, TotalWords, *addr_start, TotalWords, XDCFG_NON_SECURE_PCAP_WRITE);
-        //Status = XDcfg_Transfer(InstancePtr, (u8*) XDCFG_DMA_INVALID_ADDRESS, TotalWords, 0, TotalWords, XDCFG_NON_SECURE_PCAP_WRITE);
-        Xil_DCacheInvalidateRange(*addr_start, TotalWords*4);
-        if (Status != XST_SUCCESS)
-        {
-        return XST_FAILURE;
-        }
-        // Poll IXR_DMA_DONE
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
+		  if (!contiguous_frames) {
+			  new_PBS_first_addr = (u32*) ((u32) new_PBS_first_addr + num_frames * frame_stride_bytes);
+		  }
+		  rows_merged += clock_region_words / WORDS_PER_ROW_IN_CLOCK_REGION;
+		}
 
-        while ((IntrStsReg & XDCFG_IXR_DMA_DONE_MASK) != XDCFG_IXR_DMA_DONE_MASK)
-        {
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-        }
-        // Poll IXR_D_P_DONE
-        while ((IntrStsReg & XDCFG_IXR_D_P_DONE_MASK) != XDCFG_IXR_D_P_DONE_MASK)
-        {
-        IntrStsReg = XDcfg_IntrGetStatus(InstancePtr);
-        }
+		if (contiguous_frames) {
+			// All the clock region rows of the pblock must have the same number of frames
+			new_PBS_first_addr = (u32*) ((u32) pblock_PBS_first_addr + num_frames * pblock_frame_bytes);
+		}
+	}
 
-#ifdef PCAP_TIMING
-        XTime_GetTime(&transfer); // Get time count
-        printf("DMA read transfer elapsed time:   %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-        printf("PCAP Bandwidth:                   %12.3f MB/s\n", ((float)TotalWords*4)/((float)(transfer-time)*1000000/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)));
-#endif // #ifdef PCAP_TIMING
+	//We check that the size of the new PBS is compatible with the region to reconfigure
+	if ((u32) new_PBS_first_addr != (u32) new_PBS_last_addr) {
+		return XST_FAILURE;
+	}
 
+	buffer->merged = 1;
+	return XST_SUCCESS;
+}
 
-        // Clear the interrupt status bits
-        XDcfg_IntrClear(InstancePtr, (XDCFG_IXR_PCFG_DONE_MASK | XDCFG_IXR_D_P_DONE_MASK | XDCFG_IXR_DMA_DONE_MASK));
+/****************************************************************************/
+/**
+*
+* Writes the clock region rows of a staging buffer prepared with
+* prepare_subclock_region_PBS().
+*
+* @param InstancePtr: is a pointer to the PCAP instance.
+* @param buffer: staging buffer
+* @param erase_bram boolean. Erase BRAM contents if required.
+*
+* @return XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int commit_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 erase_bram) {
+	int i;
+	int status;
 
-        /* 2 explicit DMA transfers */
+	Xil_AssertNonvoid(InstancePtr != NULL);
+	Xil_AssertNonvoid(buffer != NULL);
 
-        // Erase NULL frame
-        memmove(*addr_start, *addr_start+NUM_FRAME_WORDS, (TotalWords-NUM_FRAME_WORDS)*BYTES_PER_WORD_OF_FRAME);
-        // Reset command buffer index
-        Index = 0;
-        // Increment initial address
-        *addr_start = (u32*) ((u32) *addr_start + (TotalWords- (u32) NUM_FRAME_WORDS) * BYTES_PER_WORD_OF_FRAME);
-    }
+	if (!buffer->merged) {
+		return XST_FAILURE;
+	}
+	//We write the bitstream for each region
+	for (i = 0; i < buffer->num_regions; i++) {
+		status = CAP_RAM_write(InstancePtr, buffer->transport, buffer->region_addr[i], (u32) buffer->region_addr[i + 1], buffer->regions[i].X0, buffer->regions[i].Y0, buffer->regions[i].Xf, buffer->regions[i].Yf, erase_bram);
+		if (status != XST_SUCCESS) {
+			return XST_FAILURE;
+		}
+	}
+	return XST_SUCCESS;
+}
 
-#ifdef PCAP_TIMING
-    XTime_GetTime(&time); // Get time count
-    printf("PCAP_DeviceReadPBS elapsed time:  %12.3f us (%10.0f cycles @ %7.3f MHz)\n", ((float)time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)time, (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-#endif // #ifdef PCAP_TIMING
+/****************************************************************************/
+/**
+*
+* Checks that the FPGA contains the frames of a staging buffer written with
+* commit_subclock_region_PBS(). Each clock region row is read back above the
+* readback of the buffer (that memory is only used while the PBS is combined)
+* and compared with the frames written.
+*
+* @param InstancePtr: is a pointer to the PCAP instance.
+* @param buffer: staging buffer written with commit_subclock_region_PBS()
+* @param mode: PCAP_VERIFY_FULL checks all the columns. PCAP_VERIFY_SAMPLED
+* checks one column of each clock region row. PCAP_VERIFY_OFF does nothing.
+* @param sample: selects the column checked in PCAP_VERIFY_SAMPLED mode (e.g. a
+* counter of the reconfigurations, so that all the columns are checked over time)
+*
+* @return XST_SUCCESS else XST_FAILURE if a frame is not equal or the buffer
+* has no memory to read back a clock region row.
+*
+*****************************************************************************/
+int verify_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 mode, u32 sample) {
+	u32 *work_addr, *image;
+	int i, x, x0, xf, y;
+	u32 frames;
+	int status;
 
-    return XST_SUCCESS;
-}
+	Xil_AssertNonvoid(InstancePtr != NULL);
+	Xil_AssertNonvoid(buffer != NULL);
 
+	if (mode == PCAP_VERIFY_OFF) {
+		return XST_SUCCESS;
+	}
+	if (!buffer->merged) {
+		return XST_FAILURE;
+	}
+	// Aligned to a cache line so that the invalidation of the readback does not
+	// discard the last frames written
+	work_addr = (u32 *) (((u32) buffer->readback_last_addr + 31) & ~31);
+
+	reconfig_os_lock(RECONFIG_LOCK_PCAP);
+	status = CAP_set_transport(InstancePtr, buffer->transport);
+	for (i = 0; i < buffer->num_regions && status == XST_SUCCESS; i++) {
+		x0 = buffer->regions[i].X0;
+		xf = buffer->regions[i].Xf;
+		y = buffer->regions[i].Y0;
+		image = buffer->region_addr[i];
+		if (mode == PCAP_VERIFY_SAMPLED) {
+			// The frames of the columns before the sampled one are skipped in the image
+			x = x0 + (sample + i) % (xf - x0 + 1);
+			for (; x0 < x; x0++) {
+				image += (fpga[y][x0][0] & 0xFFFF) * NUM_FRAME_WORDS;
+			}
+			xf = x;
+		}
+		frames = 0;
+		for (x = x0; x <= xf; x++) {
+			frames += fpga[y][x][0] & 0xFFFF;
+		}
+		if (frames == 0) {
+			continue;
+		}
+		if (buffer->addr_limit != NULL && work_addr + PCAP_VERIFY_WORDS(frames) > buffer->addr_limit) {
+			status = XST_FAILURE;
+			break;
+		}
+		status = PCAP_compare_frames(InstancePtr, image, x0, y, xf, work_addr, NULL);
+	}
+	CAP_set_transport(InstancePtr, CAP_TRANSPORT_PCAP);
+	reconfig_os_unlock(RECONFIG_LOCK_PCAP);
 
+	return status;
+}
 
 /****************************************************************************/
 /**
@@ -825,10 +3008,13 @@ int PCAP_RAM_read(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf,
 * i.e. it has to contain whole RAM and DSP tiles
 *
 * @param InstancePtr: is a pointer to the PCAP instance.
+* @param buffer: descriptor of the staging buffer, owned by the caller. It is
+* initialized at addr_start unless stacked_modules is 2 or 3, so all the calls
+* of a set of stacked modules must use the same descriptor and memory.
 * @param addr_start: is a pointer to free memory address. NOTE This memory needs
 * to be big enough to read the partial bitstream of the region to reallocate
 * (with the whole frame height) and to write on top of that the new partial
-* bitstream
+* bitstream.
 * @param file_name: name of the bitstream file located in the SD wich will be
 * reconfigured
 * @param pblock_list[] array with the pblock where the bitstream will be
@@ -841,94 +3027,169 @@ int PCAP_RAM_read(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf,
 * bitstream combination is performed. If set to 2 then, only the combination is
 * performed. Lastly, if set to 3 only the combination and the write operation
 * are performed.
+* @param contiguous_frames: if set to 1 each frame of the PBS contains all the
+* rows of the pblock one after the other even if the pblock crosses a clock
+* region row. This is the case of every PBS extracted from a pblock contained in
+* one clock region row, which can then be relocated into a pblock that crosses
+* two vertical clock regions. If set to 0 the PBS stores all the frames of each
+* clock region row one after the other.
 *
 *
 * @return XST_SUCCESS else XST_FAILURE.
 *
 *****************************************************************************/
-int write_subclock_region_PBS(XDcfg *InstancePtr, u32 *addr_start, const char *file_name, pblock pblock_list[], u32 num_pblocks, u32 erase_bram, u8 stacked_modules) {
-	int initial_clock_region_row, final_clock_region_row, words_per_half_clock_region_without_clock;
-	int first_rows_not_used, first_words_not_used, last_rows_not_used, last_words_not_used;
-	int first_half_bytes_to_move, first_half_first_unused_bytes, last_half_bytes_to_move, last_half_first_unused_bytes;
-	int num_frames, extra_frames, reconfigurable_regions;
-	int i, y, x, frame; //iterable for variables
-	int x0, y0, xf, yf;
-	u32 *previous_PBS_first_addr, *new_PBS_first_addr, *new_PBS_last_addr;
-	u32 *pblock_addr[MAX_RECONFIGURABLE_CLOCK_REGIONS];
-	int status;
-	static u32 *previous_PBS_last_addr;
+int write_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *addr_start, const char *file_name, pblock pblock_list[], u32 num_pblocks, u32 erase_bram, u8 stacked_modules, u8 contiguous_frames) {
+	Xil_AssertNonvoid(file_name != NULL);
 
-	Xil_AssertNonvoid(InstancePtr != NULL);
-	Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
-	Xil_AssertNonvoid(addr_start != NULL);
-	Xil_AssertNonvoid(num_pblocks);
-	Xil_AssertNonvoid(stacked_modules <= 3);
+	return write_subclock_region(InstancePtr, buffer, addr_start, file_name, NULL, NULL, pblock_list, num_pblocks, erase_bram, stacked_modules, contiguous_frames);
+}
 
-	// XTime time, transfer; // Elapsed time local variable
-	// XTime_SetTime(0);     // Initialize time count
-  // 
-	// XTime_GetTime(&time); // Get time count
+/****************************************************************************/
+/**
+*
+* Writes a bitstream that is already stored in the RAM (e.g. loaded in advance
+* with start_bitstream_load_from_SD()) in a region defined as an array of
+* rectangular pblocks. It is equivalent to write_subclock_region_PBS() but the
+* SD card is not accessed and the PBS is not modified, so it can be written
+* again later.
+*
+* @param InstancePtr: is a pointer to the PCAP instance.
+* @param buffer: descriptor of the staging buffer (see write_subclock_region_PBS())
+* @param addr_start: is a pointer to free memory address that must be big
+* enough to read back the region to reallocate. It must not overlap the PBS.
+* @param PBS_first_addr: first word of the PBS in the RAM
+* @param PBS_last_addr: final position of the PBS in the RAM
+* @param pblock_list[] array with the pblock where the bitstream will be
+* reconfigured
+* @param num_pblocks total number of pblocks in the array.
+* @param erase_bram boolean. Erase BRAM contents if required.
+* @param stacked_modules: see write_subclock_region_PBS()
+* @param contiguous_frames: see write_subclock_region_PBS()
+*
+* @return XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int write_subclock_region_RAM_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *addr_start, u32 *PBS_first_addr, u32 *PBS_last_addr, pblock pblock_list[], u32 num_pblocks, u32 erase_bram, u8 stacked_modules, u8 contiguous_frames) {
+	Xil_AssertNonvoid(PBS_first_addr != NULL);
+	Xil_AssertNonvoid(PBS_last_addr >= PBS_first_addr);
 
-	//The first thing we do is copying the previous PBS of all the pblocks into the RAM memory
-	previous_PBS_first_addr = addr_start;
-	reconfigurable_regions = 0;
-	if (stacked_modules <= 1){
-		previous_PBS_last_addr = addr_start;
-		for (i = 0; i < num_pblocks; i++) {
-			x0 = pblock_list[i].X0;
-			y0 = pblock_list[i].Y0;
-			xf = pblock_list[i].Xf;
-			yf = pblock_list[i].Yf;
+	return write_subclock_region(InstancePtr, buffer, addr_start, NULL, PBS_first_addr, PBS_last_addr, pblock_list, num_pblocks, erase_bram, stacked_modules, contiguous_frames);
+}
 
+/*
+* Common part of write_subclock_region_PBS() and write_subclock_region_RAM_PBS().
+* The region is staged without size limit in the buffer of the caller, which
+* keeps the readback between the calls of stacked modules.
+*/
+static int write_subclock_region(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *addr_start, const char *file_name, u32 *PBS_first_addr, u32 *PBS_last_addr, pblock pblock_list[], u32 num_pblocks, u32 erase_bram, u8 stacked_modules, u8 contiguous_frames) {
+	int status;
 
-			initial_clock_region_row = (int) y0 / (int) ROWS_PER_CLOCK_REGION;
-			final_clock_region_row = (int) yf / (int) ROWS_PER_CLOCK_REGION;
+	Xil_AssertNonvoid(buffer != NULL);
+	Xil_AssertNonvoid(addr_start != NULL);
 
-			for(y = initial_clock_region_row; y <= final_clock_region_row; y++) {
-			  pblock_addr[reconfigurable_regions++] = previous_PBS_last_addr;
-			  if (reconfigurable_regions >= MAX_RECONFIGURABLE_CLOCK_REGIONS) {
-				return XST_FAILURE;
-			  }
-			  //We read the actual content on the FPGA and save it on the RAM memory
-			  status = PCAP_RAM_read(InstancePtr, &previous_PBS_last_addr, x0, y, xf, y);
-			  if (status != XST_SUCCESS) {
-				return XST_FAILURE;
-			  }
-			}
-		}
-	} else {
-		pblock_addr[reconfigurable_regions++] = addr_start;
+	if (stacked_modules <= 1) {
+		init_staging_buffer(buffer, addr_start, NULL);
 	}
-
-	// XTime_GetTime(&transfer); // Get time count
-	// printf("readback time:  %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-	// XTime_GetTime(&time); // Get time count
-
-	pblock_addr[reconfigurable_regions] = previous_PBS_last_addr;
-	if (reconfigurable_regions >= MAX_RECONFIGURABLE_CLOCK_REGIONS) {
+	status = prepare_subclock_region_PBS(InstancePtr, buffer, file_name, PBS_first_addr, PBS_last_addr, pblock_list, num_pblocks, stacked_modules, contiguous_frames);
+	if (status != XST_SUCCESS) {
 		return XST_FAILURE;
 	}
-	new_PBS_first_addr = previous_PBS_last_addr;
-	//Now we copy the new PBS above the address of the previous PBS
-	new_PBS_last_addr = (u32*) load_bitstream_from_SD_to_RAM(file_name, previous_PBS_last_addr);
-	if (new_PBS_last_addr == 0) {
-		return XST_FAILURE;
+	if (stacked_modules == 0 || stacked_modules == 3) {
+		return commit_subclock_region_PBS(InstancePtr, buffer, erase_bram);
 	}
+	return XST_SUCCESS;
+}
 
-	// XTime_GetTime(&transfer); // Get time count
-	// printf("SD to RAM time:  %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-	// XTime_GetTime(&time); // Get time count
+/****************************************************************************/
+/**
+*
+* Calculates the size of the state of a region captured with
+* capture_subclock_region_state()
+*
+* @param pblock_list[] array with the pblocks of the region
+* @param num_pblocks total number of pblocks in the array.
+* @param work_words: returns the size of the work memory of the BRAM frames of
+* one clock region row (it can be NULL)
+*
+* @return number of words of the state
+*
+*****************************************************************************/
+u32 subclock_region_state_words(pblock pblock_list[], u32 num_pblocks, u32 *work_words) {
+	u32 CLB_words, BRAM_words;
 
+	subclock_region_state_size(pblock_list, num_pblocks, &CLB_words, &BRAM_words, work_words);
+	return CLB_words + BRAM_words;
+}
 
-	/**
-	* Now we combine the previous bitstream and the new bitstream. The PBS that we are going to
-	* reconfigure does not contain the clock word. Therefore the clock word must not be changed.
-	* This means that there may be vertical clock lines that do not have any load, thus creating
-	* net antennas that can increase the radiation emited by the FPGA. In the future it could
-	* be helpful to control the vertical clock lines enabling and disabling them on run-time
-	*/
+/****************************************************************************/
+/**
+*
+* Calculates the size of the BRAM contents of a region written with
+* write_subclock_region_BRAM(), e.g. the BRAM section of a PBS
+*
+* @param pblock_list[] array with the pblocks of the region
+* @param num_pblocks total number of pblocks in the array.
+* @param work_words: returns the size of the work memory of the BRAM frames of
+* one clock region row (it can be NULL)
+*
+* @return number of words of the BRAM contents
+*
+*****************************************************************************/
+u32 subclock_region_BRAM_words(pblock pblock_list[], u32 num_pblocks, u32 *work_words) {
+	u32 CLB_words, BRAM_words;
 
-	words_per_half_clock_region_without_clock = (NUM_FRAME_WORDS - CLOCK_WORDS) / 2;
+	subclock_region_state_size(pblock_list, num_pblocks, &CLB_words, &BRAM_words, work_words);
+	return BRAM_words;
+}
+
+/*
+* Words of the configuration frames and of the BRAM contents of the state of a
+* region and the work memory needed to read back the BRAM of one clock region row
+*/
+static void subclock_region_state_size(pblock pblock_list[], u32 num_pblocks, u32 *CLB_words, u32 *BRAM_words, u32 *work_words) {
+	u32 frames, rows, words;
+	int i, x, y;
+
+	*CLB_words = 0;
+	*BRAM_words = 0;
+	if (work_words != NULL) {
+		*work_words = 0;
+	}
+	for (i = 0; i < num_pblocks; i++) {
+		// All the clock region rows of a pblock have the same columns
+		y = pblock_list[i].Y0 / ROWS_PER_CLOCK_REGION;
+		rows = pblock_list[i].Yf - pblock_list[i].Y0 + 1;
+		frames = 0;
+		for (x = pblock_list[i].X0; x <= pblock_list[i].Xf; x++) {
+			frames += fpga[y][x][0] & 0xFFFF;
+		}
+		*CLB_words += frames * rows * WORDS_PER_ROW_IN_CLOCK_REGION;
+		frames = PCAP_BRAM_content_frames(pblock_list[i].X0, y, pblock_list[i].Xf, y);
+		*BRAM_words += frames * rows * WORDS_PER_ROW_IN_CLOCK_REGION;
+		// The NULL frame is also read
+		words = (frames + 1) * NUM_FRAME_WORDS;
+		if (work_words != NULL && words > *work_words) {
+			*work_words = words;
+		}
+	}
+}
+
+/*
+* Copies the rows of the pblocks between the frames of their clock region rows
+* and a state with contiguous frames (each frame of a pblock contains all its
+* rows). The CLB frames are the ones read back in the buffer. The BRAM frames of
+* each clock region row are read back in work_addr and, when the state is
+* merged, written back.
+*/
+static int copy_subclock_region_state(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *work_addr, u32 *state_addr, pblock pblock_list[], u32 num_pblocks, u32 block, int direction, u32 **state_end) {
+	int initial_clock_region_row, final_clock_region_row;
+	int first_words_not_used, last_words_not_used;
+	int clock_region_words, rows_copied, pblock_frame_bytes;
+	int num_frames, pblock_num_frames, region;
+	int i, y;
+	int x0, y0, xf, yf;
+	u32 *pblock_state_addr, *frames_addr, *frames_end;
+	int status;
 
 	for (i = 0; i < num_pblocks; i++) {
 		x0 = pblock_list[i].X0;
@@ -939,162 +3200,228 @@ int write_subclock_region_PBS(XDcfg *InstancePtr, u32 *addr_start, const char *f
 		initial_clock_region_row = (int) y0 / (int) ROWS_PER_CLOCK_REGION;
 		final_clock_region_row = (int) yf / (int) ROWS_PER_CLOCK_REGION;
 
-		for(y = initial_clock_region_row; y <= final_clock_region_row; y++) {
-		  first_words_not_used = 0;
-		  last_words_not_used = 0;
-		  if(y == initial_clock_region_row) {
-			first_rows_not_used = y0 - (initial_clock_region_row * ROWS_PER_CLOCK_REGION);
-			first_words_not_used = first_rows_not_used * WORDS_PER_ROW_IN_CLOCK_REGION;
-		  }
-		  if(y == final_clock_region_row) {
-			last_rows_not_used = (((final_clock_region_row + 1) * ROWS_PER_CLOCK_REGION) - 1) - yf;
-			last_words_not_used = last_rows_not_used * WORDS_PER_ROW_IN_CLOCK_REGION;
-		  }
-		  /**
-		  * We move the contents of the new PBS (located in the upper part of the RAM) to the lower part
-		  * in order to compose it with the previous bitstream.
-		  */
-		  if(first_words_not_used < words_per_half_clock_region_without_clock && last_words_not_used < words_per_half_clock_region_without_clock) {
-			  // The region crosses the middle of the clock region
-			  first_half_first_unused_bytes = first_words_not_used * BYTES_PER_WORD_OF_FRAME;
-			  first_half_bytes_to_move = (words_per_half_clock_region_without_clock - first_words_not_used) * BYTES_PER_WORD_OF_FRAME;
-//			  last_half_first_unused_bytes = 0;
-			  last_half_bytes_to_move = (words_per_half_clock_region_without_clock - last_words_not_used) * BYTES_PER_WORD_OF_FRAME;
-			  for(x = x0; x <= xf; x++) {
-				  num_frames = fpga[y][x][0] & 0xFFFF;
-				  extra_frames = 0;
-				  if (fpga[y][x][1] == CLK_TYPE) {
-					  extra_frames = num_frames - FRAMES_CLK_INTERCONNECT;
-					  num_frames = FRAMES_CLK_INTERCONNECT;
-				  } else if (fpga[y][x][1] == CFG_TYPE) {
-            extra_frames = num_frames - FRAMES_CLK_INTERCONNECT;
-					  num_frames = FRAMES_CLK_INTERCONNECT;
-				  }
-				  for(frame = 0; frame < num_frames; frame++) {
-					  memmove((u32*) ((u32) previous_PBS_first_addr + first_half_first_unused_bytes), new_PBS_first_addr, first_half_bytes_to_move);
-					  new_PBS_first_addr = (u32*) ((u32) new_PBS_first_addr + first_half_bytes_to_move);
-					  previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + (words_per_half_clock_region_without_clock + CLOCK_WORDS) * BYTES_PER_WORD_OF_FRAME);
-					  memmove((u32*) ((u32) previous_PBS_first_addr), new_PBS_first_addr, last_half_bytes_to_move);
-					  new_PBS_first_addr = (u32*) ((u32) new_PBS_first_addr + last_half_bytes_to_move);
-					  previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + words_per_half_clock_region_without_clock * BYTES_PER_WORD_OF_FRAME);
-
-				  }
-				  for (frame = 0; frame < extra_frames; frame++) {
-					  new_PBS_first_addr =  (u32*) ((u32) new_PBS_first_addr + first_half_bytes_to_move + last_half_bytes_to_move);
-					  previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + NUM_FRAME_BYTES);
-				  }
-			  }
-
-		  } else if(first_words_not_used >= words_per_half_clock_region_without_clock && last_words_not_used < words_per_half_clock_region_without_clock) {
-			  // Region on the top half of the clock region
-//			  first_half_first_unused_bytes =0; //In this case we don't care about this value
-//			  first_half_bytes_to_move = 0;
-			  last_half_first_unused_bytes = (first_words_not_used - words_per_half_clock_region_without_clock) * BYTES_PER_WORD_OF_FRAME;
-			  last_half_bytes_to_move = ((words_per_half_clock_region_without_clock - last_words_not_used) * BYTES_PER_WORD_OF_FRAME) - last_half_first_unused_bytes;
-			  for(x = x0; x <= xf; x++) {
-				  num_frames = fpga[y][x][0] & 0xFFFF;
-				  extra_frames = 0;
-				  if (fpga[y][x][1] == CLK_TYPE) {
-					  extra_frames = num_frames - FRAMES_CLK_INTERCONNECT;
-					  num_frames = FRAMES_CLK_INTERCONNECT;
-				  } else if (fpga[y][x][1] == CFG_TYPE) {
-            extra_frames = num_frames - FRAMES_CLK_INTERCONNECT;
-					  num_frames = FRAMES_CLK_INTERCONNECT;
-				  }
-				  for(frame = 0; frame < num_frames; frame++) {
-					  previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + (words_per_half_clock_region_without_clock + CLOCK_WORDS) * BYTES_PER_WORD_OF_FRAME);
-					  memmove((u32*) ((u32) previous_PBS_first_addr + last_half_first_unused_bytes), new_PBS_first_addr, last_half_bytes_to_move);
-					  new_PBS_first_addr = (u32*) ((u32) new_PBS_first_addr + last_half_bytes_to_move);
-					  previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + words_per_half_clock_region_without_clock * BYTES_PER_WORD_OF_FRAME);
-				  }
-				  for (frame = 0; frame < extra_frames; frame++) {
-					  new_PBS_first_addr =  (u32*) ((u32) new_PBS_first_addr + last_half_bytes_to_move);
-					  previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + NUM_FRAME_BYTES);
-				  }
-			  }
-
-
-		  } else if(first_words_not_used < words_per_half_clock_region_without_clock && last_words_not_used >= words_per_half_clock_region_without_clock) {
-			  // Region on the bottom half of tyhe clock region
-			  first_half_first_unused_bytes = first_words_not_used * BYTES_PER_WORD_OF_FRAME;
-			  first_half_bytes_to_move = (2*words_per_half_clock_region_without_clock - first_words_not_used - last_words_not_used) * BYTES_PER_WORD_OF_FRAME;
-//			  last_half_first_unused_bytes = 0; //In this case we don't care about this value
-//			  last_half_bytes_to_move = 0;
-			  for(x = x0; x <= xf; x++) {
-				  num_frames = fpga[y][x][0] & 0xFFFF;
-				  extra_frames = 0;
-				  if (fpga[y][x][1] == CLK_TYPE) {
-					  extra_frames = num_frames - FRAMES_CLK_INTERCONNECT;
-					  num_frames = FRAMES_CLK_INTERCONNECT;
-				  } else if (fpga[y][x][1] == CFG_TYPE) {
-					  extra_frames = num_frames - FRAMES_CLK_INTERCONNECT;
-				    num_frames = FRAMES_CLK_INTERCONNECT;
-				  }
-				  for(frame = 0; frame < num_frames; frame++) {
-					  memmove((u32*) ((u32) previous_PBS_first_addr + first_half_first_unused_bytes), new_PBS_first_addr, first_half_bytes_to_move);
-					  new_PBS_first_addr = (u32*) ((u32) new_PBS_first_addr + first_half_bytes_to_move);
-					  previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + NUM_FRAME_BYTES);
-
-				  }
-				  for (frame = 0; frame < extra_frames; frame++) {
-					  new_PBS_first_addr =  (u32*) ((u32) new_PBS_first_addr + first_half_bytes_to_move);
-					  previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + NUM_FRAME_BYTES);
-				  }
-			  }
-		  } else {
-			  //The other cases are not possible
-			  return XST_FAILURE;
-		  }
-//		  for(x = x0; x <= xf; x++) {
-//			num_frames = fpga[y][x][0] & 0xFFFF;
-//			for(frame = 0; frame < num_frames; frame++) {
-//				memmove((u32*) ((u32) previous_PBS_first_addr + first_half_first_unused_bytes), new_PBS_first_addr, first_half_bytes_to_move);
-//				new_PBS_first_addr = (u32*) ((u32) new_PBS_first_addr + first_half_bytes_to_move);
-//				previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + (words_per_half_clock_region_without_clock + CLOCK_WORDS) * BYTES_PER_WORD_OF_FRAME);
-//				memmove((u32*) ((u32) previous_PBS_first_addr + last_half_first_unused_bytes), new_PBS_first_addr, last_half_bytes_to_move);
-//				new_PBS_first_addr = (u32*) ((u32) new_PBS_first_addr + last_half_bytes_to_move);
-//				previous_PBS_first_addr = (u32*) ((u32) previous_PBS_first_addr + words_per_half_clock_region_without_clock * BYTES_PER_WORD_OF_FRAME);
-//
-//			}
-//		}
-		}
-	}
+		pblock_state_addr = state_addr;
+		pblock_frame_bytes = (yf - y0 + 1) * WORDS_PER_ROW_IN_CLOCK_REGION * BYTES_PER_WORD_OF_FRAME;
+		pblock_num_frames = 0;
+		rows_copied = 0;
 
-	//We check that the size of the region to reconfigure and the new PBS are compatible
-	if(( (u32) previous_PBS_first_addr != (u32) previous_PBS_last_addr ) || ((u32) new_PBS_first_addr != (u32) new_PBS_last_addr) ) {
-		return XST_FAILURE;
-	}
+		for (y = initial_clock_region_row; y <= final_clock_region_row; y++) {
+			first_words_not_used = 0;
+			last_words_not_used = 0;
+			if (y == initial_clock_region_row) {
+				first_words_not_used = (y0 - (initial_clock_region_row * ROWS_PER_CLOCK_REGION)) * WORDS_PER_ROW_IN_CLOCK_REGION;
+			}
+			if (y == final_clock_region_row) {
+				last_words_not_used = ((((final_clock_region_row + 1) * ROWS_PER_CLOCK_REGION) - 1) - yf) * WORDS_PER_ROW_IN_CLOCK_REGION;
+			}
+			clock_region_words = NUM_FRAME_WORDS - CLOCK_WORDS - first_words_not_used - last_words_not_used;
+
+			if (block == PCAP_FAR_CLB_BLOCK) {
+				region = find_staging_region(buffer, y, x0, xf);
+				if (region == -1) {
+					return XST_FAILURE;
+				}
+				frames_addr = buffer->region_addr[region];
+				frames_end = buffer->region_addr[region + 1];
+			} else {
+				frames_addr = work_addr;
+				frames_end = work_addr;
+				status = PCAP_RAM_read_BRAM(InstancePtr, &frames_end, x0, y, xf, y);
+				if (status != XST_SUCCESS) {
+					return XST_FAILURE;
+				}
+			}
 
-	// XTime_GetTime(&transfer); // Get time count
-	// printf("recombination time:  %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-	// XTime_GetTime(&time); // Get time count
-
-	if (stacked_modules == 0 || stacked_modules == 3){
-		//We write the bitstream for each region
-		reconfigurable_regions = 0;
-		for (i = 0; i < num_pblocks; i++) {
-			x0 = pblock_list[i].X0;
-			y0 = pblock_list[i].Y0;
-			xf = pblock_list[i].Xf;
-			yf = pblock_list[i].Yf;
-
-			initial_clock_region_row = (int) y0 / (int) ROWS_PER_CLOCK_REGION;
-			final_clock_region_row = (int) yf / (int) ROWS_PER_CLOCK_REGION;
-
-			for(y = initial_clock_region_row; y <= final_clock_region_row; y++) {
-			  status = PCAP_RAM_write(InstancePtr, pblock_addr[reconfigurable_regions], (u32) (pblock_addr[reconfigurable_regions + 1]), x0, y, xf, y, erase_bram);
-			  if (status != XST_SUCCESS) {
+			if (copy_clock_region_PBS(frames_addr, (u32*) ((u32) pblock_state_addr + rows_copied * WORDS_PER_ROW_IN_CLOCK_REGION * BYTES_PER_WORD_OF_FRAME), pblock_frame_bytes, y, x0, xf, first_words_not_used, last_words_not_used, block, direction, &num_frames) != frames_end) {
+				return XST_FAILURE;
+			}
+			if (y != initial_clock_region_row && num_frames != pblock_num_frames) {
 				return XST_FAILURE;
-			  }
-			  reconfigurable_regions++;
 			}
+			pblock_num_frames = num_frames;
+
+			if (block == PCAP_FAR_BRAM_BLOCK && direction == PBS_MERGE && num_frames > 0) {
+				status = PCAP_RAM_write_BRAM(InstancePtr, work_addr, (u32) frames_end, x0, y, xf, y);
+				if (status != XST_SUCCESS) {
+					return XST_FAILURE;
+				}
+			}
+			rows_copied += clock_region_words / WORDS_PER_ROW_IN_CLOCK_REGION;
 		}
+		state_addr = (u32*) ((u32) pblock_state_addr + pblock_num_frames * pblock_frame_bytes);
 	}
 
-	// XTime_GetTime(&transfer); // Get time count
-	// printf("Write time:  %12.3f us (%10.0f cycles @ %7.3f MHz)\n", (float)(transfer-time)/(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)*1000000, (float)(transfer-time), (float)(XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ/2)/1000000);
-	// XTime_GetTime(&time); // Get time count
+	*state_end = state_addr;
+	return XST_SUCCESS;
+}
+
+/****************************************************************************/
+/**
+*
+* Captures the state of the logic of a region: the values of the flip-flops are
+* copied to their INIT bits with GCAPTURE and the configuration frames (which
+* also contain the LUTRAMs and SRLs) and the BRAM contents of the region are
+* read back. Only the rows of the pblocks are kept, with contiguous frames (see
+* write_subclock_region_PBS()), so the state can be restored with
+* restore_subclock_region_state() in any region with the same columns.
+*
+* NOTE the logic of the region should be stopped (e.g. its clock disabled) so
+* that the flip-flops and the BRAMs do not change while the state is captured.
+* GCAPTURE also changes the INIT bits of the rest of the FPGA, so the frames
+* read back before the capture (e.g. prepared staging buffers or golden images)
+* no longer contain the actual INIT bits.
+*
+* @param InstancePtr: is a pointer to the PCAP instance.
+* @param buffer: staging buffer initialized with init_staging_buffer(). It is
+* used to read back the configuration frames.
+* @param work_addr: memory for the BRAM frames of one clock region row (see
+* subclock_region_state_words()) aligned to a cache line
+* @param pblock_list[] array with the pblocks of the region
+* @param num_pblocks total number of pblocks in the array.
+* @param state_first_addr: first word of the memory of the state
+* @param state_last_addr: returns the final position of the state
+*
+* @return XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int capture_subclock_region_state(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *work_addr, pblock pblock_list[], u32 num_pblocks, u32 *state_first_addr, u32 **state_last_addr) {
+	u32 *state_addr;
+	int status;
+
+	Xil_AssertNonvoid(InstancePtr != NULL);
+	Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+	Xil_AssertNonvoid(buffer != NULL);
+	Xil_AssertNonvoid(work_addr != NULL);
+	Xil_AssertNonvoid(state_first_addr != NULL);
+	Xil_AssertNonvoid(num_pblocks);
 
+	reconfig_os_lock(RECONFIG_LOCK_PCAP);
+	status = PCAP_send_command(InstancePtr, PCAP_CMD_GCAPTURE);
+	if (status == XST_SUCCESS) {
+		status = readback_subclock_region(InstancePtr, buffer, pblock_list, num_pblocks);
+	}
+	if (status == XST_SUCCESS) {
+		status = copy_subclock_region_state(InstancePtr, buffer, work_addr, state_first_addr, pblock_list, num_pblocks, PCAP_FAR_CLB_BLOCK, PBS_EXTRACT, &state_addr);
+	}
+	if (status == XST_SUCCESS) {
+		status = copy_subclock_region_state(InstancePtr, buffer, work_addr, state_addr, pblock_list, num_pblocks, PCAP_FAR_BRAM_BLOCK, PBS_EXTRACT, &state_addr);
+	}
+	reconfig_os_unlock(RECONFIG_LOCK_PCAP);
 
+	if (status != XST_SUCCESS) {
+		return XST_FAILURE;
+	}
+	*state_last_addr = state_addr;
 	return XST_SUCCESS;
 }
+
+/****************************************************************************/
+/**
+*
+* Restores in a region a state captured with capture_subclock_region_state(),
+* possibly from another region with the same columns. The configuration frames
+* of the state are combined with the frames read back from the region and
+* written, then the BRAM contents are written and GRESTORE sets the flip-flops
+* to the INIT bits. The configuration frames of the state replace the PBS of
+* the element, so the element does not have to be written before.
+*
+* NOTE GRESTORE sets all the flip-flops of the FPGA, so the INIT bits of the
+* rest of the FPGA are updated with GCAPTURE before the region is read back.
+* The flip-flops of the other logic return to the values that they had at that
+* moment, so the logic that is running elsewhere (including the static part)
+* should be stopped or tolerate it. The registers of the DSPs and the output
+* registers of the BRAMs are not captured.
+*
+* @param InstancePtr: is a pointer to the PCAP instance.
+* @param buffer: staging buffer initialized with init_staging_buffer()
+* @param work_addr: memory for the BRAM frames of one clock region row (see
+* subclock_region_state_words()) aligned to a cache line
+* @param state_first_addr, state_last_addr: state in the RAM (it is not modified)
+* @param pblock_list[] array with the pblocks where the state is restored
+* @param num_pblocks total number of pblocks in the array.
+*
+* @return XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int restore_subclock_region_state(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *work_addr, u32 *state_first_addr, u32 *state_last_addr, pblock pblock_list[], u32 num_pblocks) {
+	u32 CLB_words, BRAM_words;
+	int status;
+
+	Xil_AssertNonvoid(InstancePtr != NULL);
+	Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+	Xil_AssertNonvoid(buffer != NULL);
+	Xil_AssertNonvoid(work_addr != NULL);
+	Xil_AssertNonvoid(state_first_addr != NULL);
+	Xil_AssertNonvoid(num_pblocks);
+
+	//We check that the size of the state is compatible with the region
+	subclock_region_state_size(pblock_list, num_pblocks, &CLB_words, &BRAM_words, NULL);
+	if (state_last_addr - state_first_addr != CLB_words + BRAM_words) {
+		return XST_FAILURE;
+	}
+
+	reconfig_os_lock(RECONFIG_LOCK_PCAP);
+	status = PCAP_send_command(InstancePtr, PCAP_CMD_GCAPTURE);
+	if (status == XST_SUCCESS) {
+		status = prepare_subclock_region_PBS(InstancePtr, buffer, NULL, state_first_addr, state_first_addr + CLB_words, pblock_list, num_pblocks, 0, 1);
+	}
+	if (status == XST_SUCCESS) {
+		status = commit_subclock_region_PBS(InstancePtr, buffer, PCAP_BRAM_DONOTHING);
+	}
+	if (status == XST_SUCCESS) {
+		status = write_subclock_region_BRAM(InstancePtr, work_addr, state_first_addr + CLB_words, state_last_addr, pblock_list, num_pblocks);
+	}
+	if (status == XST_SUCCESS) {
+		status = PCAP_send_command(InstancePtr, PCAP_CMD_GRESTORE);
+	}
+	reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+	return status;
+}
+
+/****************************************************************************/
+/**
+*
+* Writes the BRAM contents of a region, e.g. the initial contents appended to
+* a PBS by generate_partial_bitstream.py with the BRAM option or the contents
+* of a state captured with capture_subclock_region_state(). The contents have
+* contiguous frames (each BRAM content frame of a pblock contains all its
+* rows), so they can be written in any region with the same columns. The BRAM
+* content frames of each clock region row are read back, the rows of the
+* pblocks are replaced and the frames are written through the BRAM block FAR.
+*
+* NOTE the BRAMs must not be accessed by the design while they are written.
+*
+* @param InstancePtr: is a pointer to the PCAP instance.
+* @param work_addr: memory for the BRAM frames of one clock region row (see
+* subclock_region_BRAM_words()) aligned to a cache line
+* @param BRAM_first_addr, BRAM_last_addr: BRAM contents in the RAM (they are
+* not modified)
+* @param pblock_list[] array with the pblocks of the region
+* @param num_pblocks total number of pblocks in the array.
+*
+* @return XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int write_subclock_region_BRAM(XDcfg *InstancePtr, u32 *work_addr, u32 *BRAM_first_addr, u32 *BRAM_last_addr, pblock pblock_list[], u32 num_pblocks) {
+	u32 *BRAM_addr;
+	int status;
+
+	Xil_AssertNonvoid(InstancePtr != NULL);
+	Xil_AssertNonvoid(InstancePtr->IsReady == XIL_COMPONENT_IS_READY);
+	Xil_AssertNonvoid(work_addr != NULL);
+	Xil_AssertNonvoid(BRAM_first_addr != NULL);
+	Xil_AssertNonvoid(num_pblocks);
+
+	//We check that the size of the BRAM contents is compatible with the region
+	if (BRAM_last_addr - BRAM_first_addr != subclock_region_BRAM_words(pblock_list, num_pblocks, NULL)) {
+		return XST_FAILURE;
+	}
+
+	reconfig_os_lock(RECONFIG_LOCK_PCAP);
+	// The configuration frames are not used for the BRAM block, so there is not a staging buffer
+	status = copy_subclock_region_state(InstancePtr, NULL, work_addr, BRAM_first_addr, pblock_list, num_pblocks, PCAP_FAR_BRAM_BLOCK, PBS_MERGE, &BRAM_addr);
+	reconfig_os_unlock(RECONFIG_LOCK_PCAP);
+
+	return status;
+}
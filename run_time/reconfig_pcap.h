@@ -11,6 +11,10 @@
 /***************************** Include Files ********************************/
 #include "xil_types.h"
 #include "xdevcfg.h"
+#include "xparameters.h"
+#ifdef XPAR_HWICAP_0_DEVICE_ID
+#include "xhwicap.h"
+#endif
 
 
 /**************************** Constant Definitions *******************************/
@@ -19,6 +23,30 @@
 #define PCAP_BRAM_ERASE             1
 #define PCAP_BRAM_DONOTHING         0
 
+// Check of the frames written by commit_subclock_region_PBS() (see
+// verify_subclock_region_PBS())
+#define PCAP_VERIFY_OFF             0 // The frames are not read back
+#define PCAP_VERIFY_FULL            1 // All the frames written are read back
+#define PCAP_VERIFY_SAMPLED         2 // One column of each clock region row is read back
+
+// Configuration ports of the reads and the writes (see CAP_RAM_write()). The
+// AXI HWICAP can only be used if the design has one (XPAR_HWICAP_0_DEVICE_ID)
+// and it drives the ICAPE2, so it cannot be used while the fine-grain engine
+// is writing.
+#define CAP_TRANSPORT_PCAP          0 // DEVCFG DMA to the PCAP
+#define CAP_TRANSPORT_HWICAP        1 // AXI HWICAP core connected to the ICAPE2
+#define CAP_NUM_TRANSPORTS          2
+
+// Interfaces of the DEVCFG that drive the configuration (see CAP_select_interface())
+#define CAP_INTERFACE_PCAP          0
+#define CAP_INTERFACE_ICAP          1 // ICAPE2: fine-grain engine or AXI HWICAP
+
+// State of the incremental loads from the SD card
+#define SD_LOAD_IDLE                0
+#define SD_LOAD_IN_PROGRESS         1
+#define SD_LOAD_DONE                2
+#define SD_LOAD_ERROR               3
+
 // Safe area around each PBS memory storage
 #define SAFE_AREA 0x1000
 
@@ -148,6 +176,9 @@
 // that first one will be 3 as required.
 #define PCAP_CLB_MAJOR_FRAME_OFFSET 2
 
+// CRC error flag of the STAT register
+#define PCAP_STAT_CRC_ERROR_MASK    0x00000001
+
 // Constant to use for CRC check when CRC has been disabled
 #define PCAP_DISABLED_AUTO_CRC      0x0000DEFC
 #define PCAP_DISABLED_AUTO_CRC_ONE  0x9876
@@ -174,9 +205,82 @@ typedef struct {
 	int Yf;
 } pblock;
 
+// RAM region where a region of the FPGA is read back and combined with a new PBS
+typedef struct {
+	u32 *addr_start;         // First word of the buffer
+	u32 *addr_limit;         // First word after the buffer (NULL if it is not checked)
+	u32 *readback_last_addr; // End of the readback
+	pblock regions[MAX_RECONFIGURABLE_CLOCK_REGIONS]; // Clock region rows read back (Y0 = Yf = clock region row)
+	u32 *region_addr[MAX_RECONFIGURABLE_CLOCK_REGIONS + 1]; // First word of each clock region row
+	int num_regions;
+	u8 merged;               // 1 when the new PBS has been combined and the buffer can be written
+	u32 transport;           // Port of the readback and the writes (CAP_TRANSPORT_PCAP by default)
+} staging_buffer_t;
+
+// Result of CAP_benchmark_transport(). bytes / write_us is the bandwidth in MB/s
+typedef struct {
+	u32 bytes;    // Bytes of the frames written and read back in each run
+	u32 write_us; // Mean time of a write (with the CRC check)
+	u32 read_us;  // Mean time of a readback
+} CAP_benchmark_t;
+
 
 /***************** Macros (Inline Functions) Definitions *********************/
 
+/****************************************************************************/
+/**
+*
+* Generates the value of the SLCR PCAP_CLK_CTRL register for a PCAP clock
+*
+* @param	Source is the clock source (0b00 -> IO PLL; 0b10 -> ARM PLL;
+*		0b11 -> DDR PLL).
+* @param	Divisor is the divisor of the source (6 bits).
+*
+* @return	Value of the register with the clock enabled
+*
+*****************************************************************************/
+#define PCAP_CLK_CTRL_VALUE(Source, Divisor) \
+	( (((Divisor) & 0x3F) << 8) | (((Source) & 0x3) << 4) | 0x1 )
+
+/****************************************************************************/
+/**
+*
+* Size of the work memory of PCAP_calibrate_clock()
+*
+* @param	NumFrames is the number of frames of the test column.
+*
+* @return	Number of words
+*
+*****************************************************************************/
+#define PCAP_CALIBRATION_WORDS(NumFrames) \
+	( 2 * ((NumFrames) + 4) * PCAP_NUM_FRAME_WORDS )
+
+/****************************************************************************/
+/**
+*
+* Size of the work memory of CAP_benchmark_transport()
+*
+* @param	NumFrames is the number of frames of the test columns.
+*
+* @return	Number of words
+*
+*****************************************************************************/
+#define CAP_BENCHMARK_WORDS(NumFrames) \
+	( 2 * ((NumFrames) + 4) * PCAP_NUM_FRAME_WORDS )
+
+/****************************************************************************/
+/**
+*
+* Size of the work memory of PCAP_verify_frames()
+*
+* @param	NumFrames is the number of frames that are checked.
+*
+* @return	Number of words
+*
+*****************************************************************************/
+#define PCAP_VERIFY_WORDS(NumFrames) \
+	( ((NumFrames) + 1) * PCAP_NUM_FRAME_WORDS )
+
 /****************************************************************************/
 /**
 *
@@ -301,7 +405,62 @@ u32 load_bitstream_from_RAM_to_SD(const char *file_name, u32 *addr_start, u32 To
 /****************************************************************************/
 /**
 *
-* Initializes PCAP interface
+* Starts loading a partial bitstream file from the external SD card to the
+* on-board RAM. The file is read in blocks with continue_bitstream_load_from_SD()
+* so that the load can be done while other work (e.g. a PCAP transfer) is in
+* progress. Only one incremental load can be in progress.
+*
+* @param file_name is the name of the PBS file stored in the SD card
+* @param addr_start is the initial position of the PBS in the RAM
+* @param addr_limit is the first position of the RAM that cannot be written
+*
+* @return	XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int start_bitstream_load_from_SD(const char *file_name, u32 *addr_start, u32 *addr_limit);
+
+/****************************************************************************/
+/**
+*
+* Continues the load started with start_bitstream_load_from_SD()
+*
+* @param max_bytes is the maximum number of bytes read in this call
+* @param addr_end returns the final position of the PBS in the RAM when the load
+* finishes (it can be NULL)
+*
+* @return	SD_LOAD_IN_PROGRESS, SD_LOAD_DONE, SD_LOAD_ERROR or SD_LOAD_IDLE if
+* there is no load in progress
+*
+*****************************************************************************/
+int continue_bitstream_load_from_SD(u32 max_bytes, u32 **addr_end);
+
+/****************************************************************************/
+/**
+*
+* Completes the load started with start_bitstream_load_from_SD()
+*
+* @param addr_end returns the final position of the PBS in the RAM (it can be
+* NULL)
+*
+* @return	SD_LOAD_DONE, SD_LOAD_ERROR or SD_LOAD_IDLE if there was no load
+*
+*****************************************************************************/
+int finish_bitstream_load_from_SD(u32 **addr_end);
+
+/****************************************************************************/
+/**
+*
+* Cancels the load started with start_bitstream_load_from_SD()
+*
+* @return	none
+*
+*****************************************************************************/
+void abort_bitstream_load_from_SD();
+
+/****************************************************************************/
+/**
+*
+* Initializes PCAP interface and the AXI HWICAP if the design has one
 *
 * @param InstancePtr is a pointer to the PCAP instance
 *
@@ -313,7 +472,9 @@ int PCAP_Initialize(XDcfg *InstancePtr, u16 DeviceId);
 /****************************************************************************/
 /**
 *
-* Writes PBS file using PCAP interface
+* Writes PBS file using PCAP interface. The CRC of the packets is computed
+* while they are sent and written at the end, so that the device checks the
+* transfer (see PCAP_CRC_MODE in reconfig_pcap.c).
 *
 * @param InstancePtr is a pointer to the PCAP instance.
 * @param addr_ini is a pointer to the frame that is to be written to the device
@@ -321,7 +482,7 @@ int PCAP_Initialize(XDcfg *InstancePtr, u16 DeviceId);
 * @param x0, y0, xf, yf are the coordinates of the region to be reconfigured
 * @param erase_bram is a control parameter used to erase BRAM contents through the configuration port
 *
-* @return	XST_SUCCESS else XST_FAILURE.
+* @return	XST_SUCCESS else XST_FAILURE (also if the device finds a CRC error).
 *
 *****************************************************************************/
 int PCAP_RAM_write(XDcfg *InstancePtr, u32 *addr_start, u32 addr_end, u32 x0, u32 y0, u32 xf, u32 yf, u32 erase_bram);
@@ -341,6 +502,459 @@ int PCAP_RAM_write(XDcfg *InstancePtr, u32 *addr_start, u32 addr_end, u32 x0, u3
 *****************************************************************************/
 int PCAP_RAM_read(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf, u32 yf);
 
-int write_subclock_region_PBS(XDcfg *InstancePtr, u32 *addr_start, const char *file_name, pblock pblock_list[], u32 num_pblocks, u32 erase_bram, u8 stacked_modules);
+/****************************************************************************/
+/**
+*
+* Selects the interface of the DEVCFG that drives the configuration. The
+* actual interface is kept and the DEVCFG is only written when it changes,
+* so the PCAP and ICAP work should be grouped to change it as few times as
+* possible (the PCAP transfers select the PCAP when they start). Both
+* interfaces cannot write the configuration at the same time.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param interface is CAP_INTERFACE_PCAP or CAP_INTERFACE_ICAP
+*
+* @return	none
+*
+*****************************************************************************/
+void CAP_select_interface(XDcfg *InstancePtr, u32 interface);
+
+/****************************************************************************/
+/**
+*
+* @return	interface of the DEVCFG selected (CAP_INTERFACE_PCAP or
+* CAP_INTERFACE_ICAP)
+*
+*****************************************************************************/
+u32 CAP_get_interface();
+
+/****************************************************************************/
+/**
+*
+* @return	number of times that the interface of the DEVCFG has changed since
+* the PCAP was initialized
+*
+*****************************************************************************/
+u32 CAP_get_interface_switches();
+
+/****************************************************************************/
+/**
+*
+* @param transport is a configuration port (CAP_TRANSPORT_PCAP or
+* CAP_TRANSPORT_HWICAP)
+*
+* @return	1 if the port can be used in this design else 0
+*
+*****************************************************************************/
+int CAP_transport_available(u32 transport);
+
+/****************************************************************************/
+/**
+*
+* Writes PBS file like PCAP_RAM_write() through the selected configuration
+* port. The AXI HWICAP is written by the processor through the ICAP interface
+* of the DEVCFG, so the DEVCFG DMA is free while it is used. The interface
+* stays selected after the write (see CAP_select_interface()).
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param transport is the configuration port (CAP_TRANSPORT_PCAP or
+* CAP_TRANSPORT_HWICAP)
+* @param addr_ini is a pointer to the frame that is to be written to the device
+* @param addr_end is the value of the last memory position of the PBS
+* @param x0, y0, xf, yf are the coordinates of the region to be reconfigured
+* @param erase_bram is a control parameter used to erase BRAM contents through the configuration port
+*
+* @return	XST_SUCCESS else XST_FAILURE (also if the port is not available).
+*
+*****************************************************************************/
+int CAP_RAM_write(XDcfg *InstancePtr, u32 transport, u32 *addr_start, u32 addr_end, u32 x0, u32 y0, u32 xf, u32 yf, u32 erase_bram);
+
+/****************************************************************************/
+/**
+*
+* Reads PBS file like PCAP_RAM_read() through the selected configuration port
+*
+* @param InstancePtr is a pointer to the PCAP instance.
+* @param transport is the configuration port (CAP_TRANSPORT_PCAP or
+* CAP_TRANSPORT_HWICAP)
+* @param addr_ini is a pointer to the memory addres that will store data read from the device
+* @param x0, y0, xf, yf are the coordinates of the region to be read
+*
+* @return	XST_SUCCESS else XST_FAILURE (also if the port is not available).
+*
+*****************************************************************************/
+int CAP_RAM_read(XDcfg *InstancePtr, u32 transport, u32 **addr_start, u32 x0, u32 y0, u32 xf, u32 yf);
+
+/****************************************************************************/
+/**
+*
+* Measures the bandwidth of a configuration port: the columns x0 to xf of a
+* clock region row are read back and written again CAP_BENCHMARK_RUNS times and
+* the mean times are returned. Each write is checked by the readback that
+* follows it. Calling it for each port compares them in the actual design.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param transport is the configuration port that is measured
+* @param x0, y, xf are the test columns and their clock region row. They must
+* not contain logic that is being used (e.g. the columns of an empty partition)
+* @param work_addr is a RAM buffer of CAP_BENCHMARK_WORDS(frames of the
+* columns) words
+* @param result returns the size of the transfers and their times
+*
+* @return   XST_SUCCESS else XST_FAILURE if the port is not available or a
+* transfer fails (the columns are then restored through the PCAP)
+*
+*****************************************************************************/
+int CAP_benchmark_transport(XDcfg *InstancePtr, u32 transport, u32 x0, u32 y, u32 xf, u32 *work_addr, CAP_benchmark_t *result);
+
+/****************************************************************************/
+/**
+*
+* Erases the BRAM contents of a region using PCAP interface. The BRAM columns
+* with consecutive frame addresses of each clock region row are erased with
+* one packet and the zeros are sent from a static block that is reused by all
+* the DMA transfers.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param x0, y0, xf, yf are the coordinates of the region (y in clock region rows)
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_BRAM_erase(XDcfg *InstancePtr, u32 x0, u32 y0, u32 xf, u32 yf);
+
+/****************************************************************************/
+/**
+*
+* Writes the BRAM contents of a region using PCAP interface, in the order of
+* PCAP_RAM_read_BRAM()
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param addr_start is a pointer to the first BRAM content frame
+* @param addr_end is the value of the last memory position of the frames
+* @param x0, y0, xf, yf are the coordinates of the region (y in clock region rows)
+*
+* @return   XST_SUCCESS else XST_FAILURE (also if the size of the frames is
+* not the size of the BRAM contents of the region).
+*
+*****************************************************************************/
+int PCAP_RAM_write_BRAM(XDcfg *InstancePtr, u32 *addr_start, u32 addr_end, u32 x0, u32 y0, u32 xf, u32 yf);
+
+/****************************************************************************/
+/**
+*
+* Reads the BRAM contents of a region using PCAP interface: the 128 BRAM
+* content frames of each BRAM column of each clock region row. The BRAMs must
+* not be accessed by the design while they are read back.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param addr_start is a pointer to the memory (aligned to a cache line) that
+* will store the frames and one pad frame more. It returns the address after
+* the last frame.
+* @param x0, y0, xf, yf are the coordinates of the region (y in clock region rows)
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_RAM_read_BRAM(XDcfg *InstancePtr, u32 **addr_start, u32 x0, u32 y0, u32 xf, u32 yf);
+
+/****************************************************************************/
+/**
+*
+* @param x0, y0, xf, yf are the coordinates of the region (y in clock region rows)
+*
+* @return   number of BRAM content frames of the region
+*
+*****************************************************************************/
+u32 PCAP_BRAM_content_frames(u32 x0, u32 y0, u32 xf, u32 yf);
+
+/****************************************************************************/
+/**
+*
+* Sends a command to the CMD register of the configuration, e.g.
+* PCAP_CMD_GCAPTURE (the values of all the flip-flops are copied to their INIT
+* bits) or PCAP_CMD_GRESTORE (all the flip-flops are set to their INIT bits)
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param command is the command
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_send_command(XDcfg *InstancePtr, u32 command);
+
+/****************************************************************************/
+/**
+*
+* Writes some consecutive frames of one column using PCAP interface (e.g. to
+* repair the frames of a column without writing the whole column)
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param addr_start is a pointer to the first frame to be written
+* @param x, y are the column and the clock region row
+* @param first_frame is the position of the first frame in the column
+* @param num_frames is the number of frames
+*
+* @return   XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int PCAP_RAM_write_column_frames(XDcfg *InstancePtr, u32 *addr_start, u32 x, u32 y, u32 first_frame, u32 num_frames);
+
+/****************************************************************************/
+/**
+*
+* Finds the fastest PCAP clock settings that read and write correctly a column
+* of the FPGA. The settings are tried from the fastest to the slowest (up to
+* the rated maximum of the PCAP clock unless PCAP_CALIBRATION_OVERCLOCK is set)
+* and each one is accepted only if the test frames are read back without errors. The
+* SLCR is only written when the clock setting of a transfer changes.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param x is the column used for the test. It must not contain logic that is
+* being used (e.g. the column of an empty partition)
+* @param y is the clock region row of the column
+* @param work_addr is a RAM buffer of PCAP_CALIBRATION_WORDS(frames of the
+* column) words
+*
+* @return   XST_SUCCESS else XST_FAILURE if the column cannot be read back
+*
+*****************************************************************************/
+int PCAP_calibrate_clock(XDcfg *InstancePtr, u32 x, u32 y, u32 *work_addr);
+
+/****************************************************************************/
+/**
+*
+* Returns the PCAP clock settings (value of the SLCR PCAP_CLK_CTRL register)
+* used by the reads and the writes
+*
+* @param read_clk_ctrl returns the setting of the reads
+* @param write_clk_ctrl returns the setting of the writes
+*
+* @return   none
+*
+*****************************************************************************/
+void PCAP_get_clock_settings(u32 *read_clk_ctrl, u32 *write_clk_ctrl);
+
+/****************************************************************************/
+/**
+*
+* Changes the PCAP clock settings used by the reads and the writes (e.g. to
+* restore the result of a previous calibration)
+*
+* @param read_clk_ctrl is the setting of the reads (see PCAP_CLK_CTRL_VALUE())
+* @param write_clk_ctrl is the setting of the writes
+*
+* @return   none
+*
+*****************************************************************************/
+void PCAP_set_clock_settings(u32 read_clk_ctrl, u32 write_clk_ctrl);
+
+/****************************************************************************/
+/**
+*
+* Calculates a word-wise hash of a configuration frame. It is used to compare
+* the frames read back with the frames written without keeping both images.
+*
+* @param frame_addr is the first word of the frame (PCAP_NUM_FRAME_WORDS words)
+*
+* @return   hash of the frame
+*
+*****************************************************************************/
+u32 PCAP_frame_hash(const u32 *frame_addr);
+
+/****************************************************************************/
+/**
+*
+* Reads back the frames of the columns x0 to xf of a clock region row and
+* compares them frame by frame with the image that was written (e.g. a clock
+* region row of a staging buffer or the output of PCAP_RAM_read()).
+*
+* NOTE the frames of the columns that contain LUTRAMs or SRLs used by the
+* design change while the design runs, so they should not be checked.
+*
+* @param InstancePtr is a pointer to the PCAP instance
+* @param image is the first frame of the column x0 in the image
+* @param x0, xf are the first and last columns
+* @param y is the clock region row
+* @param work_addr is a RAM buffer of PCAP_VERIFY_WORDS(frames of the columns)
+* words aligned to a cache line
+* @param bad_frame returns the position in the image of the first frame that is
+* not equal or -1 (it can be NULL)
+*
+* @return   XST_SUCCESS if all the frames are equal else XST_FAILURE
+*
+*****************************************************************************/
+int PCAP_verify_frames(XDcfg *InstancePtr, u32 *image, u32 x0, u32 y, u32 xf, u32 *work_addr, int *bad_frame);
+
+/****************************************************************************/
+/**
+*
+* Sets a function that is called while the PCAP waits for the end of a
+* transfer so that other work overlaps with the reconfiguration. The function
+* must not use the PCAP and should return quickly.
+*
+* @param callback is the function to be called or NULL
+* @param data is the argument passed to the callback
+*
+* @return	none
+*
+*****************************************************************************/
+void PCAP_set_idle_callback(void (*callback)(void *), void *data);
+
+int write_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *addr_start, const char *file_name, pblock pblock_list[], u32 num_pblocks, u32 erase_bram, u8 stacked_modules, u8 contiguous_frames);
+
+/****************************************************************************/
+/**
+*
+* Initializes a staging buffer between addr_start and addr_limit (NULL if the
+* size is not checked)
+*
+* @return	none
+*
+*****************************************************************************/
+void init_staging_buffer(staging_buffer_t *buffer, u32 *addr_start, u32 *addr_limit);
+
+/****************************************************************************/
+/**
+*
+* Calculates from the FPGA description the size of a staging buffer big enough
+* to reconfigure any pblock of width columns that spans clock_rows clock region
+* rows (readback and new PBS)
+*
+* @return	size in bytes
+*
+*****************************************************************************/
+u32 staging_buffer_bytes(int width, int clock_rows);
+
+/****************************************************************************/
+/**
+*
+* @return	1 if the regions read back in both staging buffers share frames,
+* else 0
+*
+*****************************************************************************/
+int staging_buffers_overlap(staging_buffer_t *buffer, staging_buffer_t *other);
+
+/****************************************************************************/
+/**
+*
+* Reads back a region into a staging buffer. It can then be combined with
+* prepare_subclock_region_PBS() setting stacked_modules to 2 or 3.
+*
+* @return	XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int read_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, pblock pblock_list[], u32 num_pblocks);
+
+/****************************************************************************/
+/**
+*
+* Reads back a region into a staging buffer (unless stacked_modules is 2 or 3)
+* and combines it with a new PBS, loaded from the SD card if file_name is not
+* NULL or else stored in the RAM between PBS_first_addr and PBS_last_addr. The
+* FPGA is not written until commit_subclock_region_PBS() is called.
+*
+* @return	XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int prepare_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, const char *file_name, u32 *PBS_first_addr, u32 *PBS_last_addr, pblock pblock_list[], u32 num_pblocks, u8 stacked_modules, u8 contiguous_frames);
+
+/****************************************************************************/
+/**
+*
+* Writes a staging buffer prepared with prepare_subclock_region_PBS()
+*
+* @return	XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int commit_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 erase_bram);
+
+/****************************************************************************/
+/**
+*
+* Checks that the FPGA contains the frames of a staging buffer written with
+* commit_subclock_region_PBS(). PCAP_VERIFY_FULL reads back all the columns
+* and PCAP_VERIFY_SAMPLED only one column of each clock region row, chosen
+* from sample, so that consecutive calls check different columns. The free
+* memory of the buffer above the readback is used as work memory.
+*
+* @return	XST_SUCCESS else XST_FAILURE if a frame is not equal.
+*
+*****************************************************************************/
+int verify_subclock_region_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 mode, u32 sample);
+
+/****************************************************************************/
+/**
+*
+* Equivalent to write_subclock_region_PBS() but the PBS is already stored in
+* the RAM between PBS_first_addr and PBS_last_addr. The PBS is not modified.
+*
+* @return	XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int write_subclock_region_RAM_PBS(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *addr_start, u32 *PBS_first_addr, u32 *PBS_last_addr, pblock pblock_list[], u32 num_pblocks, u32 erase_bram, u8 stacked_modules, u8 contiguous_frames);
+
+/****************************************************************************/
+/**
+*
+* Calculates the size of the state of a region captured with
+* capture_subclock_region_state(). work_words returns the size of the work
+* memory of the capture and the restore (it can be NULL).
+*
+* @return	number of words of the state
+*
+*****************************************************************************/
+u32 subclock_region_state_words(pblock pblock_list[], u32 num_pblocks, u32 *work_words);
+
+/****************************************************************************/
+/**
+*
+* Calculates the words of the BRAM contents of a region written with
+* write_subclock_region_BRAM(). work_words returns the size of the work memory
+* that it needs.
+*
+* @return	number of words
+*
+*****************************************************************************/
+u32 subclock_region_BRAM_words(pblock pblock_list[], u32 num_pblocks, u32 *work_words);
+
+/****************************************************************************/
+/**
+*
+* Captures with GCAPTURE and readback the flip-flops, LUTRAMs, SRLs and BRAM
+* contents of a region. The rows of the pblocks are stored between
+* state_first_addr and state_last_addr with contiguous frames, so the state
+* can be restored in any region with the same columns. The logic of the region
+* should be stopped while it is captured.
+*
+* @return	XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int capture_subclock_region_state(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *work_addr, pblock pblock_list[], u32 num_pblocks, u32 *state_first_addr, u32 **state_last_addr);
+
+/****************************************************************************/
+/**
+*
+* Writes a state captured with capture_subclock_region_state() in a region and
+* sets the flip-flops with GRESTORE. GRESTORE is global: the rest of the FPGA
+* returns to the values captured when the restore starts.
+*
+* @return	XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int restore_subclock_region_state(XDcfg *InstancePtr, staging_buffer_t *buffer, u32 *work_addr, u32 *state_first_addr, u32 *state_last_addr, pblock pblock_list[], u32 num_pblocks);
+
+/****************************************************************************/
+/**
+*
+* Writes through the BRAM block FAR the BRAM contents of a region stored with
+* contiguous frames: the BRAM section of a PBS generated with the BRAM option
+* or the BRAM contents of a state. The rows of the BRAMs outside the pblocks
+* are kept.
+*
+* @return	XST_SUCCESS else XST_FAILURE.
+*
+*****************************************************************************/
+int write_subclock_region_BRAM(XDcfg *InstancePtr, u32 *work_addr, u32 *BRAM_first_addr, u32 *BRAM_last_addr, pblock pblock_list[], u32 num_pblocks);
 
 #endif /* RECONFIG_PCAP_H_ */
@@ -0,0 +1,26 @@
+#ifndef FF_H
+#define FF_H
+
+#include "xil_types.h"
+#include "xil_printf.h"
+
+typedef unsigned int UINT;
+typedef u32 FSIZE_t;
+typedef enum { FR_OK = 0, FR_DISK_ERR } FRESULT;
+typedef struct { int unused; } FATFS;
+typedef struct { FSIZE_t fsize; FSIZE_t fptr; } FIL;
+
+#define FA_READ 0x01
+#define FA_WRITE 0x02
+#define FA_CREATE_ALWAYS 0x08
+
+#define f_eof(fp) ((int)((fp)->fptr == (fp)->fsize))
+#define f_size(fp) ((fp)->fsize)
+
+FRESULT f_mount(FATFS *fs, const char *path, u8 opt);
+FRESULT f_open(FIL *fp, const char *path, u8 mode);
+FRESULT f_close(FIL *fp);
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br);
+FRESULT f_write(FIL *fp, const void *buff, UINT btw, UINT *bw);
+
+#endif
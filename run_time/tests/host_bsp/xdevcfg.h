@@ -0,0 +1,40 @@
+#ifndef XDEVCFG_H
+#define XDEVCFG_H
+
+#include "xil_types.h"
+
+typedef struct {
+	u16 DeviceId;
+	u32 BaseAddr;
+} XDcfg_Config;
+
+typedef struct {
+	XDcfg_Config Config;
+	u32 IsReady;
+} XDcfg;
+
+#define XDCFG_DMA_INVALID_ADDRESS     0xFFFFFFFFU
+#define XDCFG_NON_SECURE_PCAP_WRITE   1
+#define XDCFG_STATUS_OFFSET           0x14
+#define XDCFG_CTRL_PCAP_PR_MASK       0x08000000U
+#define XDCFG_STATUS_DMA_CMD_Q_F_MASK 0x80000000U
+#define XDCFG_IXR_PCFG_DONE_MASK      0x00000004U
+#define XDCFG_IXR_D_P_DONE_MASK       0x00001000U
+#define XDCFG_IXR_DMA_DONE_MASK       0x00002000U
+#define XDCFG_IXR_ALL_MASK            0xF8F7F87FU
+
+XDcfg_Config *XDcfg_LookupConfig(u16 DeviceId);
+int XDcfg_CfgInitialize(XDcfg *InstancePtr, XDcfg_Config *ConfigPtr, u32 EffectiveAddress);
+int XDcfg_SelfTest(XDcfg *InstancePtr);
+void XDcfg_EnablePCAP(XDcfg *InstancePtr);
+void XDcfg_SetControlRegister(XDcfg *InstancePtr, u32 Mask);
+void XDcfg_SelectIcapInterface(XDcfg *InstancePtr);
+void XDcfg_SelectPcapInterface(XDcfg *InstancePtr);
+u32 XDcfg_Transfer(XDcfg *InstancePtr, void *SourcePtr, u32 SrcWordLength, void *DestPtr, u32 DestWordLength, u32 TransferType);
+u32 XDcfg_ReadReg(u32 BaseAddr, u32 RegOffset);
+u32 XDcfg_IntrGetStatus(XDcfg *InstancePtr);
+void XDcfg_IntrEnable(XDcfg *InstancePtr, u32 Mask);
+void XDcfg_IntrDisable(XDcfg *InstancePtr, u32 Mask);
+void XDcfg_IntrClear(XDcfg *InstancePtr, u32 Mask);
+
+#endif
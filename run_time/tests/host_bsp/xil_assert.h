@@ -0,0 +1,19 @@
+#ifndef XIL_ASSERT_H
+#define XIL_ASSERT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "xil_printf.h"
+
+// A failed assertion is a bug of the test, so it stops it
+#define Xil_AssertNonvoid(Expression)                                       \
+	do {                                                                    \
+		if (!(Expression)) {                                                \
+			fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__,      \
+					__LINE__, #Expression);                                 \
+			abort();                                                        \
+		}                                                                   \
+	} while (0)
+#define Xil_AssertVoid(Expression) Xil_AssertNonvoid(Expression)
+
+#endif
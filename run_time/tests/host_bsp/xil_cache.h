@@ -0,0 +1,9 @@
+#ifndef XIL_CACHE_H
+#define XIL_CACHE_H
+
+#include "xil_types.h"
+
+void Xil_DCacheFlushRange(const void *adr, u32 len);
+void Xil_DCacheInvalidateRange(const void *adr, u32 len);
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * Minimal host replacement of the Xilinx BSP headers used to build the
+ * run-time on the host. The tests map their buffers in the low 4 GB because
+ * the run-time stores addresses in u32 variables.
+ */
+#ifndef XIL_TYPES_H
+#define XIL_TYPES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int32_t s32;
+typedef uintptr_t UINTPTR;
+
+#define XIL_COMPONENT_IS_READY 0x11111111U
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+#define XPAR_XDCFG_0_DEVICE_ID 0
+#define XPAR_XDCFG_0_INTR 40
+#define XPAR_PS7_CORTEXA9_0_CPU_CLK_FREQ_HZ 666666687
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * test_PBS_relocation.c
+ *
+ * Host test of the row remapping of prepare_subclock_region_PBS(). Pblocks of
+ * CLB columns of several heights are placed at every row of the FPGA, so that
+ * they start and end below and above the clock word of each clock region row
+ * and cross the clock region boundaries. The frames read back are simulated
+ * in the staging buffer and combined with a PBS stored in both layouts
+ * generated by generate_partial_bitstream.py (contiguous frames and frames
+ * grouped by clock region row). Every word of the result is compared with a
+ * reference built from the frame layout of series7.h: the rows of the pblock
+ * come from the PBS and the clock word and the rest of the rows are kept.
+ */
+
+#define _GNU_SOURCE // MAP_32BIT
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include "reconfig_pcap.h"
+#include "xc7z020.h"
+#include "series7.h"
+#include "xstatus.h"
+#include "test_check.h"
+
+#define TEST_X0 2 // CLB columns with the same frames in every clock region row
+#define TEST_XF 3
+#define MEMORY_BYTES (1 << 20)
+#define MEMORY_WORDS (MEMORY_BYTES / 4)
+#define HALF_CLOCK_REGION_WORDS ((NUM_FRAME_WORDS - CLOCK_WORDS) / 2)
+
+static const int heights[] = {1, 2, 9, 24, 25, 26, 49, 50, 51, 75, 100, 150};
+
+static u32 *memory; // Frames read back in the first half and new PBS in the second one
+static int column_frames; // Frames of the columns TEST_X0 to TEST_XF in a clock region row
+
+static u32 readback_word(int clock_row, int frame, int word) {
+  return 0x80000000u | (clock_row << 24) | (frame << 8) | word;
+}
+
+static u32 PBS_word(int frame, int row, int row_word) {
+  return 0x40000000u | (frame << 16) | (row << 4) | row_word;
+}
+
+/*
+ * Row of the clock region row stored in a word of a frame: the bottom half of
+ * the rows is below the clock word and the top half above it. Returns -1 for
+ * the clock word.
+ */
+static int frame_word_row(int word, int *row_word) {
+  if (word >= HALF_CLOCK_REGION_WORDS && word < HALF_CLOCK_REGION_WORDS + CLOCK_WORDS) {
+    return -1;
+  }
+  if (word >= HALF_CLOCK_REGION_WORDS) {
+    word -= CLOCK_WORDS;
+  }
+  *row_word = word % WORDS_PER_ROW_IN_CLOCK_REGION;
+  return word / WORDS_PER_ROW_IN_CLOCK_REGION;
+}
+
+/*
+ * Word of the PBS that stores row_word of a row of the pblock (counted from
+ * y0) in a frame. With contiguous frames each frame has all the rows of the
+ * pblock. Otherwise the PBS has, for each clock region row, all its frames with
+ * only the rows of that clock region row.
+ */
+static int PBS_index(int y0, int yf, int contiguous, int frame, int row, int row_word) {
+  int clock_row, first_row, last_row, index;
+
+  if (contiguous) {
+    return (frame * (yf - y0 + 1) + row) * WORDS_PER_ROW_IN_CLOCK_REGION + row_word;
+  }
+  index = 0;
+  for (clock_row = y0 / ROWS_PER_CLOCK_REGION; ; clock_row++) {
+    first_row = clock_row * ROWS_PER_CLOCK_REGION > y0 ? clock_row * ROWS_PER_CLOCK_REGION - y0 : 0;
+    last_row = (clock_row + 1) * ROWS_PER_CLOCK_REGION - 1 < yf ? (clock_row + 1) * ROWS_PER_CLOCK_REGION - 1 - y0 : yf - y0;
+    if (row <= last_row) {
+      return index + (frame * (last_row - first_row + 1) + row - first_row) * WORDS_PER_ROW_IN_CLOCK_REGION + row_word;
+    }
+    index += column_frames * (last_row - first_row + 1) * WORDS_PER_ROW_IN_CLOCK_REGION;
+  }
+}
+
+/*
+ * Fills the staging buffer as if the clock region rows of the pblock had been
+ * read back
+ */
+static void fill_staging_buffer(staging_buffer_t *buffer, int y0, int yf) {
+  u32 *addr;
+  int clock_row, frame, word;
+
+  init_staging_buffer(buffer, memory, memory + MEMORY_WORDS / 2);
+  addr = memory;
+  for (clock_row = y0 / ROWS_PER_CLOCK_REGION; clock_row <= yf / ROWS_PER_CLOCK_REGION; clock_row++) {
+    buffer->regions[buffer->num_regions].X0 = TEST_X0;
+    buffer->regions[buffer->num_regions].Y0 = clock_row;
+    buffer->regions[buffer->num_regions].Xf = TEST_XF;
+    buffer->regions[buffer->num_regions].Yf = clock_row;
+    buffer->region_addr[buffer->num_regions++] = addr;
+    for (frame = 0; frame < column_frames; frame++) {
+      for (word = 0; word < NUM_FRAME_WORDS; word++) {
+        *addr++ = readback_word(clock_row, frame, word);
+      }
+    }
+    buffer->region_addr[buffer->num_regions] = addr;
+  }
+  buffer->readback_last_addr = addr;
+}
+
+static void test_pblock(int y0, int yf, int contiguous) {
+  XDcfg instance;
+  staging_buffer_t buffer;
+  pblock region = {TEST_X0, y0, TEST_XF, yf};
+  u32 *PBS, *addr, expected;
+  int PBS_words, region_index, clock_row, frame, word, row, row_word, fpga_row;
+
+  instance.IsReady = XIL_COMPONENT_IS_READY;
+  PBS = memory + MEMORY_WORDS / 2;
+  PBS_words = column_frames * (yf - y0 + 1) * WORDS_PER_ROW_IN_CLOCK_REGION;
+  for (frame = 0; frame < column_frames; frame++) {
+    for (row = 0; row <= yf - y0; row++) {
+      for (row_word = 0; row_word < WORDS_PER_ROW_IN_CLOCK_REGION; row_word++) {
+        PBS[PBS_index(y0, yf, contiguous, frame, row, row_word)] = PBS_word(frame, row, row_word);
+      }
+    }
+  }
+
+  fill_staging_buffer(&buffer, y0, yf);
+  CHECK(prepare_subclock_region_PBS(&instance, &buffer, NULL, PBS, PBS + PBS_words, &region, 1, 2, contiguous) == XST_SUCCESS);
+  CHECK(buffer.merged == 1);
+
+  for (region_index = 0; region_index < buffer.num_regions; region_index++) {
+    clock_row = buffer.regions[region_index].Y0;
+    addr = buffer.region_addr[region_index];
+    for (frame = 0; frame < column_frames; frame++) {
+      for (word = 0; word < NUM_FRAME_WORDS; word++) {
+        expected = readback_word(clock_row, frame, word);
+        row = frame_word_row(word, &row_word);
+        fpga_row = clock_row * ROWS_PER_CLOCK_REGION + row;
+        if (row != -1 && fpga_row >= y0 && fpga_row <= yf) {
+          expected = PBS_word(frame, fpga_row - y0, row_word);
+        }
+        if (*addr != expected) {
+          fprintf(stderr, "pblock rows %d-%d (%s): clock region row %d frame %d word %d is 0x%08x instead of 0x%08x\n",
+                  y0, yf, contiguous ? "contiguous" : "per clock region row", clock_row, frame, word, *addr, expected);
+          exit(1);
+        }
+        addr++;
+      }
+    }
+  }
+
+  // The PBS is not modified
+  for (frame = 0; frame < column_frames; frame++) {
+    for (row = 0; row <= yf - y0; row++) {
+      for (row_word = 0; row_word < WORDS_PER_ROW_IN_CLOCK_REGION; row_word++) {
+        CHECK(PBS[PBS_index(y0, yf, contiguous, frame, row, row_word)] == PBS_word(frame, row, row_word));
+      }
+    }
+  }
+
+  // A PBS of a different size is rejected
+  fill_staging_buffer(&buffer, y0, yf);
+  CHECK(prepare_subclock_region_PBS(&instance, &buffer, NULL, PBS, PBS + PBS_words - 1, &region, 1, 2, contiguous) == XST_FAILURE);
+  CHECK(buffer.merged == 0);
+}
+
+/*
+ * The run-time stores addresses in u32 variables, so the buffers must be in
+ * the low 4 GB of the address space
+ */
+static u32 *map_low_memory(size_t bytes) {
+  void *addr;
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#ifdef MAP_32BIT
+  flags |= MAP_32BIT;
+#endif
+  addr = mmap(NULL, bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+  CHECK(addr != MAP_FAILED);
+  CHECK((uintptr_t) addr + bytes - 1 <= 0xFFFFFFFFu);
+  return addr;
+}
+
+int main(void) {
+  int x, y, y0, contiguous, tests = 0;
+  unsigned int i;
+
+  for (y = 0; y < MAX_ROWS; y++) {
+    for (x = TEST_X0; x <= TEST_XF; x++) {
+      CHECK(fpga[y][x][1] == CLB_L_TYPE || fpga[y][x][1] == CLB_M_TYPE);
+      CHECK((fpga[y][x][0] & 0xFFFF) == (fpga[0][x][0] & 0xFFFF));
+    }
+  }
+  column_frames = 0;
+  for (x = TEST_X0; x <= TEST_XF; x++) {
+    column_frames += fpga[0][x][0] & 0xFFFF;
+  }
+  memory = map_low_memory(MEMORY_BYTES);
+  CHECK(MAX_ROWS * column_frames * NUM_FRAME_WORDS <= MEMORY_WORDS / 2);
+
+  for (i = 0; i < sizeof(heights) / sizeof(heights[0]); i++) {
+    for (y0 = 0; y0 + heights[i] <= MAX_ROWS * ROWS_PER_CLOCK_REGION; y0++) {
+      for (contiguous = 0; contiguous <= 1; contiguous++) {
+        test_pblock(y0, y0 + heights[i] - 1, contiguous);
+        tests++;
+      }
+    }
+  }
+  printf("test_PBS_relocation: %d pblock positions\n", tests);
+  return 0;
+}
@@ -0,0 +1,17 @@
+#ifndef TEST_CHECK
+#define TEST_CHECK
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Stops the test with the failed condition (assert() is removed with NDEBUG)
+#define CHECK(condition)                                                    \
+  do {                                                                      \
+    if (!(condition)) {                                                     \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__,      \
+              #condition);                                                  \
+      exit(1);                                                              \
+    }                                                                       \
+  } while (0)
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * test_command_ring.c
+ *
+ * Host test of IMPRESS_command_ring.c. A producer thread and a consumer thread
+ * exchange enough commands to wrap the ring many times. The consumer checks
+ * that the commands arrive in order without losses or duplicates and the
+ * producer checks the status of each completed command. The exact full and
+ * empty reporting is checked first with a single thread, also when the free
+ * running counters wrap.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include "IMPRESS_command_ring.h"
+#include "test_check.h"
+
+#define THREADED_COMMANDS 1000000
+
+static command_ring_t ring;
+static volatile uint32_t submitted; // Commands pushed, published after each push
+
+static void make_command(uint32_t seq, ring_command_t *command) {
+  int i;
+
+  command->type = seq * 2654435761u;
+  for (i = 0; i < COMMAND_RING_ARGS; i++) {
+    command->args[i] = (int32_t) (seq ^ (i * 0x01010101u));
+  }
+}
+
+static int same_command(const ring_command_t *a, const ring_command_t *b) {
+  int i;
+
+  if (a->type != b->type) {
+    return 0;
+  }
+  for (i = 0; i < COMMAND_RING_ARGS; i++) {
+    if (a->args[i] != b->args[i]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static int32_t command_status(uint32_t seq) {
+  return (int32_t) (seq * 31u + 7);
+}
+
+/*
+ * Fills and empties the ring from a single thread starting with the counters
+ * at first_ticket, so that the exact full and empty conditions are known.
+ */
+static void test_single_thread(uint32_t first_ticket) {
+  ring_command_t command, expected;
+  uint32_t ticket;
+  int32_t status;
+  uint32_t i;
+
+  init_command_ring(&ring);
+  ring.head = first_ticket;
+  ring.tail = first_ticket;
+
+  CHECK(command_ring_peek(&ring, &command) == 0);
+
+  for (i = 0; i < COMMAND_RING_SIZE; i++) {
+    make_command(i, &command);
+    CHECK(command_ring_push(&ring, &command, &ticket) == 1);
+    CHECK(ticket == first_ticket + i);
+    CHECK(command_ring_is_done(&ring, ticket, &status) == 0);
+  }
+  make_command(COMMAND_RING_SIZE, &command);
+  CHECK(command_ring_push(&ring, &command, &ticket) == 0);
+
+  // The command stays in the ring until it is completed
+  make_command(0, &expected);
+  CHECK(command_ring_peek(&ring, &command) == 1 && same_command(&command, &expected));
+  CHECK(command_ring_peek(&ring, &command) == 1 && same_command(&command, &expected));
+  make_command(COMMAND_RING_SIZE, &command);
+  CHECK(command_ring_push(&ring, &command, &ticket) == 0);
+
+  command_ring_complete(&ring, command_status(0));
+  CHECK(command_ring_is_done(&ring, first_ticket, &status) == 1);
+  CHECK(status == command_status(0));
+  CHECK(command_ring_is_done(&ring, first_ticket + 1, &status) == 0);
+  CHECK(command_ring_push(&ring, &command, &ticket) == 1);
+  CHECK(ticket == first_ticket + COMMAND_RING_SIZE);
+  CHECK(command_ring_push(&ring, &command, &ticket) == 0);
+
+  for (i = 1; i <= COMMAND_RING_SIZE; i++) {
+    make_command(i, &expected);
+    CHECK(command_ring_peek(&ring, &command) == 1 && same_command(&command, &expected));
+    command_ring_complete(&ring, command_status(i));
+  }
+  CHECK(command_ring_peek(&ring, &command) == 0);
+
+  // Only the statuses of the last COMMAND_RING_SIZE commands are kept
+  for (i = 1; i <= COMMAND_RING_SIZE; i++) {
+    CHECK(command_ring_is_done(&ring, first_ticket + i, &status) == 1);
+    CHECK(status == command_status(i));
+  }
+  CHECK(command_ring_is_done(&ring, first_ticket + COMMAND_RING_SIZE + 1, NULL) == 0);
+}
+
+/*
+ * Pushes the commands as soon as there is room and reads the status of each
+ * one before its position can be reused.
+ */
+static void *producer(void *data) {
+  ring_command_t command;
+  uint32_t seq = 0, checked = 0, ticket;
+  int32_t status;
+
+  (void) data;
+  while (checked < THREADED_COMMANDS) {
+    while (checked < seq && command_ring_is_done(&ring, checked, &status)) {
+      CHECK(status == command_status(checked));
+      checked++;
+    }
+    if (seq < THREADED_COMMANDS && seq - checked < COMMAND_RING_SIZE) {
+      // The ring cannot be full while fewer than COMMAND_RING_SIZE commands are pending
+      make_command(seq, &command);
+      CHECK(command_ring_push(&ring, &command, &ticket) == 1);
+      CHECK(ticket == seq);
+      seq++;
+      __sync_synchronize();
+      submitted = seq;
+    } else {
+      // A push only succeeds if the oldest command in the ring has been completed
+      if (seq < THREADED_COMMANDS) {
+        make_command(seq, &command);
+        if (command_ring_push(&ring, &command, &ticket) == 1) {
+          CHECK(ticket == seq);
+          CHECK(command_ring_is_done(&ring, checked, NULL) == 1);
+          // Its status can be overwritten from now on
+          checked++;
+          seq++;
+          __sync_synchronize();
+          submitted = seq;
+        }
+      }
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Executes the commands in order. The ring cannot be empty while commands
+ * published by the producer are pending.
+ */
+static void *consumer(void *data) {
+  ring_command_t command, expected;
+  uint32_t seq = 0, pushed;
+
+  (void) data;
+  while (seq < THREADED_COMMANDS) {
+    pushed = submitted;
+    __sync_synchronize();
+    if (command_ring_peek(&ring, &command) == 0) {
+      CHECK(seq == pushed);
+      sched_yield();
+      continue;
+    }
+    // No duplicated or lost commands
+    make_command(seq, &expected);
+    CHECK(same_command(&command, &expected));
+    command_ring_complete(&ring, command_status(seq));
+    seq++;
+  }
+  return NULL;
+}
+
+static void test_two_threads(void) {
+  pthread_t producer_thread, consumer_thread;
+  ring_command_t command;
+
+  init_command_ring(&ring);
+  submitted = 0;
+  CHECK(pthread_create(&consumer_thread, NULL, consumer, NULL) == 0);
+  CHECK(pthread_create(&producer_thread, NULL, producer, NULL) == 0);
+  CHECK(pthread_join(producer_thread, NULL) == 0);
+  CHECK(pthread_join(consumer_thread, NULL) == 0);
+
+  CHECK(ring.head == THREADED_COMMANDS && ring.tail == THREADED_COMMANDS);
+  CHECK(command_ring_peek(&ring, &command) == 0);
+}
+
+int main(void) {
+  test_single_thread(0);
+  test_single_thread(0xFFFFFFFFu - COMMAND_RING_SIZE / 2);
+  test_two_threads();
+  printf("test_command_ring: %d commands through a ring of %d\n", THREADED_COMMANDS, COMMAND_RING_SIZE);
+  return 0;
+}